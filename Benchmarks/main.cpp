@@ -0,0 +1,276 @@
+#include "main.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+int main(int argc, char *argv[])
+{
+    int repetitions = DEFAULTREPETITIONS;
+    if(argc > 1)
+    {
+        repetitions = std::max(1, atoi(argv[1]));
+    }
+    
+    std::vector<char> paletteData;
+    std::vector<char> sampleImageData;
+    try
+    {
+        LoadFileToVectorBenchmark(PALETTEFILEPATH, &paletteData);
+        LoadFileToVectorBenchmark(GRPIMAGEFILEPATH, &sampleImageData);
+    }
+    catch(...)
+    {
+        std::cout << "Unable to open the sample content, run from the build directory\n";
+        return -1;
+    }
+    
+    //512 frames of 128x128, roughly the size of a large unit GRP
+    grpGeneratorSettings syntheticSettings = GetDefaultGeneratorSettings();
+    syntheticSettings.numberOfFrames = 512;
+    std::vector<char> syntheticImageData;
+    GenerateGRP(&syntheticImageData, syntheticSettings);
+    
+    ColorPalette samplePalette(&paletteData);
+    GRPImage sampleImage(&sampleImageData, false);
+    GRPImage syntheticImage(&syntheticImageData, false);
+    GRPImage compressedSampleImage;
+    compressedSampleImage.SetFrameStorage(COMPRESSEDFRAMES);
+    compressedSampleImage.LoadImage(&sampleImageData, false);
+    //Compressed frames drawn from their span programs
+    GRPImage spanSampleImage;
+    spanSampleImage.SetBuildSpanPrograms(true);
+    spanSampleImage.SetFrameStorage(COMPRESSEDFRAMES);
+    spanSampleImage.LoadImage(&sampleImageData, false);
+    sampleImage.SetColorPalette(&samplePalette);
+    syntheticImage.SetColorPalette(&samplePalette);
+    compressedSampleImage.SetColorPalette(&samplePalette);
+    spanSampleImage.SetColorPalette(&samplePalette);
+    
+    //The decoded area of every frame, used for the per pixel columns
+    double samplePixels = 0;
+    for(int currentFrame = 0; currentFrame < sampleImage.getNumberOfFrames(); currentFrame++)
+    {
+        samplePixels += sampleImage.GetFrame(currentFrame)->GetImageWidth() * sampleImage.GetFrame(currentFrame)->GetImageHeight();
+    }
+    double syntheticPixels = 0;
+    for(int currentFrame = 0; currentFrame < syntheticImage.getNumberOfFrames(); currentFrame++)
+    {
+        syntheticPixels += syntheticImage.GetFrame(currentFrame)->GetImageWidth() * syntheticImage.GetFrame(currentFrame)->GetImageHeight();
+    }
+    
+    std::vector<uint32_t> rgbaBuffer(sampleImage.getMaxImageWidth() * sampleImage.getMaxImageHeight());
+    std::vector<uint8_t> frameBuffer(samplePixels);
+    ColorPalette workPalette;
+    ColorPalette destinationPalette(&paletteData);
+    colorValues glowStart = {255, 0, 0};
+    colorValues glowEnd = {0, 0, 255};
+    std::vector<benchmarkCase> benchmarkCases;
+    std::function<void()> noSetup = [](){};
+    std::function<void()> reloadPalette = [&](){ workPalette.LoadPalette(&paletteData); };
+    
+    //Image loading and frame decoding
+    benchmarkCases.push_back({"LoadImage file (sample)", noSetup,
+        [&](){ GRPImage loadImage(GRPIMAGEFILEPATH, false); },
+        (double) sampleImageData.size(), (double) sampleImage.getNumberOfFrames(), samplePixels});
+    benchmarkCases.push_back({"LoadImage memory (sample)", noSetup,
+        [&](){ GRPImage loadImage(&sampleImageData, false); },
+        (double) sampleImageData.size(), (double) sampleImage.getNumberOfFrames(), samplePixels});
+    benchmarkCases.push_back({"LoadImage memory (sample, unique)", noSetup,
+        [&](){ GRPImage loadImage(&sampleImageData, true); },
+        (double) sampleImageData.size(), 0, 0});
+    benchmarkCases.push_back({"LoadImage memory (sample, compressed)", noSetup,
+        [&](){ compressedSampleImage.LoadImage(&sampleImageData, false); },
+        (double) sampleImageData.size(), (double) sampleImage.getNumberOfFrames(), samplePixels});
+    benchmarkCases.push_back({"LoadImage memory (sample, spans)", noSetup,
+        [&](){ spanSampleImage.LoadImage(&sampleImageData, false); },
+        (double) sampleImageData.size(), (double) sampleImage.getNumberOfFrames(), samplePixels});
+    benchmarkCases.push_back({"LoadImage memory (synthetic)", noSetup,
+        [&](){ GRPImage loadImage(&syntheticImageData, false); },
+        (double) syntheticImageData.size(), (double) syntheticImage.getNumberOfFrames(), syntheticPixels});
+    
+    //Conversion of the decoded frames
+    benchmarkCases.push_back({"ConvertFrameToRGBA (sample)", noSetup,
+        [&](){
+            for(int currentFrame = 0; currentFrame < sampleImage.getNumberOfFrames(); currentFrame++)
+            {
+                sampleImage.ConvertFrameToRGBA(currentFrame, &rgbaBuffer.front(), sampleImage.getMaxImageWidth());
+            }
+        },
+        0, (double) sampleImage.getNumberOfFrames(), samplePixels});
+    benchmarkCases.push_back({"ConvertFrameToRGBA (sample, compressed)", noSetup,
+        [&](){
+            for(int currentFrame = 0; currentFrame < compressedSampleImage.getNumberOfFrames(); currentFrame++)
+            {
+                compressedSampleImage.ConvertFrameToRGBA(currentFrame, &rgbaBuffer.front(), compressedSampleImage.getMaxImageWidth());
+            }
+        },
+        0, (double) sampleImage.getNumberOfFrames(), samplePixels});
+    benchmarkCases.push_back({"ConvertFrameToRGBA (sample, spans)", noSetup,
+        [&](){
+            for(int currentFrame = 0; currentFrame < spanSampleImage.getNumberOfFrames(); currentFrame++)
+            {
+                spanSampleImage.ConvertFrameToRGBA(currentFrame, &rgbaBuffer.front(), spanSampleImage.getMaxImageWidth());
+            }
+        },
+        0, (double) sampleImage.getNumberOfFrames(), samplePixels});
+    benchmarkCases.push_back({"GetColorFromPalette conversion (sample)", noSetup,
+        [&](){
+            for(int currentFrame = 0; currentFrame < sampleImage.getNumberOfFrames(); currentFrame++)
+            {
+                GRPFrame *convertFrame = sampleImage.GetFrame(currentFrame);
+                uint32_t *frameOrigin = &rgbaBuffer.front() + (convertFrame->GetYOffset() * sampleImage.getMaxImageWidth()) + convertFrame->GetXOffset();
+                for(framePixelVector::iterator currentPixel = convertFrame->frameData.begin(); currentPixel != convertFrame->frameData.end(); currentPixel++)
+                {
+                    colorValues pixelColor = samplePalette.GetColorFromPalette(currentPixel->colorPaletteReference);
+                    frameOrigin[(currentPixel->yPosition * sampleImage.getMaxImageWidth()) + currentPixel->xPosition] =
+                        ((uint32_t) pixelColor.RedElement << 24) | ((uint32_t) pixelColor.GreenElement << 16) | ((uint32_t) pixelColor.BlueElement << 8) | 0xFF;
+                }
+            }
+        },
+        0, (double) sampleImage.getNumberOfFrames(), samplePixels});
+    benchmarkCases.push_back({"ApplyShadowTable buffer (sample area)", reloadPalette,
+        [&](){ workPalette.ApplyShadowTable(&frameBuffer.front(), frameBuffer.size(), 16); },
+        (double) frameBuffer.size(), 0, (double) frameBuffer.size()});
+    //A crowded 640x480 screen of sample frames, single and multithreaded
+    std::vector<uint8_t> renderSurface(640 * 480);
+    GRPRenderer singleThreadRenderer(1);
+    GRPRenderer multiThreadRenderer;
+    GRPRenderer changesRenderer;
+    std::vector<grpDrawCommand> screenCommands;
+    for(int currentCommand = 0; currentCommand < 2000; currentCommand++)
+    {
+        grpDrawCommand drawCommand = {&sampleImage, currentCommand % sampleImage.getNumberOfFrames(),
+                                      ((currentCommand * 37) % 700) - 60, ((currentCommand * 53) % 540) - 60,
+                                      (currentCommand % 2) == 1, NULL, NULL};
+        singleThreadRenderer.AddDrawCommand(drawCommand);
+        multiThreadRenderer.AddDrawCommand(drawCommand);
+        screenCommands.push_back(drawCommand);
+    }
+    //The same screen with one sprite walking back and forth, only the
+    //tiles around it are redrawn
+    std::vector<uint8_t> backgroundSurface(640 * 480, 0);
+    int walkingStep = 0;
+    benchmarkCases.push_back({"GRPRenderer 2000 frames (1 thread)", noSetup,
+        [&](){ singleThreadRenderer.Render(&renderSurface.front(), 640, 480, 640); },
+        0, 2000, 0});
+    benchmarkCases.push_back({"GRPRenderer 2000 frames (all threads)", noSetup,
+        [&](){ multiThreadRenderer.Render(&renderSurface.front(), 640, 480, 640); },
+        0, 2000, 0});
+    benchmarkCases.push_back({"GRPRenderer 2000 frames (changes only)", noSetup,
+        [&]()
+        {
+            walkingStep = (walkingStep + 1) % 16;
+            screenCommands.at(1000).xPosition = 300 + (walkingStep * 4);
+            changesRenderer.ClearDrawCommands();
+            for(std::vector<grpDrawCommand>::iterator currentCommand = screenCommands.begin(); currentCommand != screenCommands.end(); currentCommand++)
+            {
+                changesRenderer.AddDrawCommand(*currentCommand);
+            }
+            changesRenderer.RenderChanges(&renderSurface.front(), 640, 480, 640, &backgroundSurface.front(), 640);
+        },
+        0, 2000, 0});
+    //Pixel exact overlap tests between synthetic frames at scattered offsets
+    GRPImage maskSyntheticImage;
+    maskSyntheticImage.SetBuildCollisionMasks(true);
+    maskSyntheticImage.LoadImage(&syntheticImageData, false);
+    int collisionsFound = 0;
+    benchmarkCases.push_back({"CollidesWith 10000 pairs (synthetic)", noSetup,
+        [&]()
+        {
+            for(int currentTest = 0; currentTest < 10000; currentTest++)
+            {
+                GRPFrame *thisFrame = maskSyntheticImage.GetFrame(currentTest % maskSyntheticImage.getNumberOfFrames());
+                GRPFrame *otherFrame = maskSyntheticImage.GetFrame((currentTest * 7) % maskSyntheticImage.getNumberOfFrames());
+                collisionsFound += thisFrame->CollidesWith(*otherFrame, ((currentTest * 37) % 200) - 100, ((currentTest * 53) % 200) - 100);
+            }
+        },
+        0, 10000, 0});
+#if MAGICKPP_FOUND
+    benchmarkCases.push_back({"SaveConvertedImage (sample)", noSetup,
+        [&](){ sampleImage.SaveConvertedImage("libgrpBenchmark.png", 0, sampleImage.getNumberOfFrames(), true, 17); },
+        0, (double) sampleImage.getNumberOfFrames(), samplePixels});
+#endif
+    
+    //ColorPalette table generation, the palette is reloaded before each
+    //run so the tables are built from scratch.
+    benchmarkCases.push_back({"GenerateTransparentColorsTable", reloadPalette,
+        [&](){ workPalette.GenerateTransparentColorsTable(); }, 0, 0, 0});
+    benchmarkCases.push_back({"GenerateGreyscaleTable", reloadPalette,
+        [&](){ workPalette.GenerateGreyscaleTable(); }, 0, 0, 0});
+    benchmarkCases.push_back({"GenerateShadowtable", reloadPalette,
+        [&](){ workPalette.GenerateShadowtable(); }, 0, 0, 0});
+    benchmarkCases.push_back({"GenerateLighttable", reloadPalette,
+        [&](){ workPalette.GenerateLighttable(); }, 0, 0, 0});
+    benchmarkCases.push_back({"GenerateRedtable", reloadPalette,
+        [&](){ workPalette.GenerateRedtable(); }, 0, 0, 0});
+    benchmarkCases.push_back({"GenerateGreentable", reloadPalette,
+        [&](){ workPalette.GenerateGreentable(); }, 0, 0, 0});
+    benchmarkCases.push_back({"GenerateBluetable", reloadPalette,
+        [&](){ workPalette.GenerateBluetable(); }, 0, 0, 0});
+    benchmarkCases.push_back({"GenerateColorTables", reloadPalette,
+        [&](){ workPalette.GenerateColorTables(); }, 0, 0, 0});
+    benchmarkCases.push_back({"GenerateColorizedTable", reloadPalette,
+        [&](){ delete workPalette.GenerateColorizedTable(32, glowStart, glowEnd); }, 0, 0, 0});
+    benchmarkCases.push_back({"GenerateRemapTable", reloadPalette,
+        [&](){ workPalette.GenerateRemapTable(destinationPalette); }, 0, 0, 0});
+    
+    std::cout << "libgrp benchmarks, " << repetitions << " repetitions (median / fastest)\n";
+    std::cout << std::left << std::setw(42) << "Benchmark" << std::right
+              << std::setw(12) << "median ms" << std::setw(12) << "fastest ms"
+              << std::setw(12) << "MB/s" << std::setw(12) << "frames/s" << std::setw(12) << "ns/pixel" << '\n';
+    for(std::vector<benchmarkCase>::iterator currentCase = benchmarkCases.begin(); currentCase != benchmarkCases.end(); currentCase++)
+    {
+        RunBenchmark(*currentCase, repetitions);
+    }
+    
+    return 0;
+}
+
+void RunBenchmark(const benchmarkCase &currentCase, int repetitions)
+{
+    std::vector<double> runTimes;
+    
+    //Warm up run
+    currentCase.setup();
+    currentCase.run();
+    
+    for(int currentRepetition = 0; currentRepetition < repetitions; currentRepetition++)
+    {
+        currentCase.setup();
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        currentCase.run();
+        std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+        runTimes.push_back(std::chrono::duration<double>(endTime - startTime).count());
+    }
+    std::sort(runTimes.begin(), runTimes.end());
+    double medianTime = runTimes.at(runTimes.size() / 2);
+    
+    std::cout << std::left << std::setw(42) << currentCase.benchmarkName << std::right << std::fixed << std::setprecision(3)
+              << std::setw(12) << (medianTime * 1000.0) << std::setw(12) << (runTimes.front() * 1000.0) << std::setprecision(1);
+    if(currentCase.bytesProcessed > 0)
+        std::cout << std::setw(12) << ((currentCase.bytesProcessed / (1024.0 * 1024.0)) / medianTime);
+    else
+        std::cout << std::setw(12) << '-';
+    if(currentCase.framesProcessed > 0)
+        std::cout << std::setw(12) << (currentCase.framesProcessed / medianTime);
+    else
+        std::cout << std::setw(12) << '-';
+    if(currentCase.pixelsProcessed > 0)
+        std::cout << std::setw(12) << std::setprecision(2) << ((medianTime * 1000000000.0) / currentCase.pixelsProcessed);
+    else
+        std::cout << std::setw(12) << '-';
+    std::cout << '\n';
+}
+
+void LoadFileToVectorBenchmark(std::string filePath, std::vector<char> *destinationVector)
+{
+    std::ifstream inputFile(filePath.c_str(), std::ios::binary);
+    if(!inputFile.is_open())
+    {
+        throw std::ios_base::failure("Unable to open " + filePath);
+    }
+    inputFile.seekg(0, std::ios::end);
+    destinationVector->resize(inputFile.tellg());
+    inputFile.seekg(0, std::ios::beg);
+    inputFile.read(&destinationVector->front(), destinationVector->size());
+}
@@ -0,0 +1,61 @@
+/*!
+ *  \brief     Benchmark Runner
+ *  \details   Times the libgrp hot paths (image loading, frame decoding,
+ *              conversion and the ColorPalette table generation) on the
+ *              sample content and on synthetic images. Every case is run
+ *              a number of times and the median is reported so results
+ *              can be compared before and after a change.
+ *  \author    libgrp Authors
+ *  \version   0.0.1
+ *  \date      2013 - Present
+ */
+#ifndef libgrpBenchmarkMain_H
+#define libgrpBenchmarkMain_H
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include "../Source/libgrp.hpp"
+#include "../Tools/GenerateGRP/GRPGenerator.hpp"
+
+#ifdef __APPLE__
+#define PALETTEFILEPATH "../../Documentation/SampleContent/SamplePalette.pal"
+#define GRPIMAGEFILEPATH "../../Documentation/SampleContent/SampleImage.grp"
+
+#else
+#define PALETTEFILEPATH "../Documentation/SampleContent/SamplePalette.pal"
+#define GRPIMAGEFILEPATH "../Documentation/SampleContent/SampleImage.grp"
+#endif
+
+//The number of timed runs of each case, can be changed on the command line
+#define DEFAULTREPETITIONS 15
+
+//A single timed operation, the work amounts are per run and are
+//used to derive the throughput columns (0 leaves the column blank).
+struct benchmarkCase
+{
+    std::string benchmarkName;
+    //Untimed preparation before each run
+    std::function<void()> setup;
+    //The timed operation
+    std::function<void()> run;
+    double bytesProcessed;
+    double framesProcessed;
+    double pixelsProcessed;
+};
+
+//!Time a benchmark case and print its results
+/*!Runs the case once untimed to warm the caches then repetitions more
+ * times, reporting the median and fastest run.
+ * \param[in] currentCase The case to time
+ * \param[in] repetitions The number of timed runs
+ * \note NA*/
+void RunBenchmark(const benchmarkCase &currentCase, int repetitions);
+
+//!Load a file into a std::vector<char>
+void LoadFileToVectorBenchmark(std::string filePath, std::vector<char> *destinationVector);
+
+#endif
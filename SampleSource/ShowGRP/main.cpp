@@ -106,7 +106,7 @@ int main(int count,char *argv[])
     return 0;
 }
 
-void LoadSDLColors(SDL_Surface *targetSurface, ColorPalette sourceColorPalette)
+void LoadSDLColors(SDL_Surface *targetSurface, ColorPalette &sourceColorPalette)
 {
     colorValues currentProcessingColor;
     SDL_Color sdlColors[sourceColorPalette.GetNumberOfColors()];
@@ -134,7 +134,7 @@ void UpdateSurface(SDL_Surface *targetSurface, std::vector<int8_t> background)
     //update screen
     SDL_UpdateRect(targetSurface, 0, 0, 0, 0);
 }
-void ApplyGRPImage(unsigned int xPosition, unsigned int yPosition, GRPImage targetGRPImage, unsigned int targetFrame)
+void ApplyGRPImage(unsigned int xPosition, unsigned int yPosition, GRPImage &targetGRPImage, unsigned int targetFrame)
 {
     
 }
\ No newline at end of file
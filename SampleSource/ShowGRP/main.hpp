@@ -24,10 +24,10 @@ enum colorTableSelect {NONE, SHADOWTABLE, LIGHTTABLE, REDTABLE, BLUETABLE, GREEN
     typedef uint32_t u_int32_t;
 #endif
 
-void LoadSDLColors(SDL_Surface *targetSurface, ColorPalette sourceColorPalette);
+void LoadSDLColors(SDL_Surface *targetSurface, ColorPalette &sourceColorPalette);
 void UpdateSurface(SDL_Surface *targetSurface, std::vector<int8_t> background);
-void ApplyColorizedValues(ColorPalette applicationPalette, colorTableSelect selectedTable, colorValues targetColor);
-void ApplyGRPImage(unsigned int xPosition, unsigned int yPosition, GRPImage targetGRPImage, unsigned int targetFrame);
+void ApplyColorizedValues(ColorPalette &applicationPalette, colorTableSelect selectedTable, colorValues targetColor);
+void ApplyGRPImage(unsigned int xPosition, unsigned int yPosition, GRPImage &targetGRPImage, unsigned int targetFrame);
 
 
 #ifdef __APPLE__
@@ -95,7 +95,7 @@ int main(int count,char *argv[])
     return 0;
 }
 
-void LoadSDLColors(SDL_Surface *targetSurface, ColorPalette sourceColorPalette)
+void LoadSDLColors(SDL_Surface *targetSurface, ColorPalette &sourceColorPalette)
 {
     colorValues currentProcessingColor;
     SDL_Color sdlColors[sourceColorPalette.GetNumberOfColors()];
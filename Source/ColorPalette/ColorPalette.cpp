@@ -1,4 +1,40 @@
 #include "ColorPalette.hpp"
+#include "../GRPTrace/GRPTrace.hpp"
+#include "../GRPFrame/GRPFrame.hpp"
+#include <chrono>
+#include <mutex>
+#include <set>
+
+//Every live ColorPalette, used for the process wide memory usage
+static std::mutex livePalettesMutex;
+static std::set<const ColorPalette *> livePalettes;
+
+static void RegisterLivePalette(const ColorPalette *livePalette)
+{
+    std::lock_guard<std::mutex> livePalettesLock(livePalettesMutex);
+    livePalettes.insert(livePalette);
+}
+
+//Point a generated table at its updated copy in the cache, a table that
+//was never generated stays NULL
+static void RefreshNamedTable(sharedColorTable &namedTable, const colorizedTableParameters &tableParameters, const std::map<colorizedTableParameters, sharedColorTable> &tableCache)
+{
+    if(namedTable == NULL)
+    {
+        return;
+    }
+    std::map<colorizedTableParameters, sharedColorTable>::const_iterator cachedTable = tableCache.find(tableParameters);
+    if(cachedTable != tableCache.end())
+    {
+        namedTable = cachedTable->second;
+    }
+}
+
+//Seconds passed since startTime, used by the statistics timers
+static double GetElapsedSeconds(std::chrono::steady_clock::time_point startTime)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
 
 ColorPalette::ColorPalette()
 {
@@ -7,49 +43,130 @@ ColorPalette::ColorPalette()
 #endif
     transparentColorsTable = NULL;
     greyscaleTable = NULL;
-    shadowTable = NULL;
-    formattedPaletteData = NULL;
-    lightTable = NULL;
-    redTable = NULL;
-    greenTable = NULL;
-    blueTable =NULL;
+    ClearPackedPalette();
+    RegisterLivePalette(this);
+    ResetStatistics();
 }
 
 ColorPalette::~ColorPalette()
 {
     ClearAllTables();
+    std::lock_guard<std::mutex> livePalettesLock(livePalettesMutex);
+    livePalettes.erase(this);
 }
 
 ColorPalette::ColorPalette(std::vector<char> *inputPalette)
 {
     transparentColorsTable = NULL;
     greyscaleTable = NULL;
-    shadowTable = NULL;
-    formattedPaletteData = NULL;
-    lightTable = NULL;
-    redTable = NULL;
-    greenTable = NULL;
-    blueTable =NULL;
+    ClearPackedPalette();
+    ResetStatistics();
     LoadPalette(inputPalette);
+    
+    //Only registered once loaded, a throwing constructor runs no destructor
+    //to take the palette out of livePalettes again
+    RegisterLivePalette(this);
 }
 
 ColorPalette::ColorPalette(std::string filePath)
 {
     transparentColorsTable = NULL;
     greyscaleTable = NULL;
-    shadowTable = NULL;
-    formattedPaletteData = NULL;
-    lightTable = NULL;
-    redTable = NULL;
-    greenTable = NULL;
-    blueTable =NULL;
+    ClearPackedPalette();
+    ResetStatistics();
     LoadPalette(filePath);
+    RegisterLivePalette(this);
+}
+
+ColorPalette::ColorPalette(ColorPalette &&sourcePalette)
+{
+    transparentColorsTable = NULL;
+    greyscaleTable = NULL;
+    ClearPackedPalette();
+    RegisterLivePalette(this);
+    ResetStatistics();
+    *this = std::move(sourcePalette);
+}
+
+ColorPalette &ColorPalette::operator=(ColorPalette &&sourcePalette)
+{
+    if(this == &sourcePalette)
+    {
+        return *this;
+    }
+    ClearAllTables();
+    
+    numberOfColors = sourcePalette.numberOfColors;
+    std::copy(sourcePalette.packedPaletteData, sourcePalette.packedPaletteData + (MAXIMUMNUMBEROFCOLORSPERPALETTE * 3), packedPaletteData);
+    std::copy(sourcePalette.rgbaLookupTable, sourcePalette.rgbaLookupTable + MAXIMUMNUMBEROFCOLORSPERPALETTE, rgbaLookupTable);
+    std::copy(sourcePalette.bgraLookupTable, sourcePalette.bgraLookupTable + MAXIMUMNUMBEROFCOLORSPERPALETTE, bgraLookupTable);
+    std::copy(sourcePalette.dirtyColors, sourcePalette.dirtyColors + MAXIMUMNUMBEROFCOLORSPERPALETTE, dirtyColors);
+    
+    //The tables change owner, the source must not delete them
+    transparentColorsTable = sourcePalette.transparentColorsTable;
+    sourcePalette.transparentColorsTable = NULL;
+    greyscaleTable = sourcePalette.greyscaleTable;
+    sourcePalette.greyscaleTable = NULL;
+    lightTable = std::move(sourcePalette.lightTable);
+    shadowTable = std::move(sourcePalette.shadowTable);
+    redTable = std::move(sourcePalette.redTable);
+    greenTable = std::move(sourcePalette.greenTable);
+    blueTable = std::move(sourcePalette.blueTable);
+    colorizedTableCache = std::move(sourcePalette.colorizedTableCache);
+    
+    shadowTableParameters = sourcePalette.shadowTableParameters;
+    lightTableParameters = sourcePalette.lightTableParameters;
+    redTableParameters = sourcePalette.redTableParameters;
+    greenTableParameters = sourcePalette.greenTableParameters;
+    blueTableParameters = sourcePalette.blueTableParameters;
+    paletteStatistics = sourcePalette.paletteStatistics;
+    
+    sourcePalette.ClearAllTables();
+    sourcePalette.ResetStatistics();
+    return *this;
+}
+
+ColorPalette ColorPalette::Clone() const
+{
+    ColorPalette clonedPalette;
+    
+    clonedPalette.numberOfColors = numberOfColors;
+    std::copy(packedPaletteData, packedPaletteData + (MAXIMUMNUMBEROFCOLORSPERPALETTE * 3), clonedPalette.packedPaletteData);
+    std::copy(rgbaLookupTable, rgbaLookupTable + MAXIMUMNUMBEROFCOLORSPERPALETTE, clonedPalette.rgbaLookupTable);
+    std::copy(bgraLookupTable, bgraLookupTable + MAXIMUMNUMBEROFCOLORSPERPALETTE, clonedPalette.bgraLookupTable);
+    std::copy(dirtyColors, dirtyColors + MAXIMUMNUMBEROFCOLORSPERPALETTE, clonedPalette.dirtyColors);
+    
+    //The transparent and greyscale tables are updated in place, so the
+    //clone gets its own copy. Colorized tables are never modified once
+    //built and can be shared.
+    if(transparentColorsTable != NULL)
+    {
+        clonedPalette.transparentColorsTable = new std::vector<uint8_t>(*transparentColorsTable);
+    }
+    if(greyscaleTable != NULL)
+    {
+        clonedPalette.greyscaleTable = new std::vector<uint8_t>(*greyscaleTable);
+    }
+    clonedPalette.lightTable = lightTable;
+    clonedPalette.shadowTable = shadowTable;
+    clonedPalette.redTable = redTable;
+    clonedPalette.greenTable = greenTable;
+    clonedPalette.blueTable = blueTable;
+    clonedPalette.colorizedTableCache = colorizedTableCache;
+    
+    clonedPalette.shadowTableParameters = shadowTableParameters;
+    clonedPalette.lightTableParameters = lightTableParameters;
+    clonedPalette.redTableParameters = redTableParameters;
+    clonedPalette.greenTableParameters = greenTableParameters;
+    clonedPalette.blueTableParameters = blueTableParameters;
+    
+    return clonedPalette;
 }
 
 void ColorPalette::LoadPalette(std::vector<char> *inputPalette)
 {
+    GRPTRACESCOPE("ColorPalette::LoadPalette");
     ClearAllTables();
-    colorValues currentColorProcessing;
     if(inputPalette == NULL)
     {
         CurruptColorPaletteException curruptPalette;
@@ -66,33 +183,40 @@ void ColorPalette::LoadPalette(std::vector<char> *inputPalette)
         curruptPalette.SetErrorMessage("Invalid or Currupt Color Palette; expecting 768 or 1024.");
         throw(curruptPalette);
     }
-    if(formattedPaletteData != NULL)
+    
+    //A 768 byte palette is packed Red, Green, Blue; the 1024 byte
+    //(wpe) palette pads every color with a fourth unused byte.
+    int bytesPerColor = inputPalette->size() / MAXIMUMNUMBEROFCOLORSPERPALETTE;
+    
+    //Start loading the Palette into the packed palette and lookup tables.
+    for(int loadCurrentColor = 0; loadCurrentColor < MAXIMUMNUMBEROFCOLORSPERPALETTE; loadCurrentColor++)
     {
-        delete formattedPaletteData;
+        SetPackedColor(loadCurrentColor,
+                       (uint8_t) inputPalette->at((bytesPerColor * loadCurrentColor)),
+                       (uint8_t) inputPalette->at((bytesPerColor * loadCurrentColor) + 1),
+                       (uint8_t) inputPalette->at((bytesPerColor * loadCurrentColor) + 2));
     }
-    formattedPaletteData = new std::vector<colorValues>;
-    formattedPaletteData->resize(inputPalette->size() / 3);
+    numberOfColors = MAXIMUMNUMBEROFCOLORSPERPALETTE;
+    paletteStatistics.palettesLoaded++;
+    paletteStatistics.bytesRead += inputPalette->size();
     
-    //Start loading the Palette into the formattedPaletteData Vector.
-    for(int loadCurrentColor = 0; loadCurrentColor < (inputPalette->size() / 3); loadCurrentColor++)
+#if VERBOSE >= 5
+    std::cout << "Loaded contents of Pallete\n";
+    
+    for(int loadCurrentColor = 0; loadCurrentColor < numberOfColors; loadCurrentColor++)
     {
-        currentColorProcessing.RedElement = (uint8_t) inputPalette->at((3 * loadCurrentColor));
-        currentColorProcessing.GreenElement = (uint8_t) inputPalette->at((3 * loadCurrentColor) + 1);
-        currentColorProcessing.BlueElement = (uint8_t) inputPalette->at((3 * loadCurrentColor) + 2);
-        
-        formattedPaletteData->at(loadCurrentColor) = currentColorProcessing;
+        std::cout << "Color: " << loadCurrentColor
+                  << "  Red: " << (int) packedPaletteData[3 * loadCurrentColor]
+                  << " Blue: " << (int) packedPaletteData[(3 * loadCurrentColor) + 2]
+                  << " Green: " << (int) packedPaletteData[(3 * loadCurrentColor) + 1] << '\n';
     }
+#endif
     
 #if DUMPPALETTEDATA
     std::ofstream outputPalleteData("ColorPalette.dat");
-    colorValues currentWriteColor;
-    for(int currentColor = 0; currentColor < formattedPaletteData->size(); currentColor++)
+    for(int currentColor = 0; currentColor < (numberOfColors * 3); currentColor++)
     {
-        currentWriteColor = formattedPaletteData->at(currentColor);
-        
-        outputPalleteData.put(currentWriteColor.RedElement);
-        outputPalleteData.put(currentWriteColor.GreenElement);
-        outputPalleteData.put(currentWriteColor.BlueElement);
+        outputPalleteData.put(packedPaletteData[currentColor]);
     }
     outputPalleteData.close();
 #endif
@@ -106,9 +230,6 @@ void ColorPalette::LoadPalette(std::string filePath)
     
     ClearAllTables();
     int inputFileSize;
-    colorValues currentColorProcessing;
-    
-
     
     std::ifstream inputFile(filePath.c_str(), std::ios::binary);
     inputFile.exceptions(std::ifstream::badbit | std::ifstream::failbit | std::ifstream::eofbit);
@@ -127,73 +248,25 @@ void ColorPalette::LoadPalette(std::string filePath)
         throw(curruptPalette);
     }
     
-    //Since the file passed the check allocated or resize the vector
-    //to the proper size.
-    if(formattedPaletteData == NULL)
-    {
-        #if VERBOSE >= 5
-        std::cout << "Initializing formattedPaletteData.\n";
-        #endif
-        formattedPaletteData = new std::vector<colorValues>;
-    }
-    formattedPaletteData->resize(inputFileSize / 3);
-    
-    //Start loading the Palette into the formattedPaletteData Vector.
-    for(int loadCurrentColor = 0; loadCurrentColor < (inputFileSize / 3); loadCurrentColor++)
-    {
-        currentColorProcessing.RedElement = inputFile.get();
-        currentColorProcessing.GreenElement = inputFile.get();
-        currentColorProcessing.BlueElement = inputFile.get();
-        
-        formattedPaletteData->at(loadCurrentColor) = currentColorProcessing;
-    }
-    
-#if VERBOSE >= 5
-    std::cout << "Loaded contents of Pallete\n";
-    
-    //Start loading the Palette into the formattedPaletteData Vector.
-    for(int loadCurrentColor = 0; loadCurrentColor < (inputFileSize / 3); loadCurrentColor++)
-    {
-        currentColorProcessing = formattedPaletteData->at(loadCurrentColor);
-        std::cout << "Color: " << loadCurrentColor
-                  << "  Red: " << currentColorProcessing.RedElement
-                  << " Blue: " << currentColorProcessing.BlueElement
-                  << " Green: " <<currentColorProcessing.GreenElement << '\n';
-    }
-#endif
-    
-#if DUMPPALETTEDATA
-    std::ofstream outputPalleteData("ColorPalette.dat");
-    colorValues currentWriteColor;
-    for(int currentColor = 0; currentColor < formattedPaletteData->size(); currentColor++)
-    {
-        currentWriteColor = formattedPaletteData->at(currentColor);
-        
-        outputPalleteData.put(currentWriteColor.RedElement);
-        outputPalleteData.put(currentWriteColor.GreenElement);
-        outputPalleteData.put(currentWriteColor.BlueElement);
-    }
-    outputPalleteData.close();
-#endif
+    //Read the whole palette in one go and pack it like a memory palette
+    std::vector<char> inputPalette(inputFileSize);
+    inputFile.read(&inputPalette.front(), inputFileSize);
+    LoadPalette(&inputPalette);
 }
 int ColorPalette::GetNumberOfColors()
 {
-    if(formattedPaletteData == NULL)
-    {
-        return 0;
-    }
-    return formattedPaletteData->size();
+    return numberOfColors;
 }
 
 colorValues ColorPalette::GetColorFromPalette(int colorNumber)
 {
-    if(formattedPaletteData == NULL)
+    if(numberOfColors == 0)
     {
         NoPaletteLoadedException noPaletteLoaded;
         noPaletteLoaded.SetErrorMessage("No palette data loaded");
         throw noPaletteLoaded;
     }
-    if(colorNumber < 0 || colorNumber > formattedPaletteData->size())
+    if(colorNumber < 0 || colorNumber >= numberOfColors)
     {
         #if VERBOSE >= 1
             std::cout << "Tried to access color " << colorNumber << '\n';
@@ -202,12 +275,13 @@ colorValues ColorPalette::GetColorFromPalette(int colorNumber)
         colorBoundsError.SetErrorMessage("Attempted color selection of the bounds");
         throw colorBoundsError;
     }
-    return formattedPaletteData->at(colorNumber);
+    return GetPackedColor(colorNumber);
 }
 
 void ColorPalette::GenerateTransparentColorsTable()
 {
-    if(formattedPaletteData == NULL)
+    GRPTRACESCOPE("ColorPalette::GenerateTransparentColorsTable");
+    if(numberOfColors == 0)
     {
         NoPaletteLoadedException paletteError;
         paletteError.SetErrorMessage("No Palette file is loaded!!");
@@ -220,62 +294,22 @@ void ColorPalette::GenerateTransparentColorsTable()
         transparentColorsTable = new std::vector<uint8_t>;
     }
     
+    std::chrono::steady_clock::time_point generationStart = std::chrono::steady_clock::now();
     transparentColorsTable->resize(MAXIMUMNUMBEROFCOLORSPERPALETTE * MAXIMUMNUMBEROFCOLORSPERPALETTE);
     
-    colorValues currentOnLightColor;
-    colorValues currentUnderLightColor;
-    colorValues currentCombinedLightColor;
-    colorValues differenceColor;
-
-    float leastColorDifference,currentColorDifference;
-    
-    
-    int currentSelectedColor, currentSelectedColor2, findcol, bestfit = 0;
+    int currentSelectedColor, currentSelectedColor2;
     
     for (currentSelectedColor2 = 0; currentSelectedColor2 < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentSelectedColor2++)
     {
-        currentUnderLightColor = GetColorFromPalette(currentSelectedColor2);
-        currentUnderLightColor.RedElement *= LIGHTLEVELUNDER;
-        currentUnderLightColor.GreenElement *= LIGHTLEVELUNDER;
-        currentUnderLightColor.BlueElement *= LIGHTLEVELUNDER;
-        
         for (currentSelectedColor = 0; currentSelectedColor < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentSelectedColor++)
         {
-            currentOnLightColor = GetColorFromPalette(currentSelectedColor);
-            currentOnLightColor.RedElement *= LIGHTLEVELON;
-            currentOnLightColor.GreenElement *= LIGHTLEVELON;
-            currentOnLightColor.BlueElement *= LIGHTLEVELON;
-        
-            currentCombinedLightColor.RedElement = (long) (currentOnLightColor.RedElement + currentUnderLightColor.RedElement);
-            currentCombinedLightColor.GreenElement = (long) (currentOnLightColor.GreenElement + currentUnderLightColor.GreenElement);
-            currentCombinedLightColor.BlueElement = (long) (currentOnLightColor.BlueElement + currentUnderLightColor.BlueElement);
-            
-            //Set the maximum value of a float to avoid false differences
-            leastColorDifference = 655350.0;
-            
-            for  (findcol = 0; findcol < MAXIMUMNUMBEROFCOLORSPERPALETTE; findcol++)
-            {
-                differenceColor = GetColorFromPalette(findcol);
-                differenceColor = GetColorDifference(differenceColor, currentCombinedLightColor);
-                differenceColor.RedElement *= 30;
-                differenceColor.GreenElement *= 59;
-                differenceColor.BlueElement *= 11;
-                
-
-                currentColorDifference = sqrt((differenceColor.RedElement * differenceColor.RedElement) +
-                              (differenceColor.BlueElement * differenceColor.BlueElement) +
-                              (differenceColor.GreenElement * differenceColor.GreenElement));
-                
-                if  (currentColorDifference < leastColorDifference)//found best equality
-                {
-                    leastColorDifference = currentColorDifference;
-                    bestfit = findcol;
-                }
-            }
             //Now that we found the best possible color match, save the result in the table.
-            transparentColorsTable->at((currentSelectedColor2 * MAXIMUMNUMBEROFCOLORSPERPALETTE + currentSelectedColor)) = bestfit;
+            transparentColorsTable->at((currentSelectedColor2 * MAXIMUMNUMBEROFCOLORSPERPALETTE + currentSelectedColor)) =
+                FindNearestColor(GetTransparentTargetColor(currentSelectedColor2, currentSelectedColor), TRANSPARENTCOLORMATCH);
         }
     }
+    paletteStatistics.tablesGenerated++;
+    paletteStatistics.transparentTableSeconds += GetElapsedSeconds(generationStart);
 
 #if VERBOSE >= 5
     std::cout << "Generated values of Greyscale Table with size: " << transparentColorsTable->size() << '\n';
@@ -299,7 +333,8 @@ void ColorPalette::GenerateTransparentColorsTable()
 
 void ColorPalette::GenerateGreyscaleTable()
 {
-    if(formattedPaletteData == NULL)
+    GRPTRACESCOPE("ColorPalette::GenerateGreyscaleTable");
+    if(numberOfColors == 0)
     {
         NoPaletteLoadedException paletteError;
         paletteError.SetErrorMessage("No Palette file is loaded!!");
@@ -312,49 +347,15 @@ void ColorPalette::GenerateGreyscaleTable()
         greyscaleTable = new std::vector<uint8_t>;
     }
     
+    std::chrono::steady_clock::time_point generationStart = std::chrono::steady_clock::now();
     greyscaleTable->resize(MAXIMUMNUMBEROFCOLORSPERPALETTE);
     
-    colorValues currentColor, findColor;
-    float lowest, colorDifference;
-    int currentColorIndex,findcol,bestfit=0;
-    
-    int maxpalettecolor=256;
-    for (currentColorIndex = 0; currentColorIndex < maxpalettecolor; currentColorIndex++)
+    for (int currentColorIndex = 0; currentColorIndex < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentColorIndex++)
     {
-        currentColor = GetColorFromPalette(currentColorIndex);
-        currentColor.RedElement *= 30;
-        currentColor.BlueElement *= 59;
-        currentColor.GreenElement *= 11;
-        
-        //Don't think this does anything : \
-        //c1 = (currentColor.RedElement + currentColor.BlueElement + currentColor.GreenElement) / 100;
-        
-        currentColor.RedElement = (int) currentColor.RedElement;
-        currentColor.BlueElement = (int) currentColor.BlueElement;
-        currentColor.GreenElement = (int) currentColor.GreenElement;
-        
-        //Max value of an float
-        //lowest = 655350.0;
-        lowest = std::numeric_limits<float>::max();
-        for  (findcol = 0; findcol < maxpalettecolor; findcol++)
-        {
-            findColor = GetColorFromPalette(findcol);
-            findColor = GetColorDifference(findColor, currentColor);
-            findColor.RedElement *= 30;
-            findColor.BlueElement *= 11;
-            findColor.GreenElement *= 59;
-            
-    	    colorDifference = sqrt((findColor.RedElement * findColor.RedElement) +
-                          (findColor.BlueElement * findColor.BlueElement) +
-                          (findColor.GreenElement * findColor.GreenElement));
-    	    if  (colorDifference < lowest)
-    	    {
-                lowest = colorDifference;
-                bestfit = findcol;
-    	    }
-        }
-        greyscaleTable->at(currentColorIndex) = bestfit;
+        greyscaleTable->at(currentColorIndex) = FindNearestColor(GetGreyscaleTargetColor(currentColorIndex), GREYSCALECOLORMATCH);
     }
+    paletteStatistics.tablesGenerated++;
+    paletteStatistics.greyscaleTableSeconds += GetElapsedSeconds(generationStart);
 #if DUMPGREYSCALETABLE
     std::ofstream outputGreyscaleTable("tomono.grd");
     for(int currentColor = 0; currentColor < greyscaleTable->size(); currentColor++)
@@ -365,6 +366,15 @@ void ColorPalette::GenerateGreyscaleTable()
 #endif
 }
 
+const uint8_t *ColorPalette::GetTransparentColorsTable()
+{
+    if(numberOfColors != 0 && transparentColorsTable == NULL)
+    {
+        GenerateTransparentColorsTable();
+    }
+    return GetColorTableRow(transparentColorsTable, 0);
+}
+
 void ColorPalette::GenerateColorTables(int gradation)
 {
     GenerateTransparentColorsTable();
@@ -383,13 +393,10 @@ void ColorPalette::GenerateShadowtable(int gradation)
     blackColor.GreenElement = 0;
     blackColor.BlueElement = 0;
     
-    if(shadowTable != NULL);
-    {
-        delete shadowTable;
-        shadowTable = NULL;
-    }
-    
-    shadowTable = GenerateColorizedTable(gradation, blackColor, blackColor);
+    shadowTable = GetColorizedTable(gradation, blackColor, blackColor);
+    shadowTableParameters.maxGradation = gradation;
+    shadowTableParameters.startingGlowColor = blackColor;
+    shadowTableParameters.endingGlowColor = blackColor;
 #if DUMPSHADOWTABLE
     std::ofstream outputShadowTable("toblack.grd");
     for(int currentColor = 0; currentColor < shadowTable->size(); currentColor++)
@@ -407,12 +414,10 @@ void ColorPalette::GenerateLighttable(int gradation)
     whiteColor.GreenElement = 240;
     whiteColor.BlueElement = 240;
     
-    if(lightTable != NULL)
-    {
-        delete lightTable;
-        lightTable = NULL;
-    }
-    lightTable = GenerateColorizedTable(gradation, whiteColor, whiteColor);
+    lightTable = GetColorizedTable(gradation, whiteColor, whiteColor);
+    lightTableParameters.maxGradation = gradation;
+    lightTableParameters.startingGlowColor = whiteColor;
+    lightTableParameters.endingGlowColor = whiteColor;
 #if DUMPLIGHTTABLE
     std::ofstream outputLightTable("towhite.grd");
     for(int currentColor = 0; currentColor < lightTable->size(); currentColor++)
@@ -434,12 +439,10 @@ void ColorPalette::GenerateRedtable(int gradation)
     lightRedColor.GreenElement = 228;
     lightRedColor.BlueElement = 144;
     
-    if(redTable != NULL)
-    {
-        delete redTable;
-        redTable = NULL;
-    }
-    redTable = GenerateColorizedTable(gradation, redColor, lightRedColor);
+    redTable = GetColorizedTable(gradation, redColor, lightRedColor);
+    redTableParameters.maxGradation = gradation;
+    redTableParameters.startingGlowColor = redColor;
+    redTableParameters.endingGlowColor = lightRedColor;
     
 #if DUMPREDTABLE
     std::ofstream outputRedTable("tored.grd");
@@ -462,7 +465,10 @@ void ColorPalette::GenerateGreentable(int gradation)
     lightGreenColor.GreenElement = 252;
     lightGreenColor.BlueElement = 56;
     
-    greenTable = GenerateColorizedTable(gradation, greenColor, lightGreenColor);
+    greenTable = GetColorizedTable(gradation, greenColor, lightGreenColor);
+    greenTableParameters.maxGradation = gradation;
+    greenTableParameters.startingGlowColor = greenColor;
+    greenTableParameters.endingGlowColor = lightGreenColor;
     
 #if DUMPGREENTABLE
     std::ofstream outputGreenTable("togreen.grd");
@@ -485,7 +491,10 @@ void ColorPalette::GenerateBluetable(int gradation)
     lightBlueColor.GreenElement = 248;
     lightBlueColor.BlueElement = 248;
     
-    blueTable = GenerateColorizedTable(gradation, blueColor, lightBlueColor);
+    blueTable = GetColorizedTable(gradation, blueColor, lightBlueColor);
+    blueTableParameters.maxGradation = gradation;
+    blueTableParameters.startingGlowColor = blueColor;
+    blueTableParameters.endingGlowColor = lightBlueColor;
     
 #if DUMPBLUETABLE
     std::ofstream outputBlueTable("toblue.grd");
@@ -499,7 +508,7 @@ void ColorPalette::GenerateBluetable(int gradation)
 
 colorValues ColorPalette::ApplyShadowValue(colorValues baseColor, int targetApplication)
 {
-    if(formattedPaletteData == NULL)
+    if(numberOfColors == 0)
     {
         NoPaletteLoadedException noPaletteException;
         noPaletteException.SetErrorMessage("No Color Palette is loaded");
@@ -524,7 +533,7 @@ colorValues ColorPalette::ApplyShadowValue(colorValues baseColor, int targetAppl
 }
 colorValues ColorPalette::ApplyLightValue(colorValues baseColor, int targetApplication)
 {
-    if(formattedPaletteData == NULL)
+    if(numberOfColors == 0)
     {
         NoPaletteLoadedException noPaletteException;
         noPaletteException.SetErrorMessage("No Color Palette is loaded");
@@ -548,7 +557,7 @@ colorValues ColorPalette::ApplyLightValue(colorValues baseColor, int targetAppli
 }
 colorValues ColorPalette::ApplyRedValue(colorValues baseColor, int targetApplication)
 {
-    if(formattedPaletteData == NULL)
+    if(numberOfColors == 0)
     {
         NoPaletteLoadedException noPaletteException;
         noPaletteException.SetErrorMessage("No Color Palette is loaded");
@@ -571,7 +580,7 @@ colorValues ColorPalette::ApplyRedValue(colorValues baseColor, int targetApplica
 
 colorValues ColorPalette::ApplyGreenValue(colorValues baseColor, int targetApplication)
 {
-    if(formattedPaletteData == NULL)
+    if(numberOfColors == 0)
     {
         NoPaletteLoadedException noPaletteException;
         noPaletteException.SetErrorMessage("No Color Palette is loaded");
@@ -594,7 +603,7 @@ colorValues ColorPalette::ApplyGreenValue(colorValues baseColor, int targetAppli
 
 colorValues ColorPalette::ApplyBlueValue(colorValues baseColor, int targetApplication)
 {
-    if(formattedPaletteData == NULL)
+    if(numberOfColors == 0)
     {
         NoPaletteLoadedException noPaletteException;
         noPaletteException.SetErrorMessage("No Color Palette is loaded");
@@ -615,10 +624,146 @@ colorValues ColorPalette::ApplyBlueValue(colorValues baseColor, int targetApplic
     return appliedColor;
 }
 
+void ColorPalette::ApplyShadowTable(uint8_t *pixelBuffer, size_t bufferSize, int targetApplication)
+{
+    ApplyTableRow(GetColorTableRow(GetNamedColorTable(SHADOWCOLORTABLE), targetApplication), pixelBuffer, bufferSize);
+}
+
+void ColorPalette::ApplyShadowTable(GRPFrame *targetFrame, int targetApplication)
+{
+    targetFrame->ApplyColorTable(GetColorTableRow(GetNamedColorTable(SHADOWCOLORTABLE), targetApplication));
+}
+
+void ColorPalette::ApplyLightTable(uint8_t *pixelBuffer, size_t bufferSize, int targetApplication)
+{
+    ApplyTableRow(GetColorTableRow(GetNamedColorTable(LIGHTCOLORTABLE), targetApplication), pixelBuffer, bufferSize);
+}
+
+void ColorPalette::ApplyLightTable(GRPFrame *targetFrame, int targetApplication)
+{
+    targetFrame->ApplyColorTable(GetColorTableRow(GetNamedColorTable(LIGHTCOLORTABLE), targetApplication));
+}
+
+void ColorPalette::ApplyRedTable(uint8_t *pixelBuffer, size_t bufferSize, int targetApplication)
+{
+    ApplyTableRow(GetColorTableRow(GetNamedColorTable(REDCOLORTABLE), targetApplication), pixelBuffer, bufferSize);
+}
+
+void ColorPalette::ApplyRedTable(GRPFrame *targetFrame, int targetApplication)
+{
+    targetFrame->ApplyColorTable(GetColorTableRow(GetNamedColorTable(REDCOLORTABLE), targetApplication));
+}
+
+void ColorPalette::ApplyGreenTable(uint8_t *pixelBuffer, size_t bufferSize, int targetApplication)
+{
+    ApplyTableRow(GetColorTableRow(GetNamedColorTable(GREENCOLORTABLE), targetApplication), pixelBuffer, bufferSize);
+}
+
+void ColorPalette::ApplyGreenTable(GRPFrame *targetFrame, int targetApplication)
+{
+    targetFrame->ApplyColorTable(GetColorTableRow(GetNamedColorTable(GREENCOLORTABLE), targetApplication));
+}
+
+void ColorPalette::ApplyBlueTable(uint8_t *pixelBuffer, size_t bufferSize, int targetApplication)
+{
+    ApplyTableRow(GetColorTableRow(GetNamedColorTable(BLUECOLORTABLE), targetApplication), pixelBuffer, bufferSize);
+}
+
+void ColorPalette::ApplyBlueTable(GRPFrame *targetFrame, int targetApplication)
+{
+    targetFrame->ApplyColorTable(GetColorTableRow(GetNamedColorTable(BLUECOLORTABLE), targetApplication));
+}
+
+void ColorPalette::ApplyGreyscaleTable(uint8_t *pixelBuffer, size_t bufferSize)
+{
+    ApplyTableRow(GetColorTableRow(GetNamedColorTable(GREYSCALECOLORTABLE), 0), pixelBuffer, bufferSize);
+}
+
+void ColorPalette::ApplyGreyscaleTable(GRPFrame *targetFrame)
+{
+    targetFrame->ApplyColorTable(GetColorTableRow(GetNamedColorTable(GREYSCALECOLORTABLE), 0));
+}
+
+const std::vector<uint8_t> *ColorPalette::GetNamedColorTable(namedColorTable tableType)
+{
+    //Tables are generated with the default gradation on first use
+    bool generateTable = (numberOfColors != 0);
+    switch(tableType)
+    {
+        case SHADOWCOLORTABLE:
+            if(generateTable && shadowTable == NULL)
+            {
+                GenerateShadowtable();
+            }
+            return shadowTable.get();
+        case LIGHTCOLORTABLE:
+            if(generateTable && lightTable == NULL)
+            {
+                GenerateLighttable();
+            }
+            return lightTable.get();
+        case REDCOLORTABLE:
+            if(generateTable && redTable == NULL)
+            {
+                GenerateRedtable();
+            }
+            return redTable.get();
+        case GREENCOLORTABLE:
+            if(generateTable && greenTable == NULL)
+            {
+                GenerateGreentable();
+            }
+            return greenTable.get();
+        case BLUECOLORTABLE:
+            if(generateTable && blueTable == NULL)
+            {
+                GenerateBluetable();
+            }
+            return blueTable.get();
+        default:
+            if(generateTable && greyscaleTable == NULL)
+            {
+                GenerateGreyscaleTable();
+            }
+            return greyscaleTable;
+    }
+}
+
+void ColorPalette::ApplyTableRow(const uint8_t *tableRow, uint8_t *pixelBuffer, size_t bufferSize)
+{
+    for(size_t currentPixel = 0; currentPixel < bufferSize; currentPixel++)
+    {
+        pixelBuffer[currentPixel] = tableRow[pixelBuffer[currentPixel]];
+    }
+}
+
+const uint8_t *ColorPalette::GetColorTableRow(const std::vector<uint8_t> *colorTable, int targetApplication)
+{
+    if(numberOfColors == 0)
+    {
+        NoPaletteLoadedException noPaletteException;
+        noPaletteException.SetErrorMessage("No Color Palette is loaded");
+        throw noPaletteException;
+    }
+    //Each row holds one mapping for all of the palette indices
+    if((targetApplication < 0) || ((size_t) targetApplication >= (colorTable->size() / MAXIMUMNUMBEROFCOLORSPERPALETTE)))
+    {
+        OutofBoundsColorException outOfBoundsError;
+        outOfBoundsError.SetErrorMessage("Invalid targetApplication table row");
+        throw outOfBoundsError;
+    }
+    return &colorTable->at(targetApplication * MAXIMUMNUMBEROFCOLORSPERPALETTE);
+}
+
 std::vector<uint8_t> *ColorPalette::GenerateColorizedTable(int maxGradation, colorValues startingGlowColor, colorValues endingGlowColor)
 {
-    
-    if(formattedPaletteData == NULL)
+    //Hand out a private copy of the cached table, the caller owns it
+    return new std::vector<uint8_t>(*GetColorizedTable(maxGradation, startingGlowColor, endingGlowColor));
+}
+
+sharedColorTable ColorPalette::GetColorizedTable(int maxGradation, colorValues startingGlowColor, colorValues endingGlowColor)
+{
+    if(numberOfColors == 0)
     {
         NoPaletteLoadedException noPaletteLoaded;
         noPaletteLoaded.SetErrorMessage("No palette file has been loaded");
@@ -631,55 +776,152 @@ std::vector<uint8_t> *ColorPalette::GenerateColorizedTable(int maxGradation, col
         throw gradationError;
     }
     
+    colorizedTableParameters tableParameters;
+    tableParameters.maxGradation = maxGradation;
+    tableParameters.startingGlowColor = startingGlowColor;
+    tableParameters.endingGlowColor = endingGlowColor;
+    
+    std::map<colorizedTableParameters, sharedColorTable>::iterator cachedTable = colorizedTableCache.find(tableParameters);
+    if(cachedTable != colorizedTableCache.end())
+    {
+        paletteStatistics.colorizedCacheHits++;
+        return cachedTable->second;
+    }
+    
+    std::chrono::steady_clock::time_point generationStart = std::chrono::steady_clock::now();
+    sharedColorTable finalColorizedTable(BuildColorizedTable(tableParameters));
+    colorizedTableCache.insert(std::make_pair(tableParameters, finalColorizedTable));
+    paletteStatistics.tablesGenerated++;
+    paletteStatistics.colorizedTableSeconds += GetElapsedSeconds(generationStart);
+    return finalColorizedTable;
+}
+
+std::vector<uint8_t> *ColorPalette::BuildColorizedTable(const colorizedTableParameters &tableParameters)
+{
+    GRPTRACESCOPE("ColorPalette::BuildColorizedTable");
+    int maxGradation = tableParameters.maxGradation;
     std::vector<uint8_t> *finalColorizedTable = new std::vector<uint8_t>;
     finalColorizedTable->resize(MAXIMUMNUMBEROFCOLORSPERPALETTE * maxGradation);
     
-    colorValues firstColor, secondColor, differenceColor;
-    float lowest, totalColorDifference;
-    int currentBestFit = -1, currentColor, currentGradation, findColor;
-    std::vector<colorValues> glowColors = GenerateGlowColors(maxGradation, startingGlowColor, endingGlowColor);
+    int currentColor, currentGradation;
+    std::vector<colorValues> glowColors = GenerateGlowColors(maxGradation, tableParameters.startingGlowColor, tableParameters.endingGlowColor);
     
-    for(currentColor = 0; currentColor < maxGradation; currentColor++)
+    //Every row is a full lookup table, so whole buffers can be
+    //colorized through one row
+    for(currentGradation = 0; currentGradation < maxGradation; currentGradation++)
     {
-        for(currentGradation = 0; currentGradation < maxGradation; currentGradation++)
+        for(currentColor = 0; currentColor < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentColor++)
         {
-            firstColor = GetColorFromPalette(currentColor);
-            firstColor.RedElement = glowColors.at(currentGradation).RedElement * (currentGradation + 1);
-            firstColor.GreenElement = glowColors.at(currentGradation).GreenElement * (currentGradation + 1);
-            firstColor.BlueElement = glowColors.at(currentGradation).BlueElement * (currentGradation + 1);
-            
-            firstColor.RedElement /= maxGradation;
-            firstColor.GreenElement /= maxGradation;
-            firstColor.BlueElement /= maxGradation;
-            
-            lowest = 655350.0;
-            for (findColor = 0; findColor < MAXIMUMNUMBEROFCOLORSPERPALETTE; findColor++)
-            {
-                secondColor = GetColorFromPalette(findColor);
-                differenceColor = GetColorDifference(secondColor, firstColor);
-                differenceColor.RedElement *= 33;
-                differenceColor.GreenElement *= 33;
-                differenceColor.BlueElement *= 33;
-                
-                totalColorDifference = sqrt( (differenceColor.RedElement * differenceColor.RedElement) +
-                                            (differenceColor.GreenElement * differenceColor.GreenElement) +
-                                            (differenceColor.BlueElement * differenceColor.BlueElement));
-                
-                if(totalColorDifference < lowest)
-                {
-                    lowest = totalColorDifference;
-                    currentBestFit = findColor;
-                }
-            }
-            finalColorizedTable->at(MAXIMUMNUMBEROFCOLORSPERPALETTE * currentGradation + currentColor) = currentBestFit;
+            finalColorizedTable->at(MAXIMUMNUMBEROFCOLORSPERPALETTE * currentGradation + currentColor) =
+                FindNearestColor(GetColorizedTargetColor(glowColors, currentGradation, maxGradation, currentColor), COLORIZEDCOLORMATCH);
         }
     }
     return finalColorizedTable;
 }
 
+std::vector<uint8_t> ColorPalette::GenerateRemapTable(const ColorPalette &destinationPalette) const
+{
+    GRPTRACESCOPE("ColorPalette::GenerateRemapTable");
+    if(numberOfColors == 0 || destinationPalette.numberOfColors == 0)
+    {
+        NoPaletteLoadedException noPaletteLoaded;
+        noPaletteLoaded.SetErrorMessage("Both color palettes must be loaded");
+        throw noPaletteLoaded;
+    }
+    
+    std::vector<uint8_t> remapTable(MAXIMUMNUMBEROFCOLORSPERPALETTE);
+    for(int currentColor = 0; currentColor < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentColor++)
+    {
+        remapTable.at(currentColor) = destinationPalette.FindNearestColor(GetPackedColor(currentColor), REMAPCOLORMATCH);
+    }
+    return remapTable;
+}
+
+colorPaletteStatistics ColorPalette::GetStatistics() const
+{
+    return paletteStatistics;
+}
+
+void ColorPalette::ResetStatistics()
+{
+    paletteStatistics.palettesLoaded = 0;
+    paletteStatistics.bytesRead = 0;
+    paletteStatistics.tablesGenerated = 0;
+    paletteStatistics.colorizedCacheHits = 0;
+    paletteStatistics.tableUpdates = 0;
+    paletteStatistics.transparentTableSeconds = 0;
+    paletteStatistics.greyscaleTableSeconds = 0;
+    paletteStatistics.colorizedTableSeconds = 0;
+    paletteStatistics.tableUpdateSeconds = 0;
+}
+
+colorPaletteMemoryUsage ColorPalette::MemoryUsage() const
+{
+    colorPaletteMemoryUsage memoryUsage = {};
+    memoryUsage.paletteBytes = sizeof(ColorPalette);
+    if(transparentColorsTable != NULL)
+    {
+        memoryUsage.transparentTableBytes = sizeof(std::vector<uint8_t>) + transparentColorsTable->capacity();
+    }
+    if(greyscaleTable != NULL)
+    {
+        memoryUsage.greyscaleTableBytes = sizeof(std::vector<uint8_t>) + greyscaleTable->capacity();
+    }
+    
+    //The named colorized tables live in the cache, so every table is
+    //counted once while walking it.
+    for(std::map<colorizedTableParameters, sharedColorTable>::const_iterator currentTable = colorizedTableCache.begin(); currentTable != colorizedTableCache.end(); currentTable++)
+    {
+        size_t tableBytes = sizeof(std::vector<uint8_t>) + currentTable->second->capacity();
+        if(currentTable->second == shadowTable)
+            memoryUsage.shadowTableBytes += tableBytes;
+        else if(currentTable->second == lightTable)
+            memoryUsage.lightTableBytes += tableBytes;
+        else if(currentTable->second == redTable)
+            memoryUsage.redTableBytes += tableBytes;
+        else if(currentTable->second == greenTable)
+            memoryUsage.greenTableBytes += tableBytes;
+        else if(currentTable->second == blueTable)
+            memoryUsage.blueTableBytes += tableBytes;
+        else
+            memoryUsage.otherColorizedTableBytes += tableBytes;
+        
+        //The map node and the shared_ptr control block
+        memoryUsage.tableCacheBytes += sizeof(std::pair<const colorizedTableParameters, sharedColorTable>) + (4 * sizeof(void *));
+    }
+    
+    memoryUsage.totalBytes = memoryUsage.paletteBytes + memoryUsage.transparentTableBytes + memoryUsage.greyscaleTableBytes +
+                             memoryUsage.shadowTableBytes + memoryUsage.lightTableBytes + memoryUsage.redTableBytes +
+                             memoryUsage.greenTableBytes + memoryUsage.blueTableBytes + memoryUsage.otherColorizedTableBytes +
+                             memoryUsage.tableCacheBytes;
+    return memoryUsage;
+}
+
+colorPaletteMemoryUsage ColorPalette::GetTotalMemoryUsage()
+{
+    colorPaletteMemoryUsage totalUsage = {};
+    std::lock_guard<std::mutex> livePalettesLock(livePalettesMutex);
+    for(std::set<const ColorPalette *>::iterator currentPalette = livePalettes.begin(); currentPalette != livePalettes.end(); currentPalette++)
+    {
+        colorPaletteMemoryUsage paletteUsage = (*currentPalette)->MemoryUsage();
+        totalUsage.paletteBytes += paletteUsage.paletteBytes;
+        totalUsage.transparentTableBytes += paletteUsage.transparentTableBytes;
+        totalUsage.greyscaleTableBytes += paletteUsage.greyscaleTableBytes;
+        totalUsage.shadowTableBytes += paletteUsage.shadowTableBytes;
+        totalUsage.lightTableBytes += paletteUsage.lightTableBytes;
+        totalUsage.redTableBytes += paletteUsage.redTableBytes;
+        totalUsage.greenTableBytes += paletteUsage.greenTableBytes;
+        totalUsage.blueTableBytes += paletteUsage.blueTableBytes;
+        totalUsage.otherColorizedTableBytes += paletteUsage.otherColorizedTableBytes;
+        totalUsage.tableCacheBytes += paletteUsage.tableCacheBytes;
+        totalUsage.totalBytes += paletteUsage.totalBytes;
+    }
+    return totalUsage;
+}
+
 std::vector<colorValues> ColorPalette::GenerateTableWithConstraints(colorValues baseColor, float addGradation)
 {
-    if(formattedPaletteData == NULL)
+    if(numberOfColors == 0)
     {
         NoPaletteLoadedException noPaletteLoaded;
         noPaletteLoaded.SetErrorMessage("No color palette loaded");
@@ -704,7 +946,7 @@ std::vector<colorValues> ColorPalette::GenerateTableWithConstraints(colorValues
     
     for (int currentColor = 0; currentColor < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentColor ++)
     {
-        cachedColor = GetColorFromPalette(currentColor);
+        cachedColor = GetPackedColor(currentColor);
         
         firstColor.RedElement = (float) cachedColor.RedElement * baseColor.RedElement * (int)(addGradation / 100);
         if(firstColor.RedElement > 255)
@@ -728,7 +970,7 @@ std::vector<colorValues> ColorPalette::GenerateTableWithConstraints(colorValues
         
         for(int findColor = 0; findColor < MAXIMUMNUMBEROFCOLORSPERPALETTE; findColor++)
         {
-            secondColor = GetColorFromPalette(findColor);
+            secondColor = GetPackedColor(findColor);
             differenceColor = GetColorDifference(secondColor, firstColor);
             differenceColor.RedElement *= baseColor.RedElement;
             differenceColor.GreenElement *= baseColor.GreenElement;
@@ -743,7 +985,7 @@ std::vector<colorValues> ColorPalette::GenerateTableWithConstraints(colorValues
                 bestFittingColor = findColor;
             }
         }
-        finalConstrainedColorTable.at(currentColor) = GetColorFromPalette(bestFittingColor);
+        finalConstrainedColorTable.at(currentColor) = GetPackedColor(bestFittingColor);
     }
     return finalConstrainedColorTable;
 }
@@ -818,7 +1060,276 @@ std::vector<colorValues> ColorPalette::GenerateGlowColors(unsigned int maxGradat
     return finalGlowColors;
 }
 
-colorValues ColorPalette::GetColorDifference(colorValues initialColor, colorValues operationColor)
+void ColorPalette::SetColor(int colorNumber, colorValues newColor)
+{
+    std::vector<colorValues> newColors(1, newColor);
+    SetColors(colorNumber, newColors);
+}
+
+void ColorPalette::SetColors(int firstColorNumber, const std::vector<colorValues> &newColors)
+{
+    if(numberOfColors == 0)
+    {
+        NoPaletteLoadedException noPaletteLoaded;
+        noPaletteLoaded.SetErrorMessage("No palette data loaded");
+        throw noPaletteLoaded;
+    }
+    if(firstColorNumber < 0 || newColors.size() > (size_t) numberOfColors || (size_t) firstColorNumber > (size_t) numberOfColors - newColors.size())
+    {
+        OutofBoundsColorException colorBoundsError;
+        colorBoundsError.SetErrorMessage("Attempted color selection of the bounds");
+        throw colorBoundsError;
+    }
+    
+    for(size_t currentColor = 0; currentColor < newColors.size(); currentColor++)
+    {
+        int colorNumber = firstColorNumber + (int) currentColor;
+        colorValues oldColor = GetPackedColor(colorNumber);
+        
+        SetPackedColor(colorNumber,
+                       (uint8_t) std::min(std::max(newColors.at(currentColor).RedElement, 0.0f), 255.0f),
+                       (uint8_t) std::min(std::max(newColors.at(currentColor).GreenElement, 0.0f), 255.0f),
+                       (uint8_t) std::min(std::max(newColors.at(currentColor).BlueElement, 0.0f), 255.0f));
+        
+        //Only colors that actually changed have to be reevaluated
+        colorValues newColor = GetPackedColor(colorNumber);
+        if((oldColor.RedElement != newColor.RedElement) ||
+           (oldColor.GreenElement != newColor.GreenElement) ||
+           (oldColor.BlueElement != newColor.BlueElement))
+        {
+            dirtyColors[colorNumber] = true;
+        }
+    }
+    UpdateDirtyColorTables();
+}
+
+void ColorPalette::UpdateDirtyColorTables()
+{
+    GRPTRACESCOPE("ColorPalette::UpdateDirtyColorTables");
+    std::vector<int> changedColors;
+    for(int currentColor = 0; currentColor < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentColor++)
+    {
+        if(dirtyColors[currentColor])
+        {
+            changedColors.push_back(currentColor);
+        }
+    }
+    if(changedColors.empty())
+    {
+        return;
+    }
+#if VERBOSE >= 2
+    std::cout << "Updating color tables for " << changedColors.size() << " changed colors\n";
+#endif
+    std::chrono::steady_clock::time_point updateStart = std::chrono::steady_clock::now();
+    
+    if(transparentColorsTable != NULL)
+    {
+        for (int currentSelectedColor2 = 0; currentSelectedColor2 < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentSelectedColor2++)
+        {
+            for (int currentSelectedColor = 0; currentSelectedColor < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentSelectedColor++)
+            {
+                uint8_t &tableCell = transparentColorsTable->at((currentSelectedColor2 * MAXIMUMNUMBEROFCOLORSPERPALETTE + currentSelectedColor));
+                colorValues targetColor = GetTransparentTargetColor(currentSelectedColor2, currentSelectedColor);
+                
+                //The cells of a changed color have a new target color
+                if(dirtyColors[currentSelectedColor] || dirtyColors[currentSelectedColor2])
+                {
+                    tableCell = FindNearestColor(targetColor, TRANSPARENTCOLORMATCH);
+                }
+                else
+                {
+                    tableCell = UpdateNearestColor(targetColor, tableCell, TRANSPARENTCOLORMATCH, changedColors);
+                }
+            }
+        }
+    }
+    
+    if(greyscaleTable != NULL)
+    {
+        for (int currentColorIndex = 0; currentColorIndex < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentColorIndex++)
+        {
+            colorValues targetColor = GetGreyscaleTargetColor(currentColorIndex);
+            if(dirtyColors[currentColorIndex])
+            {
+                greyscaleTable->at(currentColorIndex) = FindNearestColor(targetColor, GREYSCALECOLORMATCH);
+            }
+            else
+            {
+                greyscaleTable->at(currentColorIndex) = UpdateNearestColor(targetColor, greyscaleTable->at(currentColorIndex), GREYSCALECOLORMATCH, changedColors);
+            }
+        }
+    }
+    
+    //Cached tables are shared and immutable, so every one is replaced by an
+    //updated copy. Anyone still holding an old table keeps the old colors.
+    for(std::map<colorizedTableParameters, sharedColorTable>::iterator currentTable = colorizedTableCache.begin(); currentTable != colorizedTableCache.end(); currentTable++)
+    {
+        std::vector<uint8_t> *updatedTable = new std::vector<uint8_t>(*currentTable->second);
+        UpdateColorizedTable(updatedTable, currentTable->first, changedColors);
+        currentTable->second = sharedColorTable(updatedTable);
+    }
+    RefreshNamedTable(shadowTable, shadowTableParameters, colorizedTableCache);
+    RefreshNamedTable(lightTable, lightTableParameters, colorizedTableCache);
+    RefreshNamedTable(redTable, redTableParameters, colorizedTableCache);
+    RefreshNamedTable(greenTable, greenTableParameters, colorizedTableCache);
+    RefreshNamedTable(blueTable, blueTableParameters, colorizedTableCache);
+    
+    std::fill(dirtyColors, dirtyColors + MAXIMUMNUMBEROFCOLORSPERPALETTE, false);
+    paletteStatistics.tableUpdates++;
+    paletteStatistics.tableUpdateSeconds += GetElapsedSeconds(updateStart);
+}
+
+void ColorPalette::UpdateColorizedTable(std::vector<uint8_t> *colorizedTable, const colorizedTableParameters &tableParameters, const std::vector<int> &changedColors)
+{
+    std::vector<colorValues> glowColors = GenerateGlowColors(tableParameters.maxGradation, tableParameters.startingGlowColor, tableParameters.endingGlowColor);
+    for(int currentGradation = 0; currentGradation < tableParameters.maxGradation; currentGradation++)
+    {
+        uint8_t *tableRow = &colorizedTable->at(MAXIMUMNUMBEROFCOLORSPERPALETTE * currentGradation);
+        for(int currentColor = 0; currentColor < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentColor++)
+        {
+            colorValues targetColor = GetColorizedTargetColor(glowColors, currentGradation, tableParameters.maxGradation, currentColor);
+            
+            //The cells of a changed color have a new target color
+            if(dirtyColors[currentColor])
+            {
+                tableRow[currentColor] = FindNearestColor(targetColor, COLORIZEDCOLORMATCH);
+            }
+            else
+            {
+                tableRow[currentColor] = UpdateNearestColor(targetColor, tableRow[currentColor], COLORIZEDCOLORMATCH, changedColors);
+            }
+        }
+    }
+}
+
+float ColorPalette::GetColorMatchDistance(colorValues paletteColor, colorValues targetColor, colorMatchMetric matchMetric) const
+{
+    //Each metric reproduces the weighting (and float evaluation order)
+    //the tables have always been generated with.
+    colorValues differenceColor = GetColorDifference(paletteColor, targetColor);
+    switch (matchMetric)
+    {
+        case TRANSPARENTCOLORMATCH:
+            differenceColor.RedElement *= 30;
+            differenceColor.GreenElement *= 59;
+            differenceColor.BlueElement *= 11;
+            return sqrt((differenceColor.RedElement * differenceColor.RedElement) +
+                        (differenceColor.BlueElement * differenceColor.BlueElement) +
+                        (differenceColor.GreenElement * differenceColor.GreenElement));
+        case GREYSCALECOLORMATCH:
+            differenceColor.RedElement *= 30;
+            differenceColor.BlueElement *= 11;
+            differenceColor.GreenElement *= 59;
+            return sqrt((differenceColor.RedElement * differenceColor.RedElement) +
+                        (differenceColor.BlueElement * differenceColor.BlueElement) +
+                        (differenceColor.GreenElement * differenceColor.GreenElement));
+        case REMAPCOLORMATCH:
+            //Plain luminance weighted distance
+            differenceColor.RedElement *= 30;
+            differenceColor.GreenElement *= 59;
+            differenceColor.BlueElement *= 11;
+            return sqrt((differenceColor.RedElement * differenceColor.RedElement) +
+                        (differenceColor.GreenElement * differenceColor.GreenElement) +
+                        (differenceColor.BlueElement * differenceColor.BlueElement));
+        case COLORIZEDCOLORMATCH:
+        default:
+            differenceColor.RedElement *= 33;
+            differenceColor.GreenElement *= 33;
+            differenceColor.BlueElement *= 33;
+            return sqrt((differenceColor.RedElement * differenceColor.RedElement) +
+                        (differenceColor.GreenElement * differenceColor.GreenElement) +
+                        (differenceColor.BlueElement * differenceColor.BlueElement));
+    }
+}
+
+uint8_t ColorPalette::FindNearestColor(colorValues targetColor, colorMatchMetric matchMetric) const
+{
+    float lowest = std::numeric_limits<float>::max();
+    float currentColorDifference;
+    int bestfit = 0;
+    
+    for (int findcol = 0; findcol < MAXIMUMNUMBEROFCOLORSPERPALETTE; findcol++)
+    {
+        currentColorDifference = GetColorMatchDistance(GetPackedColor(findcol), targetColor, matchMetric);
+        if  (currentColorDifference < lowest)//found best equality
+        {
+            lowest = currentColorDifference;
+            bestfit = findcol;
+        }
+    }
+    return bestfit;
+}
+
+uint8_t ColorPalette::UpdateNearestColor(colorValues targetColor, uint8_t previousBestFit, colorMatchMetric matchMetric, const std::vector<int> &changedColors) const
+{
+    //If the previous match itself changed anything could be closer now
+    if(dirtyColors[previousBestFit])
+    {
+        return FindNearestColor(targetColor, matchMetric);
+    }
+    
+    //Otherwise only the changed colors can beat the previous match,
+    //ties go to the lower index like a full search would.
+    float lowest = GetColorMatchDistance(GetPackedColor(previousBestFit), targetColor, matchMetric);
+    int bestfit = previousBestFit;
+    float currentColorDifference;
+    for(std::vector<int>::const_iterator currentColor = changedColors.begin(); currentColor != changedColors.end(); currentColor++)
+    {
+        currentColorDifference = GetColorMatchDistance(GetPackedColor(*currentColor), targetColor, matchMetric);
+        if((currentColorDifference < lowest) || ((currentColorDifference == lowest) && (*currentColor < bestfit)))
+        {
+            lowest = currentColorDifference;
+            bestfit = *currentColor;
+        }
+    }
+    return bestfit;
+}
+
+colorValues ColorPalette::GetTransparentTargetColor(int underColor, int onColor) const
+{
+    colorValues currentUnderLightColor = GetPackedColor(underColor);
+    currentUnderLightColor.RedElement *= LIGHTLEVELUNDER;
+    currentUnderLightColor.GreenElement *= LIGHTLEVELUNDER;
+    currentUnderLightColor.BlueElement *= LIGHTLEVELUNDER;
+    
+    colorValues currentOnLightColor = GetPackedColor(onColor);
+    currentOnLightColor.RedElement *= LIGHTLEVELON;
+    currentOnLightColor.GreenElement *= LIGHTLEVELON;
+    currentOnLightColor.BlueElement *= LIGHTLEVELON;
+    
+    colorValues currentCombinedLightColor;
+    currentCombinedLightColor.RedElement = (long) (currentOnLightColor.RedElement + currentUnderLightColor.RedElement);
+    currentCombinedLightColor.GreenElement = (long) (currentOnLightColor.GreenElement + currentUnderLightColor.GreenElement);
+    currentCombinedLightColor.BlueElement = (long) (currentOnLightColor.BlueElement + currentUnderLightColor.BlueElement);
+    return currentCombinedLightColor;
+}
+
+colorValues ColorPalette::GetGreyscaleTargetColor(int colorNumber) const
+{
+    colorValues currentColor = GetPackedColor(colorNumber);
+    currentColor.RedElement *= 30;
+    currentColor.BlueElement *= 59;
+    currentColor.GreenElement *= 11;
+    
+    currentColor.RedElement = (int) currentColor.RedElement;
+    currentColor.BlueElement = (int) currentColor.BlueElement;
+    currentColor.GreenElement = (int) currentColor.GreenElement;
+    return currentColor;
+}
+
+colorValues ColorPalette::GetColorizedTargetColor(const std::vector<colorValues> &glowColors, int currentGradation, int maxGradation, int sourceColor) const
+{
+    colorValues targetColor = GetPackedColor(sourceColor);
+    const colorValues &glowColor = glowColors.at(currentGradation);
+    float glowWeight = (float) currentGradation / maxGradation;
+    targetColor.RedElement += (glowColor.RedElement - targetColor.RedElement) * glowWeight;
+    targetColor.GreenElement += (glowColor.GreenElement - targetColor.GreenElement) * glowWeight;
+    targetColor.BlueElement += (glowColor.BlueElement - targetColor.BlueElement) * glowWeight;
+    return targetColor;
+}
+
+colorValues ColorPalette::GetColorDifference(colorValues initialColor, colorValues operationColor) const
 {
     colorValues difference;
     difference.RedElement = initialColor.RedElement - operationColor.RedElement;
@@ -830,13 +1341,12 @@ colorValues ColorPalette::GetColorDifference(colorValues initialColor, colorValu
 
 void ColorPalette::ClearAllTables()
 {
-    if(formattedPaletteData != NULL)
+    if(numberOfColors != 0)
     {
 #if VERBOSE >= 5
-        std::cout << "Deallocating formattedPalleteData.\n";
+        std::cout << "Clearing packed palette data.\n";
 #endif
-        delete formattedPaletteData;
-        formattedPaletteData = NULL;
+        ClearPackedPalette();
     }
     if(transparentColorsTable != NULL)
     {
@@ -859,39 +1369,92 @@ void ColorPalette::ClearAllTables()
 #if VERBOSE >= 5
         std::cout << "Deallocating shadowTable.\n";
 #endif
-        delete shadowTable;
-        shadowTable = NULL;
+        shadowTable.reset();
     }
     if(lightTable != NULL)
     {
 #if VERBOSE >= 5
         std::cout << "Deallocating lightTable.\n";
 #endif
-        delete lightTable;
-        lightTable = NULL;
+        lightTable.reset();
     }
     if(redTable != NULL)
     {
 #if VERBOSE >= 5
         std::cout << "Deallocating redTable.\n";
 #endif
-        delete redTable;
-        redTable = NULL;
+        redTable.reset();
     }
     if(greenTable != NULL)
     {
 #if VERBOSE >= 5
         std::cout << "Deallocating greenTable.\n";
 #endif
-        delete greenTable;
-        greenTable = NULL;
+        greenTable.reset();
     }
     if(blueTable != NULL)
     {
 #if VERBOSE >= 5
         std::cout << "Deallocating blueTable.\n";
 #endif
-        delete blueTable;
-        blueTable = NULL;
+        blueTable.reset();
+    }
+    colorizedTableCache.clear();
+}
+
+void ColorPalette::ClearPackedPalette()
+{
+    numberOfColors = 0;
+    std::fill(dirtyColors, dirtyColors + MAXIMUMNUMBEROFCOLORSPERPALETTE, false);
+    std::fill(packedPaletteData, packedPaletteData + (MAXIMUMNUMBEROFCOLORSPERPALETTE * 3), 0);
+    std::fill(rgbaLookupTable, rgbaLookupTable + MAXIMUMNUMBEROFCOLORSPERPALETTE, 0);
+    std::fill(bgraLookupTable, bgraLookupTable + MAXIMUMNUMBEROFCOLORSPERPALETTE, 0);
+}
+
+void ColorPalette::SetPackedColor(int colorNumber, uint8_t redElement, uint8_t greenElement, uint8_t blueElement)
+{
+    packedPaletteData[(3 * colorNumber)] = redElement;
+    packedPaletteData[(3 * colorNumber) + 1] = greenElement;
+    packedPaletteData[(3 * colorNumber) + 2] = blueElement;
+    
+    //The lookup entries are defined by their byte order in memory, so
+    //they can be copied straight into RGBA/BGRA pixel buffers on any host.
+    uint8_t *rgbaEntry = (uint8_t *) &rgbaLookupTable[colorNumber];
+    rgbaEntry[0] = redElement;
+    rgbaEntry[1] = greenElement;
+    rgbaEntry[2] = blueElement;
+    rgbaEntry[3] = 0xFF;
+    
+    uint8_t *bgraEntry = (uint8_t *) &bgraLookupTable[colorNumber];
+    bgraEntry[0] = blueElement;
+    bgraEntry[1] = greenElement;
+    bgraEntry[2] = redElement;
+    bgraEntry[3] = 0xFF;
+}
+
+bool operator<(const colorizedTableParameters &firstParameters, const colorizedTableParameters &secondParameters)
+{
+    if(firstParameters.maxGradation != secondParameters.maxGradation)
+    {
+        return firstParameters.maxGradation < secondParameters.maxGradation;
+    }
+    
+    const colorValues *firstColors[2] = {&firstParameters.startingGlowColor, &firstParameters.endingGlowColor};
+    const colorValues *secondColors[2] = {&secondParameters.startingGlowColor, &secondParameters.endingGlowColor};
+    for(int currentColor = 0; currentColor < 2; currentColor++)
+    {
+        if(firstColors[currentColor]->RedElement != secondColors[currentColor]->RedElement)
+        {
+            return firstColors[currentColor]->RedElement < secondColors[currentColor]->RedElement;
+        }
+        if(firstColors[currentColor]->GreenElement != secondColors[currentColor]->GreenElement)
+        {
+            return firstColors[currentColor]->GreenElement < secondColors[currentColor]->GreenElement;
+        }
+        if(firstColors[currentColor]->BlueElement != secondColors[currentColor]->BlueElement)
+        {
+            return firstColors[currentColor]->BlueElement < secondColors[currentColor]->BlueElement;
+        }
     }
+    return false;
 }
\ No newline at end of file
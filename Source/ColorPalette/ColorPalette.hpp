@@ -12,6 +12,9 @@
  *  \section basicColorPaletteFileLayout ColorPalette File Layout
  *  The standard GRP Color palette is either 768 or 1024 bytes
  *  each byte (uint8_t) represents one color element (Red, Blue, Green).
+ *  The 1024 byte (wpe) palette adds an unused fourth byte to each color.
+ *  Internally the colors are kept packed as 8bit Red, Green, Blue with
+ *  ready made 32bit RGBA and BGRA lookup tables for pixel conversion.
  *  \image html ColorPaletteFileLayout.png ![Diagram of GRP Color Palette Layout] 
  */
 
@@ -20,6 +23,9 @@
 #include <vector>
 #include <fstream>
 #include <limits>
+#include <algorithm>
+#include <map>
+#include <memory>
 #include <math.h>
 #include <inttypes.h>
 
@@ -72,6 +78,76 @@ struct colorValues
     float GreenElement;
 };
 
+//The weighting used when searching the palette for the closest color,
+//every generated table has always used its own weights.
+enum colorMatchMetric {TRANSPARENTCOLORMATCH, GREYSCALECOLORMATCH, COLORIZEDCOLORMATCH, REMAPCOLORMATCH};
+
+//The generated tables the Apply*Table methods index
+enum namedColorTable {SHADOWCOLORTABLE, LIGHTCOLORTABLE, REDCOLORTABLE, GREENCOLORTABLE, BLUECOLORTABLE, GREYSCALECOLORTABLE};
+
+//The values a colorized table was generated from, kept so the
+//table can be updated when palette colors change.
+struct colorizedTableParameters
+{
+    int maxGradation;
+    colorValues startingGlowColor;
+    colorValues endingGlowColor;
+};
+
+//Orders colorizedTableParameters so they can key the colorized table cache
+bool operator<(const colorizedTableParameters &firstParameters, const colorizedTableParameters &secondParameters);
+
+//Runtime counters of a ColorPalette, see ColorPalette::GetStatistics
+struct colorPaletteStatistics
+{
+    //Palettes loaded and the palette bytes read
+    uint64_t palettesLoaded;
+    uint64_t bytesRead;
+    
+    //Tables built from scratch and colorized tables served from the cache
+    uint64_t tablesGenerated;
+    uint64_t colorizedCacheHits;
+    
+    //Incremental table updates after palette colors changed
+    uint64_t tableUpdates;
+    
+    //Time spent building each kind of table and updating them
+    double transparentTableSeconds;
+    double greyscaleTableSeconds;
+    double colorizedTableSeconds;
+    double tableUpdateSeconds;
+};
+
+//The bytes held by a ColorPalette, see ColorPalette::MemoryUsage
+struct colorPaletteMemoryUsage
+{
+    //The ColorPalette object (packed palette and lookup tables)
+    size_t paletteBytes;
+    
+    size_t transparentTableBytes;
+    size_t greyscaleTableBytes;
+    size_t shadowTableBytes;
+    size_t lightTableBytes;
+    size_t redTableBytes;
+    size_t greenTableBytes;
+    size_t blueTableBytes;
+    
+    //Colorized tables only held by the cache (GetColorizedTable)
+    size_t otherColorizedTableBytes;
+    
+    //The colorized table cache bookkeeping
+    size_t tableCacheBytes;
+    
+    size_t totalBytes;
+};
+
+//A generated color table shared between the palette cache and its users,
+//it is never modified once handed out.
+typedef std::shared_ptr<const std::vector<uint8_t> > sharedColorTable;
+
+//The batch color table methods can remap a decoded frame directly
+class GRPFrame;
+
 class ColorPalette
 {
 	public:
@@ -82,6 +158,26 @@ class ColorPalette
         ColorPalette(std::vector<char> *inputPalette);
         ColorPalette(std::string filePath);
     
+        //!Take over the palette and tables of another ColorPalette
+        /*! Nothing is copied, the tables change owner.
+         * \param[in] sourcePalette The palette to take over, left unloaded
+         * \note NA*/
+        ColorPalette(ColorPalette &&sourcePalette);
+    
+        //!Take over the palette and tables of another ColorPalette
+        /*! The current tables are released first.
+         * \param[in] sourcePalette The palette to take over, left unloaded
+         * \note NA*/
+        ColorPalette &operator=(ColorPalette &&sourcePalette);
+    
+        //!Make a deep copy of the palette
+        /*! The colors and the transparent/greyscale tables are copied, the
+         *  immutable colorized tables are shared with the copy. The
+         *  statistics of the copy start at zero.
+         * \returns The copied ColorPalette
+         * \note NA*/
+        ColorPalette Clone() const;
+    
         //!Set palette data from memory
         /*! Use the palette data that is loaded in a the specified
         * vector.
@@ -125,6 +221,66 @@ class ColorPalette
         * \note NA*/
         colorValues GetColorFromPalette(int colorNumber);
     
+        //!Gets the packed Red/Green/Blue palette data
+        /*! Direct access to the palette, three bytes (Red, Green, Blue) per
+        *      color for all 256 colors. No copy or bounds check is made.
+        * \pre A palette should be loaded, otherwise every color is 0
+        * \returns A pointer to 768 bytes of packed palette data
+        * \note Valid until the palette is reloaded or destroyed*/
+        const uint8_t *GetPackedPaletteData() const noexcept
+        {
+            return packedPaletteData;
+        }
+    
+        //!Gets the 256 entry RGBA lookup table
+        /*! Every entry holds the color as the bytes Red, Green, Blue, Alpha
+        *      in memory order (Alpha is always opaque), so converting a
+        *      palette index to a RGBA pixel is one indexed load.
+        * \pre A palette should be loaded, otherwise every entry is 0
+        * \returns A pointer to 256 uint32_t RGBA entries
+        * \note Valid until the palette is reloaded or destroyed*/
+        const uint32_t *GetRGBALookupTable() const noexcept
+        {
+            return rgbaLookupTable;
+        }
+    
+        //!Gets the 256 entry BGRA lookup table
+        /*! Same as GetRGBALookupTable but with the bytes Blue, Green, Red, Alpha
+        *      in memory order.
+        * \pre A palette should be loaded, otherwise every entry is 0
+        * \returns A pointer to 256 uint32_t BGRA entries
+        * \note Valid until the palette is reloaded or destroyed*/
+        const uint32_t *GetBGRALookupTable() const noexcept
+        {
+            return bgraLookupTable;
+        }
+    
+        //!Change a single palette color
+        /*! Replaces one color of the loaded palette and updates every
+        *      already generated table in place. \see SetColors
+        * \pre A palette must be loaded and colorNumber a valid Color palette #
+        * \param[in] colorNumber The palette index to change
+        * \param[in] newColor The new color, elements are clamped to 0-255
+        * \throws OutofBoundsColorException
+        * \throws NoPaletteLoadedException
+        * \note NA*/
+        void SetColor(int colorNumber, colorValues newColor);
+    
+        //!Change a range of palette colors
+        /*! Replaces the colors starting at firstColorNumber. Unlike LoadPalette
+        *      the generated tables are kept; only the cells whose best match
+        *      could have changed are searched again, so palette cycling does
+        *      not pay for a full table regeneration.
+        * \pre A palette must be loaded and the range must fit in the palette
+        * \post The packed palette, lookup tables and generated color tables
+        *      match the new colors.
+        * \param[in] firstColorNumber The first palette index to change
+        * \param[in] newColors The new colors, elements are clamped to 0-255
+        * \throws OutofBoundsColorException
+        * \throws NoPaletteLoadedException
+        * \note NA*/
+        void SetColors(int firstColorNumber, const std::vector<colorValues> &newColors);
+    
         //!Generates the TransparentColor Table to be applied to the GRP images
         /* \pre A valid GRP Palette must be loaded to paletteData
          * \post A transparent color table will be generated based off
@@ -133,6 +289,16 @@ class ColorPalette
          * \note NA*/
         void GenerateTransparentColorsTable();
     
+        //!Gets the TransparentColor Table
+        /*!Generates the table if needed. The table is indexed
+         *  [underColor * 256 + onColor], the layout GRPRenderer expects of
+         *  a draw command blendTable.
+         * \pre A valid GRP Palette must be loaded to paletteData
+         * \returns The 256*256 table, valid until the palette is changed
+         * \throws NoPaletteLoadedException
+         * \note NA*/
+        const uint8_t *GetTransparentColorsTable();
+    
         //!Generates the GreyscaleColor Table to be applied to the GRP images
         /* \pre A valid GRP Palette must be loaded to paletteData
          * \post A greyscale color table will be generated based off
@@ -249,18 +415,141 @@ class ColorPalette
         * \throw OutofBoundsColorException
         * \note NA*/
         colorValues ApplyGreenValue(colorValues baseColor, int targetApplication);
-    
+
+        //!Apply a row of the shadow table to a whole 8bpp buffer
+        /*!Generates (if needed) the shadow table and remaps every palette index
+         *  in pixelBuffer through the 256 byte row selected by targetApplication.
+         *  Row 0 keeps every color, each further row moves them closer to black.
+         *  The palette and table checks are done once per call, not per pixel.
+         * \pre PaletteData loaded and targetApplication a valid table row
+         * \post Every byte of pixelBuffer is replaced by its shadowed color index
+         * \param[in,out] pixelBuffer The 8bpp palette indices to transform
+         * \param[in] bufferSize The number of bytes in pixelBuffer
+         * \param[in] targetApplication The desired table row (gradation level)
+         * \throws NoPaletteLoadedException
+         * \throws OutofBoundsColorException
+         * \note NA*/
+        void ApplyShadowTable(uint8_t *pixelBuffer, size_t bufferSize, int targetApplication);
+
+        //!Apply a row of the shadow table to every pixel of a GRPFrame
+        /*! \see ApplyShadowTable(uint8_t *, size_t, int)
+         * \param[in,out] targetFrame The decoded frame to transform
+         * \param[in] targetApplication The desired table row (gradation level)*/
+        void ApplyShadowTable(GRPFrame *targetFrame, int targetApplication);
+
+        //!Apply a row of the light table to a whole 8bpp buffer
+        /*! \see ApplyShadowTable(uint8_t *, size_t, int)*/
+        void ApplyLightTable(uint8_t *pixelBuffer, size_t bufferSize, int targetApplication);
+
+        //!Apply a row of the light table to every pixel of a GRPFrame
+        /*! \see ApplyShadowTable(GRPFrame *, int)*/
+        void ApplyLightTable(GRPFrame *targetFrame, int targetApplication);
+
+        //!Apply a row of the red table to a whole 8bpp buffer
+        /*! \see ApplyShadowTable(uint8_t *, size_t, int)*/
+        void ApplyRedTable(uint8_t *pixelBuffer, size_t bufferSize, int targetApplication);
+
+        //!Apply a row of the red table to every pixel of a GRPFrame
+        /*! \see ApplyShadowTable(GRPFrame *, int)*/
+        void ApplyRedTable(GRPFrame *targetFrame, int targetApplication);
+
+        //!Apply a row of the green table to a whole 8bpp buffer
+        /*! \see ApplyShadowTable(uint8_t *, size_t, int)*/
+        void ApplyGreenTable(uint8_t *pixelBuffer, size_t bufferSize, int targetApplication);
+
+        //!Apply a row of the green table to every pixel of a GRPFrame
+        /*! \see ApplyShadowTable(GRPFrame *, int)*/
+        void ApplyGreenTable(GRPFrame *targetFrame, int targetApplication);
+
+        //!Apply a row of the blue table to a whole 8bpp buffer
+        /*! \see ApplyShadowTable(uint8_t *, size_t, int)*/
+        void ApplyBlueTable(uint8_t *pixelBuffer, size_t bufferSize, int targetApplication);
+
+        //!Apply a row of the blue table to every pixel of a GRPFrame
+        /*! \see ApplyShadowTable(GRPFrame *, int)*/
+        void ApplyBlueTable(GRPFrame *targetFrame, int targetApplication);
+
+        //!Apply the greyscale table to a whole 8bpp buffer
+        /*!Generates (if needed) the greyscale table and remaps every palette
+         *  index in pixelBuffer to its closest grey.
+         * \pre PaletteData loaded
+         * \param[in,out] pixelBuffer The 8bpp palette indices to transform
+         * \param[in] bufferSize The number of bytes in pixelBuffer
+         * \throws NoPaletteLoadedException
+         * \note NA*/
+        void ApplyGreyscaleTable(uint8_t *pixelBuffer, size_t bufferSize);
+
+        //!Apply the greyscale table to every pixel of a GRPFrame
+        /*! \see ApplyGreyscaleTable(uint8_t *, size_t)*/
+        void ApplyGreyscaleTable(GRPFrame *targetFrame);
+
         //!Generates Colorization tables
         /*! Generates Colorization table (the table colors the start
          *  from startingGlowColor and transform to endingglowColor.
+         *  Row n holds MAXIMUMNUMBEROFCOLORSPERPALETTE entries, each palette
+         *  color moved n / maxGradation of the way to the glow color of row n.
          * \pre A valid palette file must be loaded
          * \returns A table with colors from startingGlowColor to endingGlowColor
          * \param [in] maxGradation The number of colors (shades) to generate
          * \param [in] startingGlowColor The starting color
          * \param [in] endingGlowColor The target color to generate towards
-         * \note NA*/
+         * \throws NoPaletteLoadedException
+         * \throws InvalidGradationValueException
+         * \note The caller owns (and must delete) the returned copy, prefer
+         *      GetColorizedTable to avoid the copy.*/
         std::vector<uint8_t> *GenerateColorizedTable(int maxGradation, colorValues startingGlowColor, colorValues endingGlowColor);
     
+        //!Gets a cached Colorization table
+        /*! Same table as GenerateColorizedTable, but every table is generated
+         *  only once per palette and shared, repeated requests with the same
+         *  maxGradation and glow colors cost a lookup.
+         * \pre A valid palette file must be loaded
+         * \returns A shared, immutable table with colors from startingGlowColor to endingGlowColor
+         * \param [in] maxGradation The number of colors (shades) to generate
+         * \param [in] startingGlowColor The starting color
+         * \param [in] endingGlowColor The target color to generate towards
+         * \throws NoPaletteLoadedException
+         * \throws InvalidGradationValueException
+         * \note LoadPalette empties the cache; SetColors replaces the cached
+         *      tables, tables already handed out keep their old contents.*/
+        sharedColorTable GetColorizedTable(int maxGradation, colorValues startingGlowColor, colorValues endingGlowColor);
+    
+        //!Generates a table to move image data to another palette
+        /*! For every color of this palette finds the closest color of
+         *  destinationPalette, so 8bpp data can be converted with one
+         *  lookup per pixel instead of going through RGB.
+         * \pre Both palettes must be loaded
+         * \returns A 256 byte table, table[thisPaletteIndex] = destinationPaletteIndex
+         * \param [in] destinationPalette The palette the image data should use
+         * \throws NoPaletteLoadedException
+         * \note Colors that exist in both palettes map to the first exact match*/
+        std::vector<uint8_t> GenerateRemapTable(const ColorPalette &destinationPalette) const;
+    
+        //!Get the runtime counters of the palette
+        /*! Counters accumulate over every load and table generation
+         *  until ResetStatistics is called.
+         * \returns A copy of the current colorPaletteStatistics
+         * \note NA*/
+        colorPaletteStatistics GetStatistics() const;
+    
+        //!Set all the runtime counters back to zero
+        void ResetStatistics();
+    
+        //!Get the bytes held by the palette and each of its tables
+        /*! Counts the allocated capacity of every table, allocator
+         *  overhead is not included.
+         * \returns The colorPaletteMemoryUsage of this palette
+         * \note A colorized table shared with callers is still counted here*/
+        colorPaletteMemoryUsage MemoryUsage() const;
+    
+        //!Get the summed MemoryUsage of every live ColorPalette
+        /*! \returns The colorPaletteMemoryUsage of all ColorPalettes in the process
+         * \warning Only the list of live palettes is locked, each palette is
+         *      read without a lock of its own. No other thread may be
+         *      loading a palette or building its tables while this runs.
+         * \note NA*/
+        static colorPaletteMemoryUsage GetTotalMemoryUsage();
+    
         //!Generate Colortable with the rules of passed in color and multiplicator
         /*! Details here
          * \pre Color Palette must be loaded
@@ -290,8 +579,91 @@ class ColorPalette
          * \pre Both colorValues structs must be declared and defined
          * \returns A new colorValues struct of initialColor - operationColor
          * \note difference = initialColor - operationColor NA*/  
-        colorValues GetColorDifference(colorValues initialColor, colorValues operationColor);
+        colorValues GetColorDifference(colorValues initialColor, colorValues operationColor) const;
+    
+        //!Gets the weighted distance between a palette color and a target
+        /*! \returns The distance of paletteColor to targetColor with the weights of matchMetric
+         * \note NA*/
+        float GetColorMatchDistance(colorValues paletteColor, colorValues targetColor, colorMatchMetric matchMetric) const;
+    
+        //!Searches the palette for the color closest to targetColor
+        /*! \pre A palette must be loaded
+         * \returns The lowest palette index with the smallest distance
+         * \note NA*/
+        uint8_t FindNearestColor(colorValues targetColor, colorMatchMetric matchMetric) const;
+    
+        //!Revalidates a previous FindNearestColor result after palette edits
+        /*! Only the changed colors are compared unless the previous match
+         *  itself changed, the result is the same as a new FindNearestColor.
+         * \pre dirtyColors must mark the changedColors
+         * \returns The lowest palette index with the smallest distance
+         * \note NA*/
+        uint8_t UpdateNearestColor(colorValues targetColor, uint8_t previousBestFit, colorMatchMetric matchMetric, const std::vector<int> &changedColors) const;
+    
+        //!The color the transparent table searches for (onColor over underColor)
+        colorValues GetTransparentTargetColor(int underColor, int onColor) const;
     
+        //!The color the greyscale table searches for
+        colorValues GetGreyscaleTargetColor(int colorNumber) const;
+    
+        //!The color a colorized table cell searches for, sourceColor moved
+        //!currentGradation / maxGradation of the way to its glow color
+        colorValues GetColorizedTargetColor(const std::vector<colorValues> &glowColors, int currentGradation, int maxGradation, int sourceColor) const;
+    
+        //!Updates all generated tables for the colors marked in dirtyColors
+        /*! \post All tables match the palette and dirtyColors is cleared
+         * \note NA*/
+        void UpdateDirtyColorTables();
+    
+        //!Updates a generated colorized table for the changed colors
+        /*! \pre colorizedTable was generated from tableParameters (or is NULL)
+         * \note NA*/
+        void UpdateColorizedTable(std::vector<uint8_t> *colorizedTable, const colorizedTableParameters &tableParameters, const std::vector<int> &changedColors);
+
+        //!Gets one 256 byte row of a generated color table
+        /*!Validates the palette and the requested row once so the batch
+         * Apply*Table methods can run without per pixel checks.
+         * \pre The table must be generated
+         * \returns A pointer to the first byte of the selected row
+         * \param[in] colorTable The generated table to index
+         * \param[in] targetApplication The desired table row (gradation level)
+         * \throws NoPaletteLoadedException
+         * \throws OutofBoundsColorException
+         * \note NA*/
+        const uint8_t *GetColorTableRow(const std::vector<uint8_t> *colorTable, int targetApplication);
+    
+        //!Generates a new Colorization table
+        /*! \pre A palette must be loaded and the parameters validated
+         * \returns A new table, owned by the caller
+         * \note NA*/
+        std::vector<uint8_t> *BuildColorizedTable(const colorizedTableParameters &tableParameters);
+    
+        //!Gets a packed palette color as colorValues without any checks
+        /*!Used by the table generators so the inner search loops do not
+         * pay for the GetColorFromPalette checks.
+         * \pre colorNumber must be in the range 0-255
+         * \returns The colorValues of colorNumber
+         * \note NA*/
+        colorValues GetPackedColor(int colorNumber) const noexcept
+        {
+            colorValues packedColor;
+            packedColor.RedElement = packedPaletteData[(3 * colorNumber)];
+            packedColor.GreenElement = packedPaletteData[(3 * colorNumber) + 1];
+            packedColor.BlueElement = packedPaletteData[(3 * colorNumber) + 2];
+            return packedColor;
+        }
+    
+        //!Sets one packed palette color and its lookup table entries
+        /*! \pre colorNumber must be in the range 0-255
+         * \post packedPaletteData, rgbaLookupTable and bgraLookupTable are updated
+         * \note NA*/
+        void SetPackedColor(int colorNumber, uint8_t redElement, uint8_t greenElement, uint8_t blueElement);
+    
+        //!Clears the packed palette and lookup tables
+        /*! \post No palette is loaded (GetNumberOfColors() is 0)
+         * \note NA*/
+        void ClearPackedPalette();
+
         //!Ensures that all tables are NULL or deleted.
         /*!Cleans out all the palettes in order to ensure all data is deleted
          * \pre NA
@@ -299,8 +671,18 @@ class ColorPalette
          * \note NA*/
         void ClearAllTables();
     
-        //Loaded formatted Palette Data
-        std::vector<colorValues> *formattedPaletteData;
+        //Number of loaded colors, 0 when no palette is loaded
+        int numberOfColors;
+    
+        //Loaded Palette Data packed as Red, Green, Blue bytes
+        uint8_t packedPaletteData[MAXIMUMNUMBEROFCOLORSPERPALETTE * 3];
+    
+        //The palette as 32bit RGBA/BGRA pixels (memory byte order)
+        uint32_t rgbaLookupTable[MAXIMUMNUMBEROFCOLORSPERPALETTE];
+        uint32_t bgraLookupTable[MAXIMUMNUMBEROFCOLORSPERPALETTE];
+    
+        //Palette colors changed since the tables were last updated
+        bool dirtyColors[MAXIMUMNUMBEROFCOLORSPERPALETTE];
     
         //The generated Transparent Color Table
         std::vector<uint8_t> *transparentColorsTable;
@@ -309,22 +691,47 @@ class ColorPalette
         std::vector<uint8_t> *greyscaleTable;
     
         //The generated Light Color Table (White)
-        std::vector<uint8_t> *lightTable;
+        sharedColorTable lightTable;
     
         //The generated Shadow Color Table (Black)
-        std::vector<uint8_t> *shadowTable;
+        sharedColorTable shadowTable;
     
         //The generated Red Color Table
-        std::vector<uint8_t> *redTable;
+        sharedColorTable redTable;
     
         //The generated Green Color Table
-        std::vector<uint8_t> *greenTable;
+        sharedColorTable greenTable;
     
         //The generated Blue Color Table
-        std::vector<uint8_t> *blueTable;
+        sharedColorTable blueTable;
+    
+        //Every colorized table generated for the loaded palette
+        std::map<colorizedTableParameters, sharedColorTable> colorizedTableCache;
+    
+        //How each colorized table was generated
+        colorizedTableParameters shadowTableParameters;
+        colorizedTableParameters lightTableParameters;
+        colorizedTableParameters redTableParameters;
+        colorizedTableParameters greenTableParameters;
+        colorizedTableParameters blueTableParameters;
+    
+        //Runtime counters
+        colorPaletteStatistics paletteStatistics;
+    
+        //Palettes are copied with Clone, an implicit copy would delete
+        //the same tables twice
+        ColorPalette(const ColorPalette &) = delete;
+        ColorPalette &operator=(const ColorPalette &) = delete;
 
     
 	private:
+        //!Gets a named table, generating it first if it is missing
+        /*! \returns The table, NULL when no palette is loaded
+         * \note GetColorTableRow checks the palette before the table is used*/
+        const std::vector<uint8_t> *GetNamedColorTable(namedColorTable tableType);
+    
+        //!Replaces every pixel of a buffer through one table row
+        void ApplyTableRow(const uint8_t *tableRow, uint8_t *pixelBuffer, size_t bufferSize);
 };
 
 #endif
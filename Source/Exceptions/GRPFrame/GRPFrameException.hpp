@@ -6,5 +6,8 @@
 class GRPFrameException : public GRPException {};
 class GRPFrameInvalidFrameDemensions : public GRPFrameException {};
 class GRPFrameInvalidImageDemensions : public GRPFrameException {};
+class GRPFrameNoCompressedData : public GRPFrameException {};
+class GRPFrameInvalidRowNumber : public GRPFrameException {};
+class GRPFrameNoCollisionMask : public GRPFrameException {};
 
 #endif
\ No newline at end of file
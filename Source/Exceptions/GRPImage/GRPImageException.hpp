@@ -8,5 +8,8 @@ class GRPImageInvalidFrameNumber : public GRPImageException {};
 class GRPImageNoLoadedPaletteSet : public GRPImageException {};
 class GRPImageNoFrameLoaded : public GRPImageException {};
 class GRPImageImageMagickNotCompiledIn : public GRPImageException {};
+class GRPImageInvalidRemapTable : public GRPImageException {};
+class GRPImageInvalidHeader : public GRPImageException {};
+class GRPImageInvalidFrameData : public GRPImageException {};
 
 #endif
\ No newline at end of file
@@ -0,0 +1 @@
+#include "GRPRendererException.hpp"
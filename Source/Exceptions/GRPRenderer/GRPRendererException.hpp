@@ -0,0 +1,11 @@
+#ifndef GRPRendererException_Header
+#define GRPRendererException_Header
+
+#include "../GRPException.hpp"
+class GRPRendererException : public GRPException {};
+
+class GRPRendererInvalidDrawCommand : public GRPRendererException {};
+class GRPRendererInvalidTarget : public GRPRendererException {};
+class GRPRendererInvalidTileSize : public GRPRendererException {};
+
+#endif
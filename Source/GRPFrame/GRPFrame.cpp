@@ -1,10 +1,246 @@
 #include "GRPFrame.hpp"
-GRPFrame::GRPFrame()
+#include <algorithm>
+//MSVC has no __SSE2__, x64 always has SSE2 and x86 reports it with /arch
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GRPFRAMESSE2
+#include <emmintrin.h>
+#endif
+
+//Walk the packets of one row clipped to rowWidth, handing every copy and
+//repeat packet to spanOutput.CopySpan(x, length, pixels) and
+//spanOutput.FillSpan(x, length, color)
+template<class SpanOutput>
+static void WalkRowSpans(const uint8_t *currentPacket, int rowWidth, SpanOutput &spanOutput)
+{
+    int currentColumn = 0;
+    while(currentColumn < rowWidth)
+    {
+        uint8_t rawPacket = *currentPacket++;
+        if(rawPacket & 0x80)
+        {
+            currentColumn += rawPacket & 0x7f;
+            continue;
+        }
+        int packetLength = rawPacket & 0x3f;
+        int spanLength = std::min(packetLength, rowWidth - currentColumn);
+        if(rawPacket & 0x40)
+        {
+            spanOutput.FillSpan(currentColumn, spanLength, *currentPacket++);
+        }
+        else
+        {
+            spanOutput.CopySpan(currentColumn, spanLength, currentPacket);
+            currentPacket += packetLength;
+        }
+        currentColumn += packetLength;
+    }
+}
+
+//Counts the spans of the rows so the span program is allocated once,
+//touching spans are merged the same way SpanWriter does (fill colors
+//after colorTable)
+struct SpanCounter
+{
+    const uint8_t *colorTable;
+    size_t copySpanCount;
+    size_t fillSpanCount;
+    size_t pixelCount;
+    int copyEnd;
+    int fillEnd;
+    uint8_t fillColor;
+    
+    void StartRow()
+    {
+        copyEnd = -1;
+        fillEnd = -1;
+    }
+    void CopySpan(int xPosition, int spanLength, const uint8_t *)
+    {
+        if(xPosition != copyEnd)
+        {
+            copySpanCount++;
+        }
+        copyEnd = xPosition + spanLength;
+        pixelCount += spanLength;
+    }
+    void FillSpan(int xPosition, int spanLength, uint8_t color)
+    {
+        if(colorTable != NULL)
+        {
+            color = colorTable[color];
+        }
+        if(xPosition != fillEnd || color != fillColor)
+        {
+            fillSpanCount++;
+        }
+        fillEnd = xPosition + spanLength;
+        fillColor = color;
+    }
+};
+
+//Writes the spans into the sized span program, colors go through colorTable
+struct SpanWriter
+{
+    grpCopySpan *copySpans;
+    grpFillSpan *fillSpans;
+    uint8_t *spanPixels;
+    const uint8_t *colorTable;
+    size_t copySpanCount;
+    size_t fillSpanCount;
+    size_t pixelCount;
+    int copyEnd;
+    int fillEnd;
+    
+    void StartRow()
+    {
+        copyEnd = -1;
+        fillEnd = -1;
+    }
+    void CopySpan(int xPosition, int spanLength, const uint8_t *packetPixels)
+    {
+        if(xPosition == copyEnd)
+        {
+            copySpans[copySpanCount - 1].spanLength += spanLength;
+        }
+        else
+        {
+            copySpans[copySpanCount].xPosition = xPosition;
+            copySpans[copySpanCount].spanLength = spanLength;
+            copySpanCount++;
+        }
+        copyEnd = xPosition + spanLength;
+        for(int currentPixel = 0; currentPixel < spanLength; currentPixel++)
+        {
+            spanPixels[pixelCount++] = (colorTable != NULL) ? colorTable[packetPixels[currentPixel]] : packetPixels[currentPixel];
+        }
+    }
+    void FillSpan(int xPosition, int spanLength, uint8_t color)
+    {
+        if(colorTable != NULL)
+        {
+            color = colorTable[color];
+        }
+        if(xPosition == fillEnd && color == fillSpans[fillSpanCount - 1].fillColor)
+        {
+            fillSpans[fillSpanCount - 1].spanLength += spanLength;
+        }
+        else
+        {
+            fillSpans[fillSpanCount].xPosition = xPosition;
+            fillSpans[fillSpanCount].spanLength = spanLength;
+            fillSpans[fillSpanCount].fillColor = color;
+            fillSpanCount++;
+        }
+        fillEnd = xPosition + spanLength;
+    }
+};
+//Sets the bits of the opaque spans in a collision mask row
+struct MaskWriter
+{
+    uint64_t *maskRow;
+    
+    void SetBits(int xPosition, int spanLength)
+    {
+        int spanEnd = xPosition + spanLength;
+        while(xPosition < spanEnd)
+        {
+            int wordEnd = std::min(spanEnd, (xPosition | 63) + 1);
+            int bitCount = wordEnd - xPosition;
+            uint64_t spanBits = (bitCount == 64) ? ~(uint64_t) 0 : (((uint64_t) 1 << bitCount) - 1);
+            maskRow[xPosition >> 6] |= spanBits << (xPosition & 63);
+            xPosition = wordEnd;
+        }
+    }
+    void CopySpan(int xPosition, int spanLength, const uint8_t *)
+    {
+        SetBits(xPosition, spanLength);
+    }
+    void FillSpan(int xPosition, int spanLength, uint8_t)
+    {
+        SetBits(xPosition, spanLength);
+    }
+};
+
+//Check the words firstWord to lastWord of thisRow against otherRow moved
+//right by xDistance pixels. Only otherRow words -1 to its last + 1 are read.
+static bool MaskRowsOverlap(const uint64_t *thisRow, const uint64_t *otherRow, int firstWord, int lastWord, int xDistance)
+{
+    int currentWord = firstWord;
+#if defined(GRPFRAMESSE2)
+    //Two words at a time, a shift by 64 gives 0 so the aligned case
+    //needs no branch
+    const __m128i zeroWords = _mm_setzero_si128();
+    for(; currentWord < lastWord; currentWord += 2)
+    {
+        int otherBit = (currentWord * 64) - xDistance + 64;
+        const uint64_t *otherWords = otherRow + (otherBit >> 6) - 1;
+        __m128i bitShift = _mm_cvtsi32_si128(otherBit & 63);
+        __m128i carryShift = _mm_cvtsi32_si128(64 - (otherBit & 63));
+        __m128i lowWords = _mm_loadu_si128((const __m128i *) otherWords);
+        __m128i highWords = _mm_loadu_si128((const __m128i *) (otherWords + 1));
+        __m128i shiftedWords = _mm_or_si128(_mm_srl_epi64(lowWords, bitShift), _mm_sll_epi64(highWords, carryShift));
+        __m128i sharedBits = _mm_and_si128(shiftedWords, _mm_loadu_si128((const __m128i *) (thisRow + currentWord)));
+        if(_mm_movemask_epi8(_mm_cmpeq_epi8(sharedBits, zeroWords)) != 0xFFFF)
+        {
+            return true;
+        }
+    }
+#endif
+    for(; currentWord <= lastWord; currentWord++)
+    {
+        //otherBit is kept positive so the word and shift are plain
+        int otherBit = (currentWord * 64) - xDistance + 64;
+        const uint64_t *otherWords = otherRow + (otherBit >> 6) - 1;
+        int bitShift = otherBit & 63;
+        uint64_t shiftedWord = otherWords[0] >> bitShift;
+        if(bitShift != 0)
+        {
+            shiftedWord |= otherWords[1] << (64 - bitShift);
+        }
+        if(thisRow[currentWord] & shiftedWord)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+GRPFrame::GRPFrame(MemoryArena *pixelArena) : frameData(ArenaAllocator<UniquePixel>(pixelArena)), rowOffsets(ArenaAllocator<uint16_t>(pixelArena)),
+                                                packetData(ArenaAllocator<uint8_t>(pixelArena)), packetColorTable(ArenaAllocator<uint8_t>(pixelArena)),
+                                                spanRows(ArenaAllocator<grpSpanRow>(pixelArena)), copySpans(ArenaAllocator<grpCopySpan>(pixelArena)),
+                                                fillSpans(ArenaAllocator<grpFillSpan>(pixelArena)), spanPixels(ArenaAllocator<uint8_t>(pixelArena)),
+                                                collisionMask(ArenaAllocator<uint64_t>(pixelArena))
 {
     xOffset = 0;
     yOffset = 0;
     width = 0;
     height = 0;
+    opaqueBounds.xPosition = 0;
+    opaqueBounds.yPosition = 0;
+    opaqueBounds.width = 0;
+    opaqueBounds.height = 0;
+    opaquePixelCount = 0;
+    collisionMaskWords = 0;
+}
+
+GRPFrame::GRPFrame(const GRPFrame &sourceFrame, MemoryArena *pixelArena) : frameData(sourceFrame.frameData.begin(), sourceFrame.frameData.end(), ArenaAllocator<UniquePixel>(pixelArena)),
+    rowOffsets(sourceFrame.rowOffsets.begin(), sourceFrame.rowOffsets.end(), ArenaAllocator<uint16_t>(pixelArena)),
+    packetData(sourceFrame.packetData.begin(), sourceFrame.packetData.end(), ArenaAllocator<uint8_t>(pixelArena)),
+    packetColorTable(sourceFrame.packetColorTable.begin(), sourceFrame.packetColorTable.end(), ArenaAllocator<uint8_t>(pixelArena)),
+    spanRows(sourceFrame.spanRows.begin(), sourceFrame.spanRows.end(), ArenaAllocator<grpSpanRow>(pixelArena)),
+    copySpans(sourceFrame.copySpans.begin(), sourceFrame.copySpans.end(), ArenaAllocator<grpCopySpan>(pixelArena)),
+    fillSpans(sourceFrame.fillSpans.begin(), sourceFrame.fillSpans.end(), ArenaAllocator<grpFillSpan>(pixelArena)),
+    spanPixels(sourceFrame.spanPixels.begin(), sourceFrame.spanPixels.end(), ArenaAllocator<uint8_t>(pixelArena)),
+    collisionMask(sourceFrame.collisionMask.begin(), sourceFrame.collisionMask.end(), ArenaAllocator<uint64_t>(pixelArena))
+{
+    xOffset = sourceFrame.xOffset;
+    yOffset = sourceFrame.yOffset;
+    width = sourceFrame.width;
+    height = sourceFrame.height;
+    dataOffset = sourceFrame.dataOffset;
+    opaqueBounds = sourceFrame.opaqueBounds;
+    opaquePixelCount = sourceFrame.opaquePixelCount;
+    collisionMaskWords = sourceFrame.collisionMaskWords;
 }
 
 void GRPFrame::SetImageSize(const uint8_t &inputFrameWidth, const uint8_t &inputFrameHeight)
@@ -48,4 +284,315 @@ void GRPFrame::SetDataOffset(const uint32_t &inputDataOffset)
 uint32_t GRPFrame::GetDataOffset()
 {
     return dataOffset;
-}
\ No newline at end of file
+}
+void GRPFrame::ApplyColorTable(const uint8_t *colorTable)
+{
+    for(framePixelVector::iterator currentPixel = frameData.begin(); currentPixel != frameData.end(); currentPixel++)
+    {
+        currentPixel->colorPaletteReference = colorTable[currentPixel->colorPaletteReference];
+    }
+    
+    //The span program holds its own copy of the colors
+    for(framePacketVector::iterator currentSpanPixel = spanPixels.begin(); currentSpanPixel != spanPixels.end(); currentSpanPixel++)
+    {
+        *currentSpanPixel = colorTable[*currentSpanPixel];
+    }
+    for(frameFillSpanVector::iterator currentFillSpan = fillSpans.begin(); currentFillSpan != fillSpans.end(); currentFillSpan++)
+    {
+        currentFillSpan->fillColor = colorTable[currentFillSpan->fillColor];
+    }
+    
+    //Chain the table onto the one used for the compressed data
+    if(!packetData.empty())
+    {
+        if(packetColorTable.empty())
+        {
+            packetColorTable.resize(256);
+            for(int currentColor = 0; currentColor < 256; currentColor++)
+            {
+                packetColorTable[currentColor] = currentColor;
+            }
+        }
+        for(int currentColor = 0; currentColor < 256; currentColor++)
+        {
+            packetColorTable[currentColor] = colorTable[packetColorTable[currentColor]];
+        }
+    }
+}
+
+void GRPFrame::SetCompressedData(const uint8_t *packetData, size_t packetDataSize, const uint16_t *rowOffsetTable)
+{
+    this->packetData.assign(packetData, packetData + packetDataSize);
+    rowOffsets.assign(rowOffsetTable, rowOffsetTable + height);
+    packetColorTable.clear();
+    spanRows.clear();
+    copySpans.clear();
+    fillSpans.clear();
+    spanPixels.clear();
+    collisionMask.clear();
+    collisionMaskWords = 0;
+}
+
+bool GRPFrame::HasCompressedData() const
+{
+    return !packetData.empty();
+}
+
+const frameRowOffsetVector &GRPFrame::GetRowOffsets() const
+{
+    return rowOffsets;
+}
+
+const framePacketVector &GRPFrame::GetPacketData() const
+{
+    return packetData;
+}
+
+void GRPFrame::DecodeRow(int rowNumber, std::vector<UniquePixel> *rowPixels) const
+{
+    if(rowNumber < 0 || rowNumber >= height)
+    {
+        GRPFrameInvalidRowNumber invalidRow;
+        invalidRow.SetErrorMessage("Invalid frame row requested");
+        throw invalidRow;
+    }
+    DecodeRectangle(0, rowNumber, width, 1, rowPixels);
+}
+
+void GRPFrame::DecodeRectangle(int rectangleX, int rectangleY, int rectangleWidth, int rectangleHeight, std::vector<UniquePixel> *rectanglePixels) const
+{
+    //A frame without rows has nothing to decode
+    if(packetData.empty() && height > 0)
+    {
+        GRPFrameNoCompressedData noCompressedData;
+        noCompressedData.SetErrorMessage("The frame does not hold its compressed data");
+        throw noCompressedData;
+    }
+    
+    //Clip the rectangle to the frame
+    int leftColumn = std::max(rectangleX, 0);
+    int rightColumn = std::min(rectangleX + rectangleWidth, (int) width);
+    int topRow = std::max(rectangleY, 0);
+    int bottomRow = std::min(rectangleY + rectangleHeight, (int) height);
+    const uint8_t *colorTable = packetColorTable.empty() ? NULL : &packetColorTable.front();
+    
+    UniquePixel currentUniquePixel;
+    for(int currentRow = topRow; currentRow < bottomRow; currentRow++)
+    {
+        currentUniquePixel.yPosition = currentRow;
+        const uint8_t *currentPacket = &packetData.front() + rowOffsets[currentRow];
+        int currentColumn = 0;
+        
+        //Packets left of the rectangle are only stepped over
+        while(currentColumn < rightColumn)
+        {
+            uint8_t rawPacket = *currentPacket++;
+            if(rawPacket & 0x80)
+            {
+                currentColumn += rawPacket & 0x7f;
+                continue;
+            }
+            
+            int packetLength = rawPacket & 0x3f;
+            int firstColumn = std::max(currentColumn, leftColumn);
+            int lastColumn = std::min(currentColumn + packetLength, rightColumn);
+            if(rawPacket & 0x40)
+            {
+                uint8_t repeatedColor = *currentPacket++;
+                if(colorTable != NULL)
+                {
+                    repeatedColor = colorTable[repeatedColor];
+                }
+                currentUniquePixel.colorPaletteReference = repeatedColor;
+                for(currentUniquePixel.xPosition = firstColumn; currentUniquePixel.xPosition < lastColumn; currentUniquePixel.xPosition++)
+                {
+                    rectanglePixels->push_back(currentUniquePixel);
+                }
+            }
+            else
+            {
+                for(currentUniquePixel.xPosition = firstColumn; currentUniquePixel.xPosition < lastColumn; currentUniquePixel.xPosition++)
+                {
+                    uint8_t copiedColor = currentPacket[currentUniquePixel.xPosition - currentColumn];
+                    currentUniquePixel.colorPaletteReference = (colorTable != NULL) ? colorTable[copiedColor] : copiedColor;
+                    rectanglePixels->push_back(currentUniquePixel);
+                }
+                currentPacket += packetLength;
+            }
+            currentColumn += packetLength;
+        }
+    }
+}
+
+void GRPFrame::BuildSpanProgram()
+{
+    if(packetData.empty())
+    {
+        GRPFrameNoCompressedData noCompressedData;
+        noCompressedData.SetErrorMessage("The frame does not hold its compressed data");
+        throw noCompressedData;
+    }
+    
+    //Count first so every part is allocated once at its final size
+    SpanCounter spanCounter = {};
+    spanCounter.colorTable = packetColorTable.empty() ? NULL : packetColorTable.data();
+    for(int currentRow = 0; currentRow < height; currentRow++)
+    {
+        spanCounter.StartRow();
+        WalkRowSpans(&packetData.front() + rowOffsets[currentRow], width, spanCounter);
+    }
+    spanRows.resize(height + 1);
+    copySpans.resize(spanCounter.copySpanCount);
+    fillSpans.resize(spanCounter.fillSpanCount);
+    spanPixels.resize(spanCounter.pixelCount);
+    
+    SpanWriter spanWriter = {};
+    spanWriter.copySpans = copySpans.data();
+    spanWriter.fillSpans = fillSpans.data();
+    spanWriter.spanPixels = spanPixels.data();
+    spanWriter.colorTable = packetColorTable.empty() ? NULL : packetColorTable.data();
+    for(int currentRow = 0; currentRow < height; currentRow++)
+    {
+        spanRows[currentRow].firstCopySpan = spanWriter.copySpanCount;
+        spanRows[currentRow].firstFillSpan = spanWriter.fillSpanCount;
+        spanRows[currentRow].firstPixel = spanWriter.pixelCount;
+        spanWriter.StartRow();
+        WalkRowSpans(&packetData.front() + rowOffsets[currentRow], width, spanWriter);
+    }
+    spanRows[height].firstCopySpan = spanWriter.copySpanCount;
+    spanRows[height].firstFillSpan = spanWriter.fillSpanCount;
+    spanRows[height].firstPixel = spanWriter.pixelCount;
+}
+
+bool GRPFrame::HasSpanProgram() const
+{
+    return !spanRows.empty();
+}
+
+const frameSpanRowVector &GRPFrame::GetSpanRows() const
+{
+    return spanRows;
+}
+
+const frameCopySpanVector &GRPFrame::GetCopySpans() const
+{
+    return copySpans;
+}
+
+const frameFillSpanVector &GRPFrame::GetFillSpans() const
+{
+    return fillSpans;
+}
+
+const framePacketVector &GRPFrame::GetSpanPixels() const
+{
+    return spanPixels;
+}
+
+void GRPFrame::BuildCollisionMask()
+{
+    if(packetData.empty())
+    {
+        GRPFrameNoCompressedData noCompressedData;
+        noCompressedData.SetErrorMessage("The frame does not hold its compressed data");
+        throw noCompressedData;
+    }
+    
+    collisionMaskWords = (width + 63) / 64;
+    int rowStride = collisionMaskWords + 2;
+    collisionMask.assign(rowStride * height, 0);
+    
+    MaskWriter maskWriter;
+    for(int currentRow = 0; currentRow < height; currentRow++)
+    {
+        maskWriter.maskRow = &collisionMask.front() + (currentRow * rowStride) + 1;
+        WalkRowSpans(&packetData.front() + rowOffsets[currentRow], width, maskWriter);
+    }
+}
+
+bool GRPFrame::HasCollisionMask() const
+{
+    return !collisionMask.empty();
+}
+
+int GRPFrame::GetCollisionMaskWords() const
+{
+    return collisionMaskWords;
+}
+
+size_t GRPFrame::GetCollisionMaskBytes() const
+{
+    return collisionMask.capacity() * sizeof(uint64_t);
+}
+
+const uint64_t *GRPFrame::GetCollisionMaskRow(int rowNumber) const
+{
+    if(collisionMask.empty())
+    {
+        GRPFrameNoCollisionMask noCollisionMask;
+        noCollisionMask.SetErrorMessage("The frame collision mask was not built");
+        throw noCollisionMask;
+    }
+    if(rowNumber < 0 || rowNumber >= height)
+    {
+        GRPFrameInvalidRowNumber invalidRow;
+        invalidRow.SetErrorMessage("Invalid frame row requested");
+        throw invalidRow;
+    }
+    return &collisionMask.front() + (rowNumber * (collisionMaskWords + 2)) + 1;
+}
+
+bool GRPFrame::CollidesWith(const GRPFrame &otherFrame, int xDistance, int yDistance) const
+{
+    if(collisionMask.empty() || otherFrame.collisionMask.empty())
+    {
+        GRPFrameNoCollisionMask noCollisionMask;
+        noCollisionMask.SetErrorMessage("The frame collision mask was not built");
+        throw noCollisionMask;
+    }
+    
+    //Only the rows and words where both opaque bounds meet are tested,
+    //in this frame's coordinates
+    const grpOpaqueBounds &otherBounds = otherFrame.opaqueBounds;
+    int overlapLeft = std::max(opaqueBounds.xPosition, otherBounds.xPosition + xDistance);
+    int overlapRight = std::min(opaqueBounds.xPosition + opaqueBounds.width, otherBounds.xPosition + otherBounds.width + xDistance);
+    int overlapTop = std::max(opaqueBounds.yPosition, otherBounds.yPosition + yDistance);
+    int overlapBottom = std::min(opaqueBounds.yPosition + opaqueBounds.height, otherBounds.yPosition + otherBounds.height + yDistance);
+    if(overlapLeft >= overlapRight || overlapTop >= overlapBottom)
+    {
+        return false;
+    }
+    
+    int firstWord = overlapLeft / 64;
+    int lastWord = (overlapRight - 1) / 64;
+    int thisStride = collisionMaskWords + 2;
+    int otherStride = otherFrame.collisionMaskWords + 2;
+    const uint64_t *thisRow = &collisionMask.front() + (overlapTop * thisStride) + 1;
+    const uint64_t *otherRow = &otherFrame.collisionMask.front() + ((overlapTop - yDistance) * otherStride) + 1;
+    for(int currentRow = overlapTop; currentRow < overlapBottom; currentRow++)
+    {
+        if(MaskRowsOverlap(thisRow, otherRow, firstWord, lastWord, xDistance))
+        {
+            return true;
+        }
+        thisRow += thisStride;
+        otherRow += otherStride;
+    }
+    return false;
+}
+
+void GRPFrame::SetOpaqueStatistics(const grpOpaqueBounds &inputOpaqueBounds, const uint32_t &inputOpaquePixelCount)
+{
+    opaqueBounds = inputOpaqueBounds;
+    opaquePixelCount = inputOpaquePixelCount;
+}
+
+grpOpaqueBounds GRPFrame::GetOpaqueBounds() const
+{
+    return opaqueBounds;
+}
+
+uint32_t GRPFrame::GetOpaquePixelCount() const
+{
+    return opaquePixelCount;
+}
@@ -11,8 +11,9 @@
  *  \copyright LGPLv2
  */
 
-#include <list>
+#include <vector>
 #include "../Exceptions/GRPFrame/GRPFrameException.hpp"
+#include "../MemoryArena/MemoryArena.hpp"
 
 //Allow Windows to use 8/16/32 byte values
 #if defined(_WIN32)
@@ -34,10 +35,72 @@ struct UniquePixel
     uint8_t colorPaletteReference;
 };
 
+//The decoded pixels of a frame, kept in the owning GRPImage's arena
+typedef std::vector<UniquePixel, ArenaAllocator<UniquePixel> > framePixelVector;
+
+//The GRP row offsets of a frame, kept in the owning GRPImage's arena
+typedef std::vector<uint16_t, ArenaAllocator<uint16_t> > frameRowOffsetVector;
+
+//Compressed frame data (or a color table), kept in the owning GRPImage's arena
+typedef std::vector<uint8_t, ArenaAllocator<uint8_t> > framePacketVector;
+
+//A run of pixels copied from GRPFrame::GetSpanPixels, the copy spans of a
+//row take their pixels one after the other from grpSpanRow::firstPixel
+struct grpCopySpan
+{
+    uint8_t xPosition;
+    uint8_t spanLength;
+};
+
+//A run of pixels all set to fillColor
+struct grpFillSpan
+{
+    uint8_t xPosition;
+    uint8_t spanLength;
+    uint8_t fillColor;
+};
+
+//Where the spans of a row start, they end where the next row's start
+//(a span program has one extra grpSpanRow closing the last row)
+struct grpSpanRow
+{
+    uint32_t firstCopySpan;
+    uint32_t firstFillSpan;
+    uint32_t firstPixel;
+};
+
+//The span program of a frame, kept in the owning GRPImage's arena
+typedef std::vector<grpSpanRow, ArenaAllocator<grpSpanRow> > frameSpanRowVector;
+typedef std::vector<grpCopySpan, ArenaAllocator<grpCopySpan> > frameCopySpanVector;
+typedef std::vector<grpFillSpan, ArenaAllocator<grpFillSpan> > frameFillSpanVector;
+
+//The 1 bit per pixel collision mask of a frame, kept in the owning
+//GRPImage's arena
+typedef std::vector<uint64_t, ArenaAllocator<uint64_t> > frameMaskVector;
+
+//The smallest rectangle holding every opaque pixel of a frame (or of all
+//the frames of an image), width and height are 0 when nothing is opaque
+struct grpOpaqueBounds
+{
+    int xPosition;
+    int yPosition;
+    int width;
+    int height;
+};
+
 class GRPFrame
 {
 public:
-    GRPFrame();
+    //!Create an empty frame
+    /*! \param[in] pixelArena The arena to keep frameData in (NULL uses the heap)
+     * \note NA*/
+    GRPFrame(MemoryArena *pixelArena = NULL);
+    
+    //!Copy a frame, keeping the copied frameData in another arena
+    /*! \param[in] sourceFrame The frame to copy
+     * \param[in] pixelArena The arena to keep the copied frameData in (NULL uses the heap)
+     * \note NA*/
+    GRPFrame(const GRPFrame &sourceFrame, MemoryArena *pixelArena);
     
     
     //!Sets the Image Size 
@@ -98,11 +161,146 @@ public:
      * \note NA*/
     uint32_t GetDataOffset();
     
-
+    //!Remap every pixel of the frame through a color table
+    /*!Replaces each pixel's colorPaletteReference with
+     * colorTable[colorPaletteReference], one linear pass over the frame.
+     * \pre colorTable must point to at least 256 entries
+     * \post The frame pixels reference the remapped palette indices
+     * \param[in] colorTable A 256 byte palette index lookup table
+     * \note Normally a row from one of the ColorPalette tables*/
+    void ApplyColorTable(const uint8_t *colorTable);
+    
+    //!Keep the compressed GRP data of the frame
+    /*!Stores the frame data as it is in the GRP (row offset table followed
+     * by the row packets) so single rows can be decoded later.
+     * \pre SetImageSize was called, packetData holds every row
+     * \param[in] packetData The frame data starting with the row offset table
+     * \param[in] packetDataSize The bytes up to the end of the last row
+     * \param[in] rowOffsetTable The parsed row offsets, one per row
+     * \note The data was checked when the frame was decoded, it is trusted here*/
+    void SetCompressedData(const uint8_t *packetData, size_t packetDataSize, const uint16_t *rowOffsetTable);
+    
+    //!Check if the frame holds its compressed GRP data
+    bool HasCompressedData() const;
+    
+    //!Get the parsed row offsets, empty without compressed data
+    const frameRowOffsetVector &GetRowOffsets() const;
+    
+    //!Get the compressed frame data, empty without compressed data
+    const framePacketVector &GetPacketData() const;
+    
+    //!Decode a single row from the compressed data
+    /*!Appends the opaque pixels of the row to rowPixels, left to right.
+     * \pre HasCompressedData
+     * \param[in] rowNumber The row (0 to GetImageHeight() - 1)
+     * \param[out] rowPixels Gets the row pixels appended
+     * \throws GRPFrameNoCompressedData
+     * \throws GRPFrameInvalidRowNumber
+     * \note NA*/
+    void DecodeRow(int rowNumber, std::vector<UniquePixel> *rowPixels) const;
+    
+    //!Decode the part of the frame inside a rectangle
+    /*!Appends the opaque pixels inside the rectangle to rectanglePixels
+     * row by row, only the packets reaching into the rectangle are expanded.
+     * \pre HasCompressedData
+     * \param[in] rectangleX The left column of the rectangle in the frame
+     * \param[in] rectangleY The top row of the rectangle in the frame
+     * \param[in] rectangleWidth The rectangle width
+     * \param[in] rectangleHeight The rectangle height
+     * \param[out] rectanglePixels Gets the pixels appended (frame coordinates)
+     * \throws GRPFrameNoCompressedData
+     * \note The rectangle is clipped to the frame*/
+    void DecodeRectangle(int rectangleX, int rectangleY, int rectangleWidth, int rectangleHeight, std::vector<UniquePixel> *rectanglePixels) const;
+    
+    //!Build the span program of the frame from its compressed data
+    /*!The span program lists the opaque runs of every row, the copy
+     * runs and the fill runs apart, so drawing a row is a memcpy per
+     * copy span and a memset per fill span with no packet parsing.
+     * Adjacent packets are merged and the spans are clipped to the frame.
+     * \pre HasCompressedData
+     * \post HasSpanProgram, ApplyColorTable keeps the spans up to date
+     * \throws GRPFrameNoCompressedData
+     * \note NA*/
+    void BuildSpanProgram();
+    
+    //!Check if the span program of the frame was built
+    bool HasSpanProgram() const;
+    
+    //!Get the span rows, GetImageHeight() + 1 entries with a span program
+    const frameSpanRowVector &GetSpanRows() const;
+    
+    //!Get the copy spans of every row
+    const frameCopySpanVector &GetCopySpans() const;
+    
+    //!Get the fill spans of every row
+    const frameFillSpanVector &GetFillSpans() const;
+    
+    //!Get the pixels of the copy spans of every row
+    const framePacketVector &GetSpanPixels() const;
+    
+    //!Build the collision mask of the frame from its compressed data
+    /*!The mask has one bit per pixel, set for the opaque ones. Each row is
+     * GetCollisionMaskWords() 64 bit words, pixel x is bit (x % 64) of
+     * word (x / 64).
+     * \pre HasCompressedData
+     * \post HasCollisionMask
+     * \throws GRPFrameNoCompressedData
+     * \note NA*/
+    void BuildCollisionMask();
+    
+    //!Check if the collision mask of the frame was built
+    bool HasCollisionMask() const;
+    
+    //!Get the number of 64 bit words in a collision mask row
+    int GetCollisionMaskWords() const;
+    
+    //!Get the bytes allocated for the collision mask
+    size_t GetCollisionMaskBytes() const;
+    
+    //!Get one row of the collision mask
+    /*! \pre HasCollisionMask
+     * \param[in] rowNumber The row (0 to GetImageHeight() - 1)
+     * \returns The GetCollisionMaskWords() words of the row, the words just
+     *      before and after them are readable and always 0
+     * \throws GRPFrameNoCollisionMask
+     * \throws GRPFrameInvalidRowNumber
+     * \note NA*/
+    const uint64_t *GetCollisionMaskRow(int rowNumber) const;
+    
+    //!Test if the opaque pixels of two frames overlap
+    /*!Pixel exact, the rows of the two masks where the opaque bounds meet
+     * are shifted against each other and ANDed a word (or with SSE2 two
+     * words) at a time.
+     * \pre Both frames have a collision mask and their opaque statistics
+     * \param[in] otherFrame The frame to test against (may be this frame)
+     * \param[in] xDistance Where otherFrame's left column is in this frame's columns
+     * \param[in] yDistance Where otherFrame's top row is in this frame's rows
+     * \returns If any pixel is opaque in both frames
+     * \throws GRPFrameNoCollisionMask
+     * \note The distances are between the frames, add the x/y offsets
+     *      when the frames are placed by their image boxes*/
+    bool CollidesWith(const GRPFrame &otherFrame, int xDistance, int yDistance) const;
+    
+    //!Set the opaque pixel statistics of the frame
+    /*!Normally set by the decoder, which gathers them while it walks the
+     * packets.
+     * \param[in] inputOpaqueBounds The tight bounds of the opaque pixels (frame coordinates)
+     * \param[in] inputOpaquePixelCount The number of opaque pixels
+     * \note NA*/
+    void SetOpaqueStatistics(const grpOpaqueBounds &inputOpaqueBounds, const uint32_t &inputOpaquePixelCount);
+    
+    //!Get the tight bounds of the opaque pixels
+    /*! \returns The bounds in frame coordinates (add the x/y offset for
+     *      the image box), empty for a fully transparent frame
+     * \note Pixels of packets running past the frame width are not counted*/
+    grpOpaqueBounds GetOpaqueBounds() const;
+    
+    //!Get the number of opaque pixels inside the frame
+    uint32_t GetOpaquePixelCount() const;
     
     //The unique pixel data, to be placed on to the final converted canvas
-    //or screen surface
-    std::list<UniquePixel> frameData;
+    //or screen surface (empty for frames loaded as COMPRESSEDFRAMES)
+    framePixelVector frameData;
 
 protected:
     
@@ -116,6 +314,33 @@ protected:
 
     //Offset of the Framedata (starting at the beginning of the GRPfile)
     uint32_t dataOffset;
+    
+    //The compressed frame data and its parsed row offsets (empty when
+    //not kept). rowOffsets index into packetData.
+    frameRowOffsetVector rowOffsets;
+    framePacketVector packetData;
+    
+    //Color table applied to the palette indices in packetData, empty
+    //until ApplyColorTable is used. The packets are left as they are in
+    //the GRP since rows may share packet data.
+    framePacketVector packetColorTable;
+    
+    //The opaque pixel statistics gathered by the decoder
+    grpOpaqueBounds opaqueBounds;
+    uint32_t opaquePixelCount;
+    
+    //The span program (empty until BuildSpanProgram), the span pixels and
+    //fill colors already have packetColorTable applied
+    frameSpanRowVector spanRows;
+    frameCopySpanVector copySpans;
+    frameFillSpanVector fillSpans;
+    framePacketVector spanPixels;
+    
+    //The collision mask (empty until BuildCollisionMask). Every row is
+    //stored as a 0 word, the collisionMaskWords mask words and another 0
+    //word, so shifted reads one word past either end need no checks.
+    frameMaskVector collisionMask;
+    int collisionMaskWords;
 private:
 };
 
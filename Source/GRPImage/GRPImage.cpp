@@ -1,16 +1,153 @@
 #include "GRPImage.hpp"
+#include "../GRPTrace/GRPTrace.hpp"
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <set>
+
+//Every live GRPImage, used for the process wide memory usage
+static std::mutex liveImagesMutex;
+static std::set<const GRPImage *> liveImages;
+
+static void RegisterLiveImage(const GRPImage *liveImage)
+{
+    std::lock_guard<std::mutex> liveImagesLock(liveImagesMutex);
+    liveImages.insert(liveImage);
+}
+
+static void ParseFrameHeaderEntry(const char *currentEntry, grpFrameHeader &frameHeader)
+{
+    frameHeader.xOffset = currentEntry[0];
+    frameHeader.yOffset = currentEntry[1];
+    frameHeader.width = currentEntry[2];
+    frameHeader.height = currentEntry[3];
+    std::copy(currentEntry + 4, currentEntry + 8, (char *) &frameHeader.dataOffset);
+}
+
+//Fill frameHeaders from the 8 byte entries of a GRP frame header table
+static void ParseFrameHeaders(const char *frameTable, grpImageHeader &imageHeader)
+{
+    imageHeader.frameHeaders.resize(imageHeader.numberOfFrames);
+    for(int currentFrame = 0; currentFrame < imageHeader.numberOfFrames; currentFrame++)
+    {
+        ParseFrameHeaderEntry(frameTable + (8 * currentFrame), imageHeader.frameHeaders[currentFrame]);
+    }
+}
+
+//Read the GRP header and frame table, checking the data holds all of it
+static void ParseImageHeader(const std::vector<char> *inputImage, grpImageHeader &imageHeader)
+{
+    uint16_t headerNumberOfFrames = 0;
+    if(inputImage->size() >= 2)
+    {
+        std::copy(inputImage->begin(), inputImage->begin() + 2, (char *) &headerNumberOfFrames);
+    }
+    if(inputImage->size() < 6 + (8 * (size_t) headerNumberOfFrames))
+    {
+        GRPImageInvalidHeader invalidHeader;
+        invalidHeader.SetErrorMessage("The GRP data is shorter than its frame header table");
+        throw invalidHeader;
+    }
+    imageHeader.numberOfFrames = headerNumberOfFrames;
+    std::copy(inputImage->begin() + 2, inputImage->begin() + 4, (char *) &imageHeader.maxImageWidth);
+    std::copy(inputImage->begin() + 4, inputImage->begin() + 6, (char *) &imageHeader.maxImageHeight);
+    ParseFrameHeaders(&inputImage->front() + 6, imageHeader);
+}
+
+//File order of the frame data, ties keep the frame header order
+static bool CompareFrameLayout(const grpFrameLayout &firstFrame, const grpFrameLayout &secondFrame)
+{
+    if(firstFrame.dataOffset != secondFrame.dataOffset)
+    {
+        return firstFrame.dataOffset < secondFrame.dataOffset;
+    }
+    return firstFrame.frameNumber < secondFrame.frameNumber;
+}
+
+//Frame row data that runs outside the frame data or never ends a row
+static void ThrowInvalidFrameData()
+{
+    GRPImageInvalidFrameData invalidFrameData;
+    invalidFrameData.SetErrorMessage("Invalid GRP frame row data");
+    throw invalidFrameData;
+}
+
+//Read up to maximumBytes from the source, less only at the end of the stream
+static size_t ReadStreamSource(const grpStreamSource &streamSource, char *destinationData, size_t maximumBytes)
+{
+    size_t bytesRead = 0;
+    while(bytesRead < maximumBytes)
+    {
+        size_t receivedBytes = streamSource(destinationData + bytesRead, maximumBytes - bytesRead);
+        if(receivedBytes == 0)
+        {
+            break;
+        }
+        bytesRead += receivedBytes;
+    }
+    return bytesRead;
+}
+
+//Read up to dataSize bytes from the current file position, less only at
+//the end of the file
+static size_t ReadFileData(std::ifstream &inputFile, char *destinationData, size_t dataSize)
+{
+    inputFile.read(destinationData, dataSize);
+    size_t bytesRead = inputFile.gcount();
+    inputFile.clear();
+    return bytesRead;
+}
+
+//Seconds passed since startTime, used by the statistics timers
+static double GetElapsedSeconds(std::chrono::steady_clock::time_point startTime)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+GRPImage::GRPImage()
+{
+    currentPalette = NULL;
+    frameStorage = EXPANDEDFRAMES;
+    buildSpanPrograms = false;
+    buildCollisionMasks = false;
+    numberOfFrames = 0;
+    maxImageWidth = 0;
+    maxImageHeight = 0;
+    ResetStatistics();
+    RegisterLiveImage(this);
+}
+
 GRPImage::GRPImage(std::vector<char> *inputImage, bool removeDuplicates)
 {
+    currentPalette = NULL;
+    frameStorage = EXPANDEDFRAMES;
+    buildSpanPrograms = false;
+    buildCollisionMasks = false;
+    ResetStatistics();
     LoadImage(inputImage, removeDuplicates);
+    
+    //Only registered once loaded, a throwing constructor runs no destructor
+    //to take the image out of liveImages again
+    RegisterLiveImage(this);
 }
 
 GRPImage::GRPImage(std::string filePath, bool removeDuplicates)
 {
+    currentPalette = NULL;
+    frameStorage = EXPANDEDFRAMES;
+    buildSpanPrograms = false;
+    buildCollisionMasks = false;
+    ResetStatistics();
     LoadImage(filePath, removeDuplicates);
+    RegisterLiveImage(this);
 }
 
 GRPImage::~GRPImage()
 {
+    {
+        std::lock_guard<std::mutex> liveImagesLock(liveImagesMutex);
+        liveImages.erase(this);
+    }
     CleanGRPImage();
     if(currentPalette != NULL)
     {
@@ -18,320 +155,561 @@ GRPImage::~GRPImage()
     }
 }
 
+GRPImage::GRPImage(GRPImage &&sourceImage)
+{
+    currentPalette = NULL;
+    frameStorage = EXPANDEDFRAMES;
+    buildSpanPrograms = false;
+    buildCollisionMasks = false;
+    numberOfFrames = 0;
+    maxImageWidth = 0;
+    maxImageHeight = 0;
+    ResetStatistics();
+    RegisterLiveImage(this);
+    *this = std::move(sourceImage);
+}
+
+GRPImage &GRPImage::operator=(GRPImage &&sourceImage)
+{
+    if(this != &sourceImage)
+    {
+        CleanGRPImage();
+        imageArena = std::move(sourceImage.imageArena);
+        imageFrames = std::move(sourceImage.imageFrames);
+        decodeScratch = std::move(sourceImage.decodeScratch);
+        frameLayout = std::move(sourceImage.frameLayout);
+        currentPalette = sourceImage.currentPalette;
+        frameStorage = sourceImage.frameStorage;
+        buildSpanPrograms = sourceImage.buildSpanPrograms;
+        buildCollisionMasks = sourceImage.buildCollisionMasks;
+        imageStatistics = sourceImage.imageStatistics;
+        numberOfFrames = sourceImage.numberOfFrames;
+        maxImageWidth = sourceImage.maxImageWidth;
+        maxImageHeight = sourceImage.maxImageHeight;
+        
+        //Leave the source as an empty image
+        sourceImage.imageFrames.clear();
+        sourceImage.decodeScratch.clear();
+        sourceImage.frameLayout.clear();
+        sourceImage.currentPalette = NULL;
+        sourceImage.ResetStatistics();
+        sourceImage.numberOfFrames = 0;
+        sourceImage.maxImageWidth = 0;
+        sourceImage.maxImageHeight = 0;
+    }
+    return *this;
+}
+
+GRPImage GRPImage::Clone() const
+{
+    GRPImage clonedImage;
+    clonedImage.imageArena.reset(new MemoryArena);
+    clonedImage.imageFrames.reserve(imageFrames.size());
+    for(std::vector<GRPFrame *>::const_iterator currentFrame = imageFrames.begin(); currentFrame != imageFrames.end(); currentFrame++)
+    {
+        clonedImage.imageFrames.push_back(clonedImage.AllocateFrame(**currentFrame));
+    }
+    clonedImage.frameLayout = frameLayout;
+    clonedImage.currentPalette = currentPalette;
+    clonedImage.frameStorage = frameStorage;
+    clonedImage.buildSpanPrograms = buildSpanPrograms;
+    clonedImage.buildCollisionMasks = buildCollisionMasks;
+    clonedImage.numberOfFrames = numberOfFrames;
+    clonedImage.maxImageWidth = maxImageWidth;
+    clonedImage.maxImageHeight = maxImageHeight;
+    return clonedImage;
+}
+
 void GRPImage::LoadImage(std::vector<char> *inputImage, bool removeDuplicates)
 {
+    GRPTRACESCOPE("GRPImage::LoadImage");
+    std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
     
-    CleanGRPImage();
-    std::vector<char>::iterator currentDataPosition = inputImage->begin();
+    //Everything is checked before the loaded image is touched
+    ParseImageHeader(inputImage, parsedHeader);
+    CheckFrameHeaders(0, inputImage->size());
     
-    //Get basic GRP header info
-    std::copy(currentDataPosition,(currentDataPosition + 2),(char *) &numberOfFrames);
-    currentDataPosition += 2;
+    //Frames are decoded in the order their data is stored so the GRP data
+    //is read front to back once
+    try
+    {
+        PrepareFrameSlots(inputImage->size(), removeDuplicates);
+        for(std::vector<grpFrameLayout>::iterator currentLayout = frameLayout.begin(); currentLayout != frameLayout.end(); currentLayout++)
+        {
+            DecodeLayoutFrame(*currentLayout, &inputImage->front() + currentLayout->dataOffset, inputImage->size() - currentLayout->dataOffset);
+        }
+    }
+    catch(...)
+    {
+        AbandonImageLoad();
+        throw;
+    }
     
-    //Get the maximum image width & height
-    std::copy(currentDataPosition, (currentDataPosition + 2),(char *) &maxImageWidth);
-    currentDataPosition += 2;
-
-    std::copy(currentDataPosition, (currentDataPosition + 2),(char *) &maxImageHeight);
-    currentDataPosition += 2;
+    FinishImageLoad(removeDuplicates, loadStart);
+}
 
-#if VERBOSE >= 2
-    std::cout << "GRP Image Number of Frames: " << numberOfFrames << " maxWidth: " << maxImageWidth << " maxHeight: " << maxImageHeight << '\n';
-#endif
+void GRPImage::LoadImageFrames(std::vector<char> *inputImage, const std::vector<int> &frameNumbers)
+{
+    GRPTRACESCOPE("GRPImage::LoadImageFrames");
+    std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
     
-    //Temporary image demension placeholders
-    uint8_t tempValue1, tempValue2;
-    uint32_t tempDataOffset;
+    //Only the requested frame header entries are read
+    if(inputImage->size() < 6)
+    {
+        GRPImageInvalidHeader invalidHeader;
+        invalidHeader.SetErrorMessage("The GRP data is shorter than its header");
+        throw invalidHeader;
+    }
+    uint16_t headerNumberOfFrames;
+    std::copy(inputImage->begin(), inputImage->begin() + 2, (char *) &headerNumberOfFrames);
+    CheckFrameNumbers(frameNumbers, headerNumberOfFrames, inputImage->size());
     
-    //Create a hash table to stop the creation of duplicates
-    std::unordered_map<uint32_t, bool> uniqueGRPImages;
-    std::unordered_map<uint32_t, bool>::const_iterator uniqueGRPCheck;
+    parsedHeader.numberOfFrames = frameNumbers.size();
+    std::copy(inputImage->begin() + 2, inputImage->begin() + 4, (char *) &parsedHeader.maxImageWidth);
+    std::copy(inputImage->begin() + 4, inputImage->begin() + 6, (char *) &parsedHeader.maxImageHeight);
+    parsedHeader.frameHeaders.resize(frameNumbers.size());
+    for(size_t currentFrame = 0; currentFrame < frameNumbers.size(); currentFrame++)
+    {
+        ParseFrameHeaderEntry(&inputImage->front() + 6 + (8 * frameNumbers[currentFrame]), parsedHeader.frameHeaders[currentFrame]);
+    }
+    CheckFrameHeaders(0, inputImage->size());
     
-    //Load each GRP Header into a GRPFrame & Allocate the
-    for(int currentGRPFrame = 0; currentGRPFrame < numberOfFrames; currentGRPFrame++)
+    try
     {
-        GRPFrame *currentImageFrame = new GRPFrame;
-        
-        //Read in the image xOffset
-        std::copy(currentDataPosition, (currentDataPosition + 1),(char *) &tempValue1);
-        currentDataPosition += 1;
-        //Read in the image yOffset
-        std::copy(currentDataPosition, (currentDataPosition + 1),(char *) &tempValue2);
-        currentDataPosition += 1;
-        currentImageFrame->SetImageOffsets(tempValue1, tempValue2);
-        
-        //Read in the image width
-        std::copy(currentDataPosition, (currentDataPosition + 1),(char *) &tempValue1);
-        currentDataPosition += 1;
-        //Read in the image height
-        std::copy(currentDataPosition, (currentDataPosition + 1),(char *) &tempValue2);
-        currentDataPosition += 1;
-        currentImageFrame->SetImageSize(tempValue1, tempValue2);
-        //Read in the image dataOffset
-        std::copy(currentDataPosition, (currentDataPosition + 4),(char *) &tempDataOffset);
-        currentDataPosition += 4;
-        currentImageFrame->SetDataOffset(tempDataOffset);
-        
-        
-#if VERBOSE >= 2
-        std::cout << "Current Frame: " << currentGRPFrame << " Width: " << (int) currentImageFrame->GetImageWidth() << " Height: "
-        << (int) currentImageFrame->GetImageHeight() << "\nxPosition: " << (int) currentImageFrame->GetXOffset()
-        << " yPosition: " << (int) currentImageFrame->GetYOffset() << " with offset " << (int)currentImageFrame->GetDataOffset() << '\n';
-#endif
-        uniqueGRPCheck = uniqueGRPImages.find(currentImageFrame->GetDataOffset());
-        if(removeDuplicates && (uniqueGRPCheck != uniqueGRPImages.end()))
+        PrepareFrameSlots(inputImage->size(), false);
+        for(std::vector<grpFrameLayout>::iterator currentLayout = frameLayout.begin(); currentLayout != frameLayout.end(); currentLayout++)
         {
-            
+            DecodeLayoutFrame(*currentLayout, &inputImage->front() + currentLayout->dataOffset, inputImage->size() - currentLayout->dataOffset);
         }
-        else
-        {
-            //The GRPImage is unique save in the unordered set
-            uniqueGRPImages.insert(std::make_pair<uint32_t,bool>(currentImageFrame->GetDataOffset(),true));
-            
-            //Decode Frame here
-            DecodeGRPFrameData(inputImage, currentImageFrame);
-            
-            //imageFrames.insert(imageFrames.end(), currentImageFrame);
-            imageFrames.push_back(currentImageFrame);
-        }
-        
     }
-    
-    if (removeDuplicates)
+    catch(...)
     {
-        numberOfFrames = imageFrames.size();
+        AbandonImageLoad();
+        throw;
     }
     
+    FinishImageLoad(false, loadStart);
 }
 
-void GRPImage::LoadImage(std::string filePath, bool removeDuplicates)
+void GRPImage::LoadImageFrames(std::string filePath, const std::vector<int> &frameNumbers)
 {
-    CleanGRPImage();
+    GRPTRACESCOPE("GRPImage::LoadImageFrames");
+    std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
     std::ifstream inputFile(filePath.c_str(), std::ios::binary);
-    inputFile.exceptions(std::ifstream::badbit | std::ifstream::failbit | std::ifstream::eofbit);
+    //Short reads are checked as the data is used
+    if(!inputFile.is_open())
+    {
+        throw std::ios_base::failure("Unable to open " + filePath);
+    }
     
-    //Read in some basic data about the grp.
-    inputFile.read((char *) &numberOfFrames, 2);
+    inputFile.seekg(0, std::ios::end);
+    uint64_t fileSize = inputFile.tellg();
+    inputFile.seekg(0, std::ios::beg);
     
-    //Find the Maximum Image Width & Height
-    inputFile.read((char *) &maxImageWidth, 2);
-    inputFile.read((char *) &maxImageHeight, 2);
-#if VERBOSE >= 2
-    std::cout << "GRP Image Number of Frames: " << numberOfFrames << " maxWidth: " << maxImageWidth << " maxHeight: " << maxImageHeight << '\n';
-#endif
+    char headerData[6];
+    uint16_t headerNumberOfFrames = 0;
+    size_t headerBytes = ReadFileData(inputFile, headerData, 6);
+    imageStatistics.fileBytesRead += headerBytes;
+    if(headerBytes == 6)
+    {
+        std::copy(headerData, headerData + 2, (char *) &headerNumberOfFrames);
+    }
+    CheckFrameNumbers(frameNumbers, headerNumberOfFrames, fileSize);
     
-    //Temporary image demension placeholders
-    uint8_t tempValue1, tempValue2;
-    uint32_t tempDataOffset;
+    //The whole frame header table is read at once, the data offsets of
+    //the frames that are not loaded still bound the data of the others
+    std::vector<char> frameTable(8 * headerNumberOfFrames);
+    if(!frameTable.empty())
+    {
+        size_t tableBytes = ReadFileData(inputFile, &frameTable.front(), frameTable.size());
+        imageStatistics.fileBytesRead += tableBytes;
+        if(tableBytes != frameTable.size())
+        {
+            GRPImageInvalidHeader invalidHeader;
+            invalidHeader.SetErrorMessage("The GRP file is shorter than its frame header table");
+            throw invalidHeader;
+        }
+    }
+    std::vector<uint32_t> fileDataOffsets(headerNumberOfFrames);
+    for(int currentFrame = 0; currentFrame < headerNumberOfFrames; currentFrame++)
+    {
+        grpFrameHeader frameHeader;
+        ParseFrameHeaderEntry(&frameTable.front() + (8 * currentFrame), frameHeader);
+        fileDataOffsets[currentFrame] = frameHeader.dataOffset;
+    }
+    std::sort(fileDataOffsets.begin(), fileDataOffsets.end());
     
-    //Create a hash table to stop the creation of duplicates
-    std::unordered_map<uint32_t, bool> uniqueGRPImages;
-    std::unordered_map<uint32_t, bool>::const_iterator uniqueGRPCheck;
+    parsedHeader.numberOfFrames = frameNumbers.size();
+    std::copy(headerData + 2, headerData + 4, (char *) &parsedHeader.maxImageWidth);
+    std::copy(headerData + 4, headerData + 6, (char *) &parsedHeader.maxImageHeight);
+    parsedHeader.frameHeaders.resize(frameNumbers.size());
+    for(size_t currentFrame = 0; currentFrame < frameNumbers.size(); currentFrame++)
+    {
+        ParseFrameHeaderEntry(&frameTable.front() + (8 * frameNumbers[currentFrame]), parsedHeader.frameHeaders[currentFrame]);
+    }
+    CheckFrameHeaders(0, fileSize);
     
-    //Load each GRP Header into a GRPFrame & Allocate the
-    for(int currentGRPFrame = 0; currentGRPFrame < numberOfFrames; currentGRPFrame++)
+    //Each frame's data is read once in file order. A frame's data runs up
+    //to the next frame data in the file (or the end of the file), like in
+    //the stream loader, rows running past the frame width are allowed.
+    try
     {
-        GRPFrame *currentImageFrame = new GRPFrame;
-        
-        //Read in the image xOffset
-        inputFile.read((char *) &tempValue1, 1);
-        //Read in the image yOffset
-        inputFile.read((char *) &tempValue2, 1);
-        currentImageFrame->SetImageOffsets(tempValue1, tempValue2);
-        
-        //Read in the image width
-        inputFile.read((char *) &tempValue1, 1);
-        //Read in the image height
-        inputFile.read((char *) &tempValue2, 1);
-        currentImageFrame->SetImageSize(tempValue1, tempValue2);
-        //Read in the image dataOffset
-        inputFile.read((char *) &tempDataOffset, 4);
-        currentImageFrame->SetDataOffset(tempDataOffset);
-
-
-#if VERBOSE >= 2
-        std::cout << "Current Frame: " << currentGRPFrame << " Width: " << (int) currentImageFrame->GetImageWidth() << " Height: "
-        << (int) currentImageFrame->GetImageHeight() << "\nxPosition: " << (int) currentImageFrame->GetXOffset()
-        << " yPosition: " << (int) currentImageFrame->GetYOffset() << " with offset " << (int)currentImageFrame->GetDataOffset() << '\n';
-#endif
-        uniqueGRPCheck = uniqueGRPImages.find(currentImageFrame->GetDataOffset());
-        if(removeDuplicates && (uniqueGRPCheck != uniqueGRPImages.end()))
+        PrepareFrameSlots(fileSize, false);
+        for(std::vector<grpFrameLayout>::iterator currentLayout = frameLayout.begin(); currentLayout != frameLayout.end(); currentLayout++)
         {
-            
+            std::vector<uint32_t>::iterator nextDataOffset = std::upper_bound(fileDataOffsets.begin(), fileDataOffsets.end(), currentLayout->dataOffset);
+            if(nextDataOffset != fileDataOffsets.end())
+            {
+                currentLayout->dataEnd = std::min(currentLayout->dataEnd, *nextDataOffset);
+            }
         }
-        else
+        
+        uint32_t bufferedDataOffset = 0;
+        fileBuffer.clear();
+        for(std::vector<grpFrameLayout>::iterator currentLayout = frameLayout.begin(); currentLayout != frameLayout.end(); currentLayout++)
         {
-            //The GRPImage is unique save in the unordered set
-            uniqueGRPImages.insert(std::make_pair<uint32_t,bool>(currentImageFrame->GetDataOffset(),true));
-            
-            //Decode Frame here
-            DecodeGRPFrameData(inputFile, currentImageFrame);
-            
-            //imageFrames.insert(imageFrames.end(), currentImageFrame);
-            imageFrames.push_back(currentImageFrame);
+            if(fileBuffer.empty() || currentLayout->dataOffset != bufferedDataOffset)
+            {
+                fileBuffer.resize(currentLayout->dataEnd - currentLayout->dataOffset);
+                if(!fileBuffer.empty())
+                {
+                    inputFile.seekg(currentLayout->dataOffset);
+                    fileBuffer.resize(ReadFileData(inputFile, &fileBuffer.front(), fileBuffer.size()));
+                    imageStatistics.fileBytesRead += fileBuffer.size();
+                }
+                bufferedDataOffset = currentLayout->dataOffset;
+            }
+            if(fileBuffer.empty())
+            {
+                ThrowInvalidFrameData();
+            }
+            DecodeLayoutFrame(*currentLayout, &fileBuffer.front(), fileBuffer.size());
         }
-        
     }
-    
-    if (removeDuplicates)
+    catch(...)
     {
-        numberOfFrames = imageFrames.size();
+        AbandonImageLoad();
+        throw;
     }
     
+    FinishImageLoad(false, loadStart);
 }
 
-void GRPImage::DecodeGRPFrameData(std::ifstream &inputFile, GRPFrame *targetFrame)
+void GRPImage::LoadImageFrames(std::vector<char> *inputImage, int startingFrame, int endingFrame)
 {
-    if(targetFrame == NULL || (targetFrame->frameData.size() == 0))
+    std::vector<int> frameNumbers;
+    for(int currentFrame = startingFrame; currentFrame < endingFrame; currentFrame++)
     {
-        GRPImageNoFrameLoaded noFrameLoaded;
-        noFrameLoaded.SetErrorMessage("No GRP Frame is loaded");
+        frameNumbers.push_back(currentFrame);
     }
-    if(currentPalette == NULL)
+    LoadImageFrames(inputImage, frameNumbers);
+}
+
+void GRPImage::LoadImageFrames(std::string filePath, int startingFrame, int endingFrame)
+{
+    std::vector<int> frameNumbers;
+    for(int currentFrame = startingFrame; currentFrame < endingFrame; currentFrame++)
     {
-        GRPImageNoLoadedPaletteSet noPaletteLoaded;
-        noPaletteLoaded.SetErrorMessage("No palette has been set or loaded");
+        frameNumbers.push_back(currentFrame);
     }
-    
-    //Save the original file pointer position to continue loading GRPHeaders
-    std::ifstream::pos_type currentHeaderFilePosition = inputFile.tellg();
-    
-    //Seek to the Row offset data
-    inputFile.seekg(targetFrame->GetDataOffset());
-    
-    //Create a vector of all the Image row offsets
-    std::vector<uint16_t> imageRowOffsets;
-    imageRowOffsets.resize(targetFrame->GetImageHeight());
-    
-    //Read in the ImageRow offsets
-    for (int currentReadingRowOffset = 0; currentReadingRowOffset < targetFrame->GetImageHeight(); currentReadingRowOffset++)
+    LoadImageFrames(filePath, frameNumbers);
+}
+
+void GRPImage::LoadImage(std::istream &inputStream, bool removeDuplicates, const grpFrameDecodedCallback &frameDecoded)
+{
+    grpStreamSource streamSource = [&inputStream](char *destinationData, size_t maximumBytes) -> size_t
     {
-        inputFile.read((char *) &imageRowOffsets.at(currentReadingRowOffset), 2);
-    }
-    
-    //The currentRow (x coordinate) that the decoder is at, it is used to
-    //set the image position.
-    int currentProcessingRow = 0;
+        inputStream.read(destinationData, maximumBytes);
+        return inputStream.gcount();
+    };
+    LoadImage(streamSource, removeDuplicates, frameDecoded);
+}
 
-    //The initial byte of data from the GRPFile
-    //It is often the operation that will be done
-    //of the proceding data
-    uint8_t rawPacket;
-    
-    //The references to a particular color
-    uint8_t convertedPacket;
+void GRPImage::LoadImage(const grpStreamSource &streamSource, bool removeDuplicates, const grpFrameDecodedCallback &frameDecoded)
+{
+    GRPTRACESCOPE("GRPImage::LoadImage");
+    std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
     
-    //The struct keeps a (X,Y) coordinates to the position
-    //of the referenced color to allow for drawing on the screen
-    //or Imagemagick to convert.
-    UniquePixel currentUniquePixel;
+    //The header and frame table come first, the frame data can then only
+    //lie after them
+    fileBuffer.resize(6);
+    size_t bytesBuffered = ReadStreamSource(streamSource, &fileBuffer.front(), 6);
+    uint16_t headerNumberOfFrames = 0;
+    if(bytesBuffered == 6)
+    {
+        std::copy(fileBuffer.begin(), fileBuffer.begin() + 2, (char *) &headerNumberOfFrames);
+        fileBuffer.resize(6 + (8 * (size_t) headerNumberOfFrames));
+        bytesBuffered += ReadStreamSource(streamSource, &fileBuffer.front() + 6, fileBuffer.size() - 6);
+    }
+    fileBuffer.resize(bytesBuffered);
+    ParseImageHeader(&fileBuffer, parsedHeader);
+    uint64_t streamPosition = fileBuffer.size();
+    CheckFrameHeaders(streamPosition, std::numeric_limits<uint64_t>::max());
     
-
-    //Goto each row and process the row data
-    for(int currentProcessingHeight = 0; currentProcessingHeight < targetFrame->GetImageHeight(); currentProcessingHeight++)
+    try
     {
+        PrepareFrameSlots(std::numeric_limits<uint32_t>::max(), removeDuplicates);
         
-#if VERBOSE >= 2
-        std::cout << "Current row offset is: " << (targetFrame->GetDataOffset() + (imageRowOffsets.at(currentProcessingHeight))) << '\n';
-#endif
-        //Seek to the point of the first byte in the rowData from the
-        //1.Skip over to the Frame data
-        //2.Skip over by the Row offset mentioned in the list
-        inputFile.seekg((targetFrame->GetDataOffset() + (imageRowOffsets.at(currentProcessingHeight))));
-
-        currentProcessingRow = 0;
-        
-        while(currentProcessingRow < targetFrame->GetImageWidth())
+        //Only the data of one frame is buffered at a time, each frame is done
+        //as soon as the data up to the next frame has arrived
+        uint32_t bufferedDataOffset = 0;
+        fileBuffer.clear();
+        for(std::vector<grpFrameLayout>::iterator currentLayout = frameLayout.begin(); currentLayout != frameLayout.end(); currentLayout++)
         {
-            inputFile.read((char *) &rawPacket, 1);
-            if(!(rawPacket & 0x80))
+            int framePosition = framePositions[currentLayout->frameNumber];
+            if(framePosition == -1)
             {
-                //Repeat Operation (The first byte indicates a repeat pixel operation)
-                //The next byte indicates how far down the row to repeat.
-                if(rawPacket & 0x40)
+                continue;
+            }
+            
+            //Frames kept as duplicates reuse the buffered data
+            if(fileBuffer.empty() || currentLayout->dataOffset != bufferedDataOffset)
+            {
+                fileBuffer.resize(STREAMREADSIZE);
+                while(streamPosition < currentLayout->dataOffset)
                 {
-                    rawPacket &= 0x3f;
-                    inputFile.read((char *) &convertedPacket, 1);
-                    
-                    //Set the Player color (Not implemented yet :|
-                    //covertedPacket = tableof unitColor[ colorbyte+gr_gamenr];
-                    int operationCounter = rawPacket;
-                    currentUniquePixel.xPosition = currentProcessingRow;
-                     do{
-                        
-                        currentUniquePixel.yPosition = currentProcessingHeight;
-                        currentUniquePixel.colorPaletteReference = convertedPacket;
-                        targetFrame->frameData.push_back(currentUniquePixel);
-                        currentUniquePixel.xPosition++;
-                     }while (--operationCounter);
-
-                    currentProcessingRow += rawPacket;
+                    size_t skipBytes = std::min<uint64_t>(currentLayout->dataOffset - streamPosition, fileBuffer.size());
+                    size_t skippedBytes = ReadStreamSource(streamSource, &fileBuffer.front(), skipBytes);
+                    streamPosition += skippedBytes;
+                    if(skippedBytes != skipBytes)
+                    {
+                        ThrowInvalidFrameData();
+                    }
                 }
-                else
+                
+                //The last frame runs to the end of the stream
+                bytesBuffered = 0;
+                while(streamPosition < currentLayout->dataEnd)
                 {
-                    //Copy Pixel Operation, and how many pixels to copy directly
-                    int operationCounter = rawPacket;
-                    do
+                    size_t readBytes = std::min<uint64_t>(currentLayout->dataEnd - streamPosition, STREAMREADSIZE);
+                    if(fileBuffer.size() < bytesBuffered + readBytes)
                     {
-                        inputFile.read((char *)&convertedPacket, 1);
-                        
-                        currentUniquePixel.xPosition = currentProcessingRow;
-                        currentUniquePixel.yPosition = currentProcessingHeight;
-                        currentUniquePixel.colorPaletteReference = convertedPacket;
-                        targetFrame->frameData.push_back(currentUniquePixel);
-                        currentProcessingRow++;
-                    } while (--operationCounter);
+                        fileBuffer.resize(bytesBuffered + readBytes);
+                    }
+                    size_t receivedBytes = ReadStreamSource(streamSource, &fileBuffer.front() + bytesBuffered, readBytes);
+                    bytesBuffered += receivedBytes;
+                    streamPosition += receivedBytes;
+                    if(receivedBytes != readBytes)
+                    {
+                        break;
+                    }
                 }
+                fileBuffer.resize(bytesBuffered);
+                bufferedDataOffset = currentLayout->dataOffset;
             }
-            else
+            if(fileBuffer.empty())
             {
-                //Skip the next "rawPacket" # of pixels
-                rawPacket &= 0x7f;
-                currentProcessingRow += rawPacket;
+                ThrowInvalidFrameData();
+            }
+            
+            GRPFrame *decodedFrame = DecodeLayoutFrame(*currentLayout, &fileBuffer.front(), fileBuffer.size());
+            if(frameDecoded)
+            {
+                frameDecoded(framePosition, decodedFrame);
             }
         }
     }
+    catch(...)
+    {
+        AbandonImageLoad();
+        throw;
+    }
     
-    
-    //Finished put the file position back
-        inputFile.seekg(currentHeaderFilePosition);
-#if VERBOSE >= 5
-    std::cout << "Frame data is size: " << targetFrame->frameData.size() << '\n';
-    for(std::list<UniquePixel>::iterator it = targetFrame->frameData.begin(); it != targetFrame->frameData.end(); it++)
+    FinishImageLoad(removeDuplicates, loadStart);
+}
+
+void GRPImage::CheckFrameNumbers(const std::vector<int> &frameNumbers, uint16_t headerNumberOfFrames, uint64_t dataSize)
+{
+    if(frameNumbers.size() > std::numeric_limits<uint16_t>::max())
     {
-        std::cout << '(' << it->xPosition << ',' << it->yPosition << ") = " << (int) it->colorPaletteReference << '\n';
+        GRPImageInvalidFrameNumber invalidFrame;
+        invalidFrame.SetErrorMessage("Too many frames requested");
+        throw invalidFrame;
+    }
+    for(std::vector<int>::const_iterator currentFrame = frameNumbers.begin(); currentFrame != frameNumbers.end(); currentFrame++)
+    {
+        if(*currentFrame < 0 || *currentFrame >= headerNumberOfFrames)
+        {
+            GRPImageInvalidFrameNumber invalidFrame;
+            invalidFrame.SetErrorMessage("Invalid frame number requested");
+            throw invalidFrame;
+        }
+    }
+    if(dataSize < 6 + (8 * (uint64_t) headerNumberOfFrames))
+    {
+        GRPImageInvalidHeader invalidHeader;
+        invalidHeader.SetErrorMessage("The GRP data is shorter than its frame header table");
+        throw invalidHeader;
+    }
+}
+
+void GRPImage::CheckFrameHeaders(uint64_t firstDataOffset, uint64_t dataSize)
+{
+    for(std::vector<grpFrameHeader>::iterator currentHeader = parsedHeader.frameHeaders.begin(); currentHeader != parsedHeader.frameHeaders.end(); currentHeader++)
+    {
+        if(currentHeader->width == 0 || currentHeader->height == 0)
+        {
+            GRPFrameInvalidFrameDemensions badDemensions;
+            badDemensions.SetErrorMessage("Invalid Frame width");
+            throw badDemensions;
+        }
+        if(currentHeader->dataOffset < firstDataOffset || (uint64_t) currentHeader->dataOffset + (2 * currentHeader->height) > dataSize)
+        {
+            GRPImageInvalidHeader invalidHeader;
+            invalidHeader.SetErrorMessage("GRP frame data starts outside of the GRP data");
+            throw invalidHeader;
+        }
     }
+}
+
+void GRPImage::PrepareFrameSlots(size_t dataSize, bool removeDuplicates)
+{
+    ReuseImageBuffers();
+    numberOfFrames = parsedHeader.numberOfFrames;
+    maxImageWidth = parsedHeader.maxImageWidth;
+    maxImageHeight = parsedHeader.maxImageHeight;
+
+#if VERBOSE >= 2
+    std::cout << "GRP Image Number of Frames: " << numberOfFrames << " maxWidth: " << maxImageWidth << " maxHeight: " << maxImageHeight << '\n';
 #endif
+    
+    ComputeFrameLayout(parsedHeader, dataSize, &frameLayout);
+    
+    //Where each frame header ends up in imageFrames, -1 for duplicates
+    framePositions.assign(numberOfFrames, 0);
+    if(removeDuplicates)
+    {
+        for(std::vector<grpFrameLayout>::iterator currentLayout = frameLayout.begin(); currentLayout != frameLayout.end(); currentLayout++)
+        {
+            if(currentLayout->sharedWithFrame != currentLayout->frameNumber)
+            {
+                framePositions[currentLayout->frameNumber] = -1;
+                imageStatistics.duplicateFrames++;
+            }
+        }
+    }
+    int uniqueFrames = 0;
+    for(int currentGRPFrame = 0; currentGRPFrame < numberOfFrames; currentGRPFrame++)
+    {
+        if(framePositions[currentGRPFrame] != -1)
+        {
+            framePositions[currentGRPFrame] = uniqueFrames++;
+        }
+    }
+    imageFrames.assign(uniqueFrames, NULL);
 }
 
-void GRPImage::DecodeGRPFrameData(std::vector<char> *inputData, GRPFrame *targetFrame)
-{   if(targetFrame == NULL || (targetFrame->frameData.size() == 0))
+GRPFrame *GRPImage::DecodeLayoutFrame(const grpFrameLayout &frameLayoutEntry, const char *frameData, size_t frameDataSize)
 {
-    GRPImageNoFrameLoaded noFrameLoaded;
-    noFrameLoaded.SetErrorMessage("No GRP Frame is loaded");
+    int framePosition = framePositions[frameLayoutEntry.frameNumber];
+    if(framePosition == -1)
+    {
+        return NULL;
+    }
+    
+    const grpFrameHeader &currentHeader = parsedHeader.frameHeaders[frameLayoutEntry.frameNumber];
+    GRPFrame frameHeader;
+    frameHeader.SetImageOffsets(currentHeader.xOffset, currentHeader.yOffset);
+    frameHeader.SetImageSize(currentHeader.width, currentHeader.height);
+    frameHeader.SetDataOffset(currentHeader.dataOffset);
+    
+#if VERBOSE >= 2
+    std::cout << "Current Frame: " << frameLayoutEntry.frameNumber << " Width: " << (int) frameHeader.GetImageWidth() << " Height: "
+    << (int) frameHeader.GetImageHeight() << "\nxPosition: " << (int) frameHeader.GetXOffset()
+    << " yPosition: " << (int) frameHeader.GetYOffset() << " with offset " << (int) frameHeader.GetDataOffset() << '\n';
+#endif
+    //Only unique frames are copied into the image arena
+    GRPFrame *currentImageFrame = AllocateFrame(frameHeader);
+    imageFrames[framePosition] = currentImageFrame;
+    
+    //Decode Frame here
+    std::chrono::steady_clock::time_point decodeStart = std::chrono::steady_clock::now();
+    DecodeGRPFrameData(frameData, frameDataSize, currentImageFrame);
+    imageStatistics.decodeSeconds += GetElapsedSeconds(decodeStart);
+    imageStatistics.framesDecoded++;
+    imageStatistics.pixelsEmitted += currentImageFrame->frameData.size();
+    return currentImageFrame;
 }
-    if(currentPalette == NULL)
+
+void GRPImage::FinishImageLoad(bool removeDuplicates, std::chrono::steady_clock::time_point loadStart)
+{
+    if (removeDuplicates)
     {
-        GRPImageNoLoadedPaletteSet noPaletteLoaded;
-        noPaletteLoaded.SetErrorMessage("No palette has been set or loaded");
+        numberOfFrames = imageFrames.size();
     }
     
+    //The GRP header and every frame header
+    imageStatistics.bytesRead += 6 + (8 * parsedHeader.numberOfFrames);
+    imageStatistics.imagesLoaded++;
+    imageStatistics.loadSeconds += GetElapsedSeconds(loadStart);
+}
+
+void GRPImage::LoadImage(std::string filePath, bool removeDuplicates)
+{
+    GRPTRACESCOPE("GRPImage::LoadImage");
+    std::chrono::steady_clock::time_point readStart = std::chrono::steady_clock::now();
     
-    //Seek to the Row offset data
-    std::vector<char>::iterator currentDataPosition = inputData->begin();
-    currentDataPosition += targetFrame->GetDataOffset();
+    //One sequential read, the frames are then decoded from memory
+    LoadFileToVector(filePath, &fileBuffer);
+    imageStatistics.fileBytesRead += fileBuffer.size();
+    double readSeconds = GetElapsedSeconds(readStart);
     
-    //Create a vector of all the Image row offsets
-    std::vector<uint16_t> imageRowOffsets;
-    imageRowOffsets.resize(targetFrame->GetImageHeight());
+    LoadImage(&fileBuffer, removeDuplicates);
+    imageStatistics.loadSeconds += readSeconds;
+}
+
+void GRPImage::LoadFileToVector(std::string sourceFilePath, std::vector<char> *destinationVector)
+{
+    GRPTRACESCOPE("GRPImage::LoadFileToVector");
+    std::ifstream inputFile(sourceFilePath.c_str(), std::ios::binary);
+    inputFile.exceptions(std::ifstream::badbit | std::ifstream::failbit | std::ifstream::eofbit);
     
-    //Read in the ImageRow offsets
-    for (int currentReadingRowOffset = 0; currentReadingRowOffset < targetFrame->GetImageHeight(); currentReadingRowOffset++)
+    inputFile.seekg(0, std::ios::end);
+    std::streampos fileLength(inputFile.tellg());
+    inputFile.seekg(0, std::ios::beg);
+    
+    //resize keeps the capacity of the previous file
+    destinationVector->resize(static_cast<size_t>(fileLength));
+    if(fileLength > 0)
+    {
+        inputFile.read(&destinationVector->front(), static_cast<size_t>(fileLength));
+    }
+}
+
+void GRPImage::DecodeGRPFrameData(const char *frameData, size_t frameDataSize, GRPFrame *targetFrame)
+{
+    GRPTRACESCOPE("GRPImage::DecodeGRPFrameData");
+    //Decoding needs no palette, and the frame is empty until decoded
+    if(targetFrame == NULL)
+    {
+        GRPImageNoFrameLoaded noFrameLoaded;
+        noFrameLoaded.SetErrorMessage("No GRP Frame is loaded");
+        throw noFrameLoaded;
+    }
+    if(frameDataSize < 2 * (size_t) targetFrame->GetImageHeight())
     {
-        std::copy(currentDataPosition, (currentDataPosition + 2),(char *) &imageRowOffsets.at(currentReadingRowOffset));
-        currentDataPosition += 2;
+        ThrowInvalidFrameData();
     }
     
+    //The row offset data is at the start of the frame data
+    const uint8_t *frameStart = (const uint8_t *) frameData;
+    const uint8_t *frameEnd = frameStart + frameDataSize;
+    imageStatistics.seeks++;
+    imageStatistics.bytesRead += 2 * targetFrame->GetImageHeight();
+    
+    //Create a vector of all the Image row offsets
+    std::vector<uint16_t> &imageRowOffsets = rowOffsetScratch;
+    imageRowOffsets.resize(targetFrame->GetImageHeight());
+    std::copy(frameData, frameData + (2 * targetFrame->GetImageHeight()), (char *) &imageRowOffsets.front());
+    
+    decodeScratch.clear();
+    
+    //Compressed frames are only checked, their pixels are not kept
+    bool expandPixels = (frameStorage == EXPANDEDFRAMES);
+    
+    //The end of the furthest row, the frame keeps the data up to it
+    const uint8_t *packetDataEnd = frameStart + (2 * targetFrame->GetImageHeight());
+    
     //The currentRow (x coordinate) that the decoder is at, it is used to
     //set the image position.
     int currentProcessingRow = 0;
@@ -349,6 +727,15 @@ void GRPImage::DecodeGRPFrameData(std::vector<char> *inputData, GRPFrame *target
     //or Imagemagick to convert.
     UniquePixel currentUniquePixel;
     
+    //The opaque bounds and pixel count are gathered packet by packet,
+    //clipped to the frame width like the span program
+    int frameWidth = targetFrame->GetImageWidth();
+    int opaqueLeft = frameWidth;
+    int opaqueRight = 0;
+    int opaqueTop = -1;
+    int opaqueBottom = 0;
+    uint32_t opaquePixelCount = 0;
+    
     
     //Goto each row and process the row data
     for(int currentProcessingHeight = 0; currentProcessingHeight < targetFrame->GetImageHeight(); currentProcessingHeight++)
@@ -357,58 +744,99 @@ void GRPImage::DecodeGRPFrameData(std::vector<char> *inputData, GRPFrame *target
 #if VERBOSE >= 2
         std::cout << "Current row offset is: " << (targetFrame->GetDataOffset() + (imageRowOffsets.at(currentProcessingHeight))) << '\n';
 #endif
-        //Seek to the point of the first byte in the rowData from the
-        //1.Skip over to the Frame data
-        //2.Skip over by the Row offset mentioned in the list
-        //inputFile.seekg((targetFrame->GetDataOffset() + (imageRowOffsets.at(currentProcessingHeight))));
-        currentDataPosition = inputData->begin();
-        currentDataPosition += (targetFrame->GetDataOffset() + imageRowOffsets.at(currentProcessingHeight));
+        //Skip over by the Row offset mentioned in the list
+        const uint8_t *currentDataPosition = frameStart + imageRowOffsets[currentProcessingHeight];
+        const uint8_t *rowStartPosition = currentDataPosition;
+        imageStatistics.seeks++;
         
         currentProcessingRow = 0;
+        int rowOpaqueLeft = 0;
+        int rowOpaqueRight = 0;
         
-        while(currentProcessingRow < targetFrame->GetImageWidth())
+        while(currentProcessingRow < frameWidth)
         {
-            std::copy(currentDataPosition, (currentDataPosition + 1),(char *) &rawPacket);
-            currentDataPosition += 1;
+            //Every packet (and its pixels) must be inside the frame data and
+            //move the row on, a zero count would never finish the row
+            if(currentDataPosition >= frameEnd)
+            {
+                ThrowInvalidFrameData();
+            }
+            rawPacket = *currentDataPosition++;
+            if(((rawPacket & 0x80) ? (rawPacket & 0x7f) : (rawPacket & 0x3f)) == 0)
+            {
+                ThrowInvalidFrameData();
+            }
             if(!(rawPacket & 0x80))
             {
+                //Rows are walked left to right, the first opaque packet
+                //starts the row's opaque run and the last one ends it
+                int packetEnd = std::min(currentProcessingRow + (rawPacket & 0x3f), frameWidth);
+                if(rowOpaqueRight == 0)
+                {
+                    rowOpaqueLeft = currentProcessingRow;
+                }
+                rowOpaqueRight = packetEnd;
+                opaquePixelCount += packetEnd - currentProcessingRow;
+                
                 //Repeat Operation (The first byte indicates a repeat pixel operation)
                 //The next byte indicates how far down the row to repeat.
                 if(rawPacket & 0x40)
                 {
                     rawPacket &= 0x3f;
-                    std::copy(currentDataPosition, (currentDataPosition + 1),(char *) &convertedPacket);
-                    currentDataPosition += 1;
+                    if(currentDataPosition >= frameEnd)
+                    {
+                        ThrowInvalidFrameData();
+                    }
+                    convertedPacket = *currentDataPosition++;
                     
                     //Set the Player color (Not implemented yet :|
                     //covertedPacket = tableof unitColor[ colorbyte+gr_gamenr];
-                    int operationCounter = rawPacket;
-                    currentUniquePixel.xPosition = currentProcessingRow;
-                    do{
-                        
-                        currentUniquePixel.yPosition = currentProcessingHeight;
-                        currentUniquePixel.colorPaletteReference = convertedPacket;
-                        targetFrame->frameData.push_back(currentUniquePixel);
-                        currentUniquePixel.xPosition++;
-                    }while (--operationCounter);
+                    //Pixels past the frame width are dropped like in the
+                    //span program
+                    if(expandPixels)
+                    {
+                        int operationCounter = packetEnd - currentProcessingRow;
+                        currentUniquePixel.xPosition = currentProcessingRow;
+                        do{
+                            
+                            currentUniquePixel.yPosition = currentProcessingHeight;
+                            currentUniquePixel.colorPaletteReference = convertedPacket;
+                            decodeScratch.push_back(currentUniquePixel);
+                            currentUniquePixel.xPosition++;
+                        }while (--operationCounter);
+                    }
                     
                     currentProcessingRow += rawPacket;
                 }
                 else
                 {
                     //Copy Pixel Operation, and how many pixels to copy directly
-                    int operationCounter = rawPacket;
+                    if(rawPacket > frameEnd - currentDataPosition)
+                    {
+                        ThrowInvalidFrameData();
+                    }
+                    if(!expandPixels)
+                    {
+                        currentDataPosition += rawPacket;
+                        currentProcessingRow += rawPacket;
+                        continue;
+                    }
+                    int clippedPixels = currentProcessingRow + rawPacket - packetEnd;
+                    int operationCounter = packetEnd - currentProcessingRow;
                     do
                     {
-                        std::copy(currentDataPosition, (currentDataPosition + 1),(char *) &convertedPacket);
-                        currentDataPosition += 1;
+                        convertedPacket = *currentDataPosition++;
                         
                         currentUniquePixel.xPosition = currentProcessingRow;
                         currentUniquePixel.yPosition = currentProcessingHeight;
                         currentUniquePixel.colorPaletteReference = convertedPacket;
-                        targetFrame->frameData.push_back(currentUniquePixel);
+                        decodeScratch.push_back(currentUniquePixel);
                         currentProcessingRow++;
                     } while (--operationCounter);
+                    
+                    //The pixels past the frame width are still packet data
+                    currentDataPosition += clippedPixels;
+                    currentProcessingRow += clippedPixels;
                 }
             }
             else
@@ -418,11 +846,51 @@ void GRPImage::DecodeGRPFrameData(std::vector<char> *inputData, GRPFrame *target
                 currentProcessingRow += rawPacket;
             }
         }
+        imageStatistics.bytesRead += currentDataPosition - rowStartPosition;
+        packetDataEnd = std::max(packetDataEnd, currentDataPosition);
+        
+        if(rowOpaqueRight > 0)
+        {
+            opaqueLeft = std::min(opaqueLeft, rowOpaqueLeft);
+            opaqueRight = std::max(opaqueRight, rowOpaqueRight);
+            if(opaqueTop < 0)
+            {
+                opaqueTop = currentProcessingHeight;
+            }
+            opaqueBottom = currentProcessingHeight + 1;
+        }
+    }
+    
+    grpOpaqueBounds opaqueBounds = {0, 0, 0, 0};
+    if(opaquePixelCount > 0)
+    {
+        opaqueBounds.xPosition = opaqueLeft;
+        opaqueBounds.yPosition = opaqueTop;
+        opaqueBounds.width = opaqueRight - opaqueLeft;
+        opaqueBounds.height = opaqueBottom - opaqueTop;
+    }
+    targetFrame->SetOpaqueStatistics(opaqueBounds, opaquePixelCount);
+    
+    //One allocation of the exact size in the image arena
+    targetFrame->frameData.assign(decodeScratch.begin(), decodeScratch.end());
+    
+    //Keep the checked RLE data so rows can be decoded again on their own
+    if(targetFrame->GetImageHeight() > 0)
+    {
+        targetFrame->SetCompressedData(frameStart, packetDataEnd - frameStart, &imageRowOffsets.front());
+        if(buildSpanPrograms)
+        {
+            targetFrame->BuildSpanProgram();
+        }
+        if(buildCollisionMasks)
+        {
+            targetFrame->BuildCollisionMask();
+        }
     }
     
 #if VERBOSE >= 5
     std::cout << "Frame data is size: " << targetFrame->frameData.size() << '\n';
-    for(std::list<UniquePixel>::iterator it = targetFrame->frameData.begin(); it != targetFrame->frameData.end(); it++)
+    for(framePixelVector::iterator it = targetFrame->frameData.begin(); it != targetFrame->frameData.end(); it++)
     {
         std::cout << '(' << it->xPosition << ',' << it->yPosition << ") = " << (int) it->colorPaletteReference << '\n';
     }
@@ -443,21 +911,369 @@ uint16_t GRPImage::getMaxImageHeight() const
     return maxImageHeight;
 }
 
+GRPFrame *GRPImage::GetFrame(int frameNumber)
+{
+    if(frameNumber < 0 || frameNumber >= (int) imageFrames.size())
+    {
+        GRPImageInvalidFrameNumber invalidFrame;
+        invalidFrame.SetErrorMessage("Invalid frame number requested");
+        throw invalidFrame;
+    }
+    return imageFrames.at(frameNumber);
+}
+
+grpOpaqueBounds GRPImage::GetOpaqueBounds() const
+{
+    int opaqueLeft = maxImageWidth;
+    int opaqueTop = maxImageHeight;
+    int opaqueRight = 0;
+    int opaqueBottom = 0;
+    for(std::vector<GRPFrame *>::const_iterator currentFrame = imageFrames.begin(); currentFrame != imageFrames.end(); currentFrame++)
+    {
+        grpOpaqueBounds frameBounds = (*currentFrame)->GetOpaqueBounds();
+        if(frameBounds.width == 0)
+        {
+            continue;
+        }
+        
+        //Frame coordinates to the image box
+        frameBounds.xPosition += (*currentFrame)->GetXOffset();
+        frameBounds.yPosition += (*currentFrame)->GetYOffset();
+        opaqueLeft = std::min(opaqueLeft, frameBounds.xPosition);
+        opaqueTop = std::min(opaqueTop, frameBounds.yPosition);
+        opaqueRight = std::max(opaqueRight, frameBounds.xPosition + frameBounds.width);
+        opaqueBottom = std::max(opaqueBottom, frameBounds.yPosition + frameBounds.height);
+    }
+    
+    grpOpaqueBounds imageBounds = {0, 0, 0, 0};
+    if(opaqueRight > 0)
+    {
+        imageBounds.xPosition = opaqueLeft;
+        imageBounds.yPosition = opaqueTop;
+        imageBounds.width = opaqueRight - opaqueLeft;
+        imageBounds.height = opaqueBottom - opaqueTop;
+    }
+    return imageBounds;
+}
+
+uint64_t GRPImage::GetOpaquePixelCount() const
+{
+    uint64_t opaquePixelCount = 0;
+    for(std::vector<GRPFrame *>::const_iterator currentFrame = imageFrames.begin(); currentFrame != imageFrames.end(); currentFrame++)
+    {
+        opaquePixelCount += (*currentFrame)->GetOpaquePixelCount();
+    }
+    return opaquePixelCount;
+}
+
 void GRPImage::SetColorPalette(ColorPalette *selectedColorPalette)
 {
     if(selectedColorPalette)
         currentPalette = selectedColorPalette;
 }
 
+void GRPImage::RemapColors(const std::vector<uint8_t> &remapTable)
+{
+    GRPTRACESCOPE("GRPImage::RemapColors");
+    if(remapTable.size() != MAXIMUMNUMBEROFCOLORSPERPALETTE)
+    {
+        GRPImageInvalidRemapTable invalidTable;
+        invalidTable.SetErrorMessage("A remap table needs one entry per palette color");
+        throw invalidTable;
+    }
+    for(std::vector<GRPFrame *>::iterator currentFrame = imageFrames.begin(); currentFrame != imageFrames.end(); currentFrame++)
+    {
+        (*currentFrame)->ApplyColorTable(&remapTable.front());
+    }
+}
+
+void GRPImage::RemapColors(ColorPalette *destinationPalette)
+{
+    if(currentPalette == NULL || destinationPalette == NULL)
+    {
+        GRPImageNoLoadedPaletteSet noPalette;
+        noPalette.SetErrorMessage("No palette has been set or loaded");
+        throw noPalette;
+    }
+    RemapColors(currentPalette->GenerateRemapTable(*destinationPalette));
+    currentPalette = destinationPalette;
+}
+
+void GRPImage::ConvertFrameToRGBA(int frameNumber, uint32_t *destinationBuffer, int destinationPitch, bool bgraOrder)
+{
+    GRPTRACESCOPE("GRPImage::ConvertFrameToRGBA");
+    if(currentPalette == NULL || (currentPalette->GetNumberOfColors() == 0))
+    {
+        GRPImageNoLoadedPaletteSet noPalette;
+        noPalette.SetErrorMessage("No palette has been set or loaded");
+        throw noPalette;
+    }
+    GRPFrame *currentFrame = GetFrame(frameNumber);
+    std::chrono::steady_clock::time_point conversionStart = std::chrono::steady_clock::now();
+    
+    //One indexed load per pixel, the lookup entries are already in the
+    //requested byte order.
+    const uint32_t *colorLookup = bgraOrder ? currentPalette->GetBGRALookupTable() : currentPalette->GetRGBALookupTable();
+    uint32_t *frameOrigin = destinationBuffer + (currentFrame->GetYOffset() * destinationPitch) + currentFrame->GetXOffset();
+    
+    if(currentFrame->frameData.empty() && currentFrame->HasSpanProgram())
+    {
+        //Whole runs per span, no packets to parse. The decoded pixels are
+        //still faster when kept, the spans of sprites are short.
+        const grpSpanRow *spanRows = currentFrame->GetSpanRows().data();
+        const grpCopySpan *copySpans = currentFrame->GetCopySpans().data();
+        const grpFillSpan *fillSpans = currentFrame->GetFillSpans().data();
+        const uint8_t *spanPixels = currentFrame->GetSpanPixels().data();
+        for(int currentRow = 0; currentRow < currentFrame->GetImageHeight(); currentRow++)
+        {
+            uint32_t *destinationRow = frameOrigin + (currentRow * destinationPitch);
+            const uint8_t *rowPixels = spanPixels + spanRows[currentRow].firstPixel;
+            for(uint32_t currentSpan = spanRows[currentRow].firstCopySpan; currentSpan < spanRows[currentRow + 1].firstCopySpan; currentSpan++)
+            {
+                //Locals so the pixel stores are not thought to change the span
+                int spanLength = copySpans[currentSpan].spanLength;
+                uint32_t *destinationPixel = destinationRow + copySpans[currentSpan].xPosition;
+                for(int currentPixel = 0; currentPixel < spanLength; currentPixel++)
+                {
+                    destinationPixel[currentPixel] = colorLookup[rowPixels[currentPixel]];
+                }
+                rowPixels += spanLength;
+            }
+            for(uint32_t currentSpan = spanRows[currentRow].firstFillSpan; currentSpan < spanRows[currentRow + 1].firstFillSpan; currentSpan++)
+            {
+                int spanLength = fillSpans[currentSpan].spanLength;
+                uint32_t fillValue = colorLookup[fillSpans[currentSpan].fillColor];
+                uint32_t *destinationPixel = destinationRow + fillSpans[currentSpan].xPosition;
+                std::fill(destinationPixel, destinationPixel + spanLength, fillValue);
+            }
+        }
+    }
+    else
+    {
+        const UniquePixel *firstPixel;
+        const UniquePixel *endPixel;
+        GetFramePixels(currentFrame, &firstPixel, &endPixel);
+        for (const UniquePixel *currentProcessPixel = firstPixel; currentProcessPixel != endPixel; currentProcessPixel++)
+        {
+            frameOrigin[(currentProcessPixel->yPosition * destinationPitch) + currentProcessPixel->xPosition] = colorLookup[currentProcessPixel->colorPaletteReference];
+        }
+    }
+    imageStatistics.framesConverted++;
+    imageStatistics.conversionSeconds += GetElapsedSeconds(conversionStart);
+}
+
+void GRPImage::SetFrameStorage(GRPFrameStorage frameStorage)
+{
+    this->frameStorage = frameStorage;
+}
+
+GRPFrameStorage GRPImage::GetFrameStorage() const
+{
+    return frameStorage;
+}
+
+void GRPImage::SetBuildSpanPrograms(bool buildSpanPrograms)
+{
+    this->buildSpanPrograms = buildSpanPrograms;
+}
+
+bool GRPImage::GetBuildSpanPrograms() const
+{
+    return buildSpanPrograms;
+}
+
+void GRPImage::SetBuildCollisionMasks(bool buildCollisionMasks)
+{
+    this->buildCollisionMasks = buildCollisionMasks;
+}
+
+bool GRPImage::GetBuildCollisionMasks() const
+{
+    return buildCollisionMasks;
+}
+
+void GRPImage::GetFramePixels(GRPFrame *currentFrame, const UniquePixel **firstPixel, const UniquePixel **endPixel)
+{
+    //A compressed frame (or one from a compressed load) has no frameData
+    if(currentFrame->frameData.empty() && currentFrame->HasCompressedData())
+    {
+        decodeScratch.clear();
+        currentFrame->DecodeRectangle(0, 0, currentFrame->GetImageWidth(), currentFrame->GetImageHeight(), &decodeScratch);
+        *firstPixel = decodeScratch.data();
+        *endPixel = decodeScratch.data() + decodeScratch.size();
+        return;
+    }
+    *firstPixel = currentFrame->frameData.data();
+    *endPixel = currentFrame->frameData.data() + currentFrame->frameData.size();
+}
+
+grpImageStatistics GRPImage::GetStatistics() const
+{
+    return imageStatistics;
+}
+
+void GRPImage::ResetStatistics()
+{
+    imageStatistics.imagesLoaded = 0;
+    imageStatistics.bytesRead = 0;
+    imageStatistics.seeks = 0;
+    imageStatistics.fileBytesRead = 0;
+    imageStatistics.framesDecoded = 0;
+    imageStatistics.duplicateFrames = 0;
+    imageStatistics.pixelsEmitted = 0;
+    imageStatistics.loadSeconds = 0;
+    imageStatistics.decodeSeconds = 0;
+    imageStatistics.framesConverted = 0;
+    imageStatistics.conversionSeconds = 0;
+    imageStatistics.framesExported = 0;
+    imageStatistics.exportSeconds = 0;
+}
+
+grpImageMemoryUsage GRPImage::MemoryUsage() const
+{
+    grpImageMemoryUsage memoryUsage;
+    memoryUsage.headerBytes = sizeof(GRPImage) + (imageFrames.capacity() * sizeof(GRPFrame *)) + (imageFrames.size() * sizeof(GRPFrame)) +
+                              (frameLayout.capacity() * sizeof(grpFrameLayout));
+    
+    memoryUsage.pixelBytes = 0;
+    memoryUsage.compressedBytes = 0;
+    memoryUsage.spanBytes = 0;
+    memoryUsage.collisionMaskBytes = 0;
+    memoryUsage.rowOffsetBytes = rowOffsetScratch.capacity() * sizeof(uint16_t);
+    for(std::vector<GRPFrame *>::const_iterator currentFrame = imageFrames.begin(); currentFrame != imageFrames.end(); currentFrame++)
+    {
+        memoryUsage.pixelBytes += (*currentFrame)->frameData.capacity() * sizeof(UniquePixel);
+        memoryUsage.compressedBytes += (*currentFrame)->GetPacketData().capacity();
+        memoryUsage.spanBytes += ((*currentFrame)->GetSpanRows().capacity() * sizeof(grpSpanRow)) + ((*currentFrame)->GetCopySpans().capacity() * sizeof(grpCopySpan)) +
+                                 ((*currentFrame)->GetFillSpans().capacity() * sizeof(grpFillSpan)) + (*currentFrame)->GetSpanPixels().capacity();
+        memoryUsage.collisionMaskBytes += (*currentFrame)->GetCollisionMaskBytes();
+        memoryUsage.rowOffsetBytes += (*currentFrame)->GetRowOffsets().capacity() * sizeof(uint16_t);
+    }
+    
+    memoryUsage.decodeScratchBytes = (decodeScratch.capacity() * sizeof(UniquePixel)) + (parsedHeader.frameHeaders.capacity() * sizeof(grpFrameHeader)) +
+                                     (framePositions.capacity() * sizeof(int));
+    memoryUsage.fileBufferBytes = fileBuffer.capacity();
+    memoryUsage.unusedArenaBytes = 0;
+    if(imageArena)
+    {
+        memoryUsage.unusedArenaBytes = imageArena->GetBytesReserved() - imageArena->GetBytesAllocated();
+    }
+    memoryUsage.totalBytes = memoryUsage.headerBytes + memoryUsage.pixelBytes + memoryUsage.compressedBytes + memoryUsage.spanBytes + memoryUsage.collisionMaskBytes + memoryUsage.rowOffsetBytes +
+                             memoryUsage.decodeScratchBytes + memoryUsage.fileBufferBytes + memoryUsage.unusedArenaBytes;
+    return memoryUsage;
+}
+
+grpImageMemoryUsage GRPImage::GetTotalMemoryUsage()
+{
+    grpImageMemoryUsage totalUsage = {};
+    std::lock_guard<std::mutex> liveImagesLock(liveImagesMutex);
+    for(std::set<const GRPImage *>::iterator currentImage = liveImages.begin(); currentImage != liveImages.end(); currentImage++)
+    {
+        grpImageMemoryUsage imageUsage = (*currentImage)->MemoryUsage();
+        totalUsage.headerBytes += imageUsage.headerBytes;
+        totalUsage.pixelBytes += imageUsage.pixelBytes;
+        totalUsage.compressedBytes += imageUsage.compressedBytes;
+        totalUsage.spanBytes += imageUsage.spanBytes;
+        totalUsage.collisionMaskBytes += imageUsage.collisionMaskBytes;
+        totalUsage.rowOffsetBytes += imageUsage.rowOffsetBytes;
+        totalUsage.decodeScratchBytes += imageUsage.decodeScratchBytes;
+        totalUsage.fileBufferBytes += imageUsage.fileBufferBytes;
+        totalUsage.unusedArenaBytes += imageUsage.unusedArenaBytes;
+        totalUsage.totalBytes += imageUsage.totalBytes;
+    }
+    return totalUsage;
+}
+
+grpImageHeader GRPImage::ProbeImage(std::string filePath)
+{
+    GRPTRACESCOPE("GRPImage::ProbeImage");
+    std::ifstream inputFile(filePath.c_str(), std::ios::binary);
+    //Short reads are reported as GRPImageInvalidHeader below
+    if(!inputFile.is_open())
+    {
+        throw std::ios_base::failure("Unable to open " + filePath);
+    }
+    
+    grpImageHeader imageHeader;
+    inputFile.read((char *) &imageHeader.numberOfFrames, 2);
+    inputFile.read((char *) &imageHeader.maxImageWidth, 2);
+    inputFile.read((char *) &imageHeader.maxImageHeight, 2);
+    
+    std::vector<char> frameTable(8 * imageHeader.numberOfFrames);
+    if(inputFile && !frameTable.empty())
+    {
+        inputFile.read(&frameTable.front(), frameTable.size());
+    }
+    if(!inputFile)
+    {
+        GRPImageInvalidHeader invalidHeader;
+        invalidHeader.SetErrorMessage("The GRP file is shorter than its frame header table");
+        throw invalidHeader;
+    }
+    if(!frameTable.empty())
+    {
+        ParseFrameHeaders(&frameTable.front(), imageHeader);
+    }
+    return imageHeader;
+}
+
+grpImageHeader GRPImage::ProbeImage(const std::vector<char> *inputImage)
+{
+    grpImageHeader imageHeader;
+    ParseImageHeader(inputImage, imageHeader);
+    return imageHeader;
+}
+
+void GRPImage::ComputeFrameLayout(const grpImageHeader &imageHeader, size_t dataSize, std::vector<grpFrameLayout> *frameLayout)
+{
+    frameLayout->resize(imageHeader.frameHeaders.size());
+    for(size_t currentFrame = 0; currentFrame < imageHeader.frameHeaders.size(); currentFrame++)
+    {
+        grpFrameLayout &currentLayout = frameLayout->at(currentFrame);
+        currentLayout.frameNumber = currentFrame;
+        currentLayout.dataOffset = imageHeader.frameHeaders[currentFrame].dataOffset;
+    }
+    std::sort(frameLayout->begin(), frameLayout->end(), CompareFrameLayout);
+    
+    //Frames with the same data follow the first of them, every frame's data
+    //ends where the next different data starts
+    uint32_t dataEnd = std::min<size_t>(dataSize, std::numeric_limits<uint32_t>::max());
+    for(size_t currentEntry = frameLayout->size(); currentEntry-- > 0;)
+    {
+        grpFrameLayout &currentLayout = frameLayout->at(currentEntry);
+        if(currentEntry + 1 < frameLayout->size() && frameLayout->at(currentEntry + 1).dataOffset != currentLayout.dataOffset)
+        {
+            dataEnd = frameLayout->at(currentEntry + 1).dataOffset;
+        }
+        currentLayout.dataEnd = (dataEnd > currentLayout.dataOffset) ? dataEnd : currentLayout.dataOffset;
+    }
+    for(size_t currentEntry = 0; currentEntry < frameLayout->size(); currentEntry++)
+    {
+        grpFrameLayout &currentLayout = frameLayout->at(currentEntry);
+        currentLayout.sharedWithFrame = currentLayout.frameNumber;
+        if(currentEntry > 0 && frameLayout->at(currentEntry - 1).dataOffset == currentLayout.dataOffset)
+        {
+            currentLayout.sharedWithFrame = frameLayout->at(currentEntry - 1).sharedWithFrame;
+        }
+    }
+}
+
+const std::vector<grpFrameLayout> &GRPImage::GetFrameLayout() const
+{
+    return frameLayout;
+}
+
 #if MAGICKPP_FOUND
 void GRPImage::SaveConvertedImage(std::string outFilePath, int startingFrame, int endingFrame, bool singleStitchedImage, int imagesPerRow)
 {
+    GRPTRACESCOPE("GRPImage::SaveConvertedImage");
     
     if(!currentPalette && (currentPalette->GetNumberOfColors() != 0))
     {
         GRPImageNoLoadedPaletteSet noPalette;
         noPalette.SetErrorMessage("No loaded set");
     }
+    std::chrono::steady_clock::time_point exportStart = std::chrono::steady_clock::now();
     MagickCore::MagickCoreGenesis(NULL, MagickCore::MagickFalse);
     Magick::Image *convertedImage;
     //Due to how Imagemagick creates the image it must be set before usage and must be resized proportionally
@@ -475,7 +1291,8 @@ void GRPImage::SaveConvertedImage(std::string outFilePath, int startingFrame, in
         //We will erase the image after writing the last processed image to disk
         convertedImage->backgroundColor("transparent");
     }
-    colorValues currentPalettePixel;
+    const uint8_t *packedPalette = currentPalette->GetPackedPaletteData();
+    const uint8_t *currentPalettePixel;
     std::stringstream fileOutPath;
     Magick::ColorRGB currentMagickPixel;
     currentMagickPixel.alpha(0);
@@ -495,13 +1312,17 @@ void GRPImage::SaveConvertedImage(std::string outFilePath, int startingFrame, in
         }
         
         //Start appling the pixels with the refence colorpalettes
-        for (std::list<UniquePixel>::iterator currentProcessPixel = currentFrame->frameData.begin(); currentProcessPixel != currentFrame->frameData.end(); currentProcessPixel++)
+        const UniquePixel *firstPixel;
+        const UniquePixel *endPixel;
+        GetFramePixels(currentFrame, &firstPixel, &endPixel);
+        for (const UniquePixel *currentProcessPixel = firstPixel; currentProcessPixel != endPixel; currentProcessPixel++)
         {
-            currentPalettePixel = currentPalette->GetColorFromPalette(currentProcessPixel->colorPaletteReference);
+            //Packed palette colors are Red, Green, Blue bytes
+            currentPalettePixel = packedPalette + (3 * currentProcessPixel->colorPaletteReference);
             
-            currentMagickPixel.red(currentPalettePixel.RedElement / 255);
-            currentMagickPixel.green(currentPalettePixel.GreenElement / 255);
-            currentMagickPixel.blue(currentPalettePixel.BlueElement / 255);
+            currentMagickPixel.red(currentPalettePixel[0] / 255.0);
+            currentMagickPixel.green(currentPalettePixel[1] / 255.0);
+            currentMagickPixel.blue(currentPalettePixel[2] / 255.0);
 
             
            if(singleStitchedImage)
@@ -515,6 +1336,8 @@ void GRPImage::SaveConvertedImage(std::string outFilePath, int startingFrame, in
 
         }
         
+        imageStatistics.framesExported++;
+        
         //If not stitched it's time to write the current frame to a file
         if(!singleStitchedImage)
         {
@@ -540,7 +1363,7 @@ void GRPImage::SaveConvertedImage(std::string outFilePath, int startingFrame, in
     //Clean up our pointers from earlier.
     delete convertedImage;
     convertedImage = NULL;
-    
+    imageStatistics.exportSeconds += GetElapsedSeconds(exportStart);
 }
 #else
 void GRPImage::SaveConvertedImage(std::string outFilePath, int startingFrame, int endingFrame, bool singleStitchedImage, int imagesPerRow)
@@ -555,12 +1378,92 @@ void GRPImage::CleanGRPImage()
 {
     if(imageFrames.size() != 0)
     {
+        //The frames live in the arena, only their destructors are run
         for(std::vector<GRPFrame *>::iterator currentDeleteFrame = imageFrames.begin(); currentDeleteFrame != imageFrames.end(); currentDeleteFrame++)
         {
-            delete *currentDeleteFrame;
+            //A load that threw part way leaves empty slots
+            if(*currentDeleteFrame != NULL)
+            {
+                (*currentDeleteFrame)->~GRPFrame();
+            }
             *currentDeleteFrame = NULL;
         }
         imageFrames.resize(0);
     }
+    if(imageArena)
+    {
+        imageArena->Reset();
+    }
+}
+
+void GRPImage::ReuseImageBuffers()
+{
+    size_t previousArenaBytes = 0;
+    if(imageArena)
+    {
+        previousArenaBytes = imageArena->GetBytesReserved();
+    }
+    CleanGRPImage();
+    if(!imageArena)
+    {
+        imageArena.reset(new MemoryArena);
+    }
+    
+    //The previous image may have been spread over several blocks, hold it
+    //in one so a similar image needs no new block
+    imageArena->Reserve(previousArenaBytes);
+}
+
+void GRPImage::AbandonImageLoad()
+{
+    CleanGRPImage();
+    frameLayout.clear();
+    framePositions.clear();
+    numberOfFrames = 0;
+    maxImageWidth = 0;
+    maxImageHeight = 0;
+}
+
+void GRPImage::ShrinkToFit()
+{
+    decodeScratch.clear();
+    decodeScratch.shrink_to_fit();
+    rowOffsetScratch.clear();
+    rowOffsetScratch.shrink_to_fit();
+    parsedHeader.frameHeaders.clear();
+    parsedHeader.frameHeaders.shrink_to_fit();
+    framePositions.clear();
+    framePositions.shrink_to_fit();
+    frameLayout.shrink_to_fit();
+    fileBuffer.clear();
+    fileBuffer.shrink_to_fit();
+    imageFrames.shrink_to_fit();
+    
+    if(!imageArena)
+    {
+        return;
+    }
+    if(imageFrames.empty())
+    {
+        imageArena.reset();
+        return;
+    }
+    
+    //Copy the frames into an arena of their exact size, every frame and
+    //pixel vector may need its alignment as padding
+    std::unique_ptr<MemoryArena> previousArena(std::move(imageArena));
+    imageArena.reset(new MemoryArena);
+    imageArena->Reserve(previousArena->GetBytesAllocated() + (2 * imageFrames.size() * alignof(std::max_align_t)));
+    for(std::vector<GRPFrame *>::iterator currentFrame = imageFrames.begin(); currentFrame != imageFrames.end(); currentFrame++)
+    {
+        GRPFrame *previousFrame = *currentFrame;
+        *currentFrame = AllocateFrame(*previousFrame);
+        previousFrame->~GRPFrame();
+    }
+}
+
+GRPFrame *GRPImage::AllocateFrame(const GRPFrame &frameHeader)
+{
+    return new (imageArena->Allocate(sizeof(GRPFrame), alignof(GRPFrame))) GRPFrame(frameHeader, imageArena.get());
 }
 
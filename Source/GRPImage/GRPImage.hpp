@@ -20,6 +20,10 @@
 #include "../Exceptions/GRPImage/GRPImageException.hpp"
 #include <list>
 #include <fstream>
+#include <istream>
+#include <memory>
+#include <functional>
+#include <chrono>
 
 //Gives the ability to convert images to other formats.
 #if MAGICKPP_FOUND
@@ -36,16 +40,139 @@
     typedef uint16_t u_int16_t;
     typedef uint32_t u_int32_t;
 #else
-#include <unordered_map>
 #include <inttypes.h>
 #endif
 
 enum GRPImageType {STANDARD, SHADOW};
 
+//How a GRPImage keeps its frames, see GRPImage::SetFrameStorage
+//EXPANDEDFRAMES: frameData holds the decoded pixels (and the RLE data is kept)
+//COMPRESSEDFRAMES: only the RLE data is kept, pixels are decoded on use
+enum GRPFrameStorage {EXPANDEDFRAMES, COMPRESSEDFRAMES};
+
+//The chunk size a streamed GRP is read and skipped in
+#define STREAMREADSIZE (64 * 1024)
+
+//Supplies streamed GRP data, copies up to maximumBytes into destinationData
+//and returns the number of bytes copied (0 at the end of the data)
+typedef std::function<size_t(char *destinationData, size_t maximumBytes)> grpStreamSource;
+
+//Called by the streaming LoadImage as soon as a frame has been decoded,
+//frameNumber is the GetFrame number of decodedFrame
+typedef std::function<void(int frameNumber, GRPFrame *decodedFrame)> grpFrameDecodedCallback;
+
+//One entry of the GRP frame header table, see GRPImage::ProbeImage
+struct grpFrameHeader
+{
+    uint8_t xOffset;
+    uint8_t yOffset;
+    uint8_t width;
+    uint8_t height;
+    
+    //Where the frame row offsets start in the GRP data
+    uint32_t dataOffset;
+};
+
+//The GRP header and frame header table, read without decoding any frame
+struct grpImageHeader
+{
+    //The number of frame headers, duplicates included
+    uint16_t numberOfFrames;
+    uint16_t maxImageWidth;
+    uint16_t maxImageHeight;
+    
+    std::vector<grpFrameHeader> frameHeaders;
+};
+
+//Where the data of one frame lies in the GRP data, see GRPImage::ComputeFrameLayout
+struct grpFrameLayout
+{
+    //The frame header this entry belongs to
+    uint16_t frameNumber;
+    
+    //The first frame header using the same data, frameNumber when the
+    //data is not shared
+    uint16_t sharedWithFrame;
+    
+    //The frame data (row offsets and rows) lies in [dataOffset, dataEnd),
+    //dataEnd is the start of the next frame data or the end of the GRP
+    uint32_t dataOffset;
+    uint32_t dataEnd;
+};
+
+//Runtime counters of a GRPImage, see GRPImage::GetStatistics
+struct grpImageStatistics
+{
+    //Images loaded, the GRP bytes read and the input repositionings
+    //(file seeks or jumps through the memory data)
+    uint64_t imagesLoaded;
+    uint64_t bytesRead;
+    uint64_t seeks;
+    
+    //The bytes the loaders given a file path read from the file,
+    //bytesRead only counts the GRP data that was used
+    uint64_t fileBytesRead;
+    
+    //Frames decoded, frames skipped as duplicates and decoded pixels
+    uint64_t framesDecoded;
+    uint64_t duplicateFrames;
+    uint64_t pixelsEmitted;
+    
+    //Whole LoadImage calls and the frame decoding part of them
+    double loadSeconds;
+    double decodeSeconds;
+    
+    //ConvertFrameToRGBA
+    uint64_t framesConverted;
+    double conversionSeconds;
+    
+    //SaveConvertedImage
+    uint64_t framesExported;
+    double exportSeconds;
+};
+
+//The bytes held by a GRPImage, see GRPImage::MemoryUsage
+struct grpImageMemoryUsage
+{
+    //The GRPImage object, the frame table and the GRPFrame objects
+    size_t headerBytes;
+    
+    //The decoded pixels of every frame
+    size_t pixelBytes;
+    
+    //The RLE frame data every frame keeps for row decoding
+    size_t compressedBytes;
+    
+    //The frame span programs
+    size_t spanBytes;
+    
+    //The frame collision masks
+    size_t collisionMaskBytes;
+    
+    //Frame row offset tables kept after decoding
+    size_t rowOffsetBytes;
+    
+    //The reusable buffers used while loading
+    size_t decodeScratchBytes;
+    
+    //The last file read by LoadImage(std::string)
+    size_t fileBufferBytes;
+    
+    //Image arena memory reserved but not handed out yet
+    size_t unusedArenaBytes;
+    
+    size_t totalBytes;
+};
+
 class GRPImage
 {
     
 public:
+    //!Create an image with no frames
+    /*! \post LoadImage can be used to load the image data
+     * \note NA*/
+    GRPImage();
+    
     //!Set image data from memory
     /*! Use the image data that is loaded in a the specified
      * vector.
@@ -77,6 +204,25 @@ public:
      * \note NA*/
     ~GRPImage();
     
+    //!Take over the frames of another GRPImage
+    /*! Nothing is copied, the frame storage changes owner.
+     * \param[in] sourceImage The image to take over, left with no frames
+     * \note The palette reference (not the palette) is taken along*/
+    GRPImage(GRPImage &&sourceImage);
+    
+    //!Take over the frames of another GRPImage
+    /*! The current frames are released first.
+     * \param[in] sourceImage The image to take over, left with no frames
+     * \note NA*/
+    GRPImage &operator=(GRPImage &&sourceImage);
+    
+    //!Make a deep copy of the image
+    /*! The frames and pixel data are copied into the new image's own
+     *  storage, the statistics of the copy start at zero.
+     * \returns The copied GRPImage
+     * \note The copy references the same ColorPalette*/
+    GRPImage Clone() const;
+    
     //!Set image data from memory
     /*! Use the image data that is loaded in a the specified
      * vector.
@@ -88,7 +234,9 @@ public:
      * \param[in] removeDuplicates Remove GRPFrames that are the same
      * \warning This will not make a copy of the std::vector<char> data
      *      so if you delete the vector before/during processing it will likly crash.
-     * \note NA*/
+     * \throws GRPImageInvalidHeader The data is shorter than its frame table
+     * \note The frame and pixel storage of the previous image is reused, loading
+     *      images of a similar size one after another allocates nothing. See ShrinkToFit*/
     void LoadImage(std::vector<char> *inputImage, bool removeDuplicates = true);
     
     //!Load image data from a file (.grp)
@@ -97,9 +245,120 @@ public:
      * \pre Filepath must be to a valid .grp image file
      * \post The file is loaded into memory for the GRPImage
      * \param[in] filePath The file path to the grp image file
-     * \note NA*/
+     * \throws GRPImageInvalidHeader The file is shorter than its frame table
+     * \note The file is read in one go and kept, the frame and pixel storage
+     *      of the previous image is reused*/
     void LoadImage(std::string filePath, bool removeDuplicates = true);
     
+    //!Load only some of the frames from memory
+    /*! Reads only the frame header entries and the data of the requested
+     *  frames. Duplicates are not removed, GetFrame(n) is frameNumbers[n].
+     * \param[in] inputImage The GRP data
+     * \param[in] frameNumbers The frame header numbers to load, in GetFrame order
+     * \throws GRPImageInvalidFrameNumber A frame number is not in the GRP
+     * \throws GRPImageInvalidHeader
+     * \throws GRPImageInvalidFrameData
+     * \note GetFrameLayout entries then number frames by GetFrame number*/
+    void LoadImageFrames(std::vector<char> *inputImage, const std::vector<int> &frameNumbers);
+    
+    //!Load only some of the frames from a file (.grp)
+    /*! Seeks to and reads only the requested frame header entries and
+     *  frame data, in file order.
+     * \param[in] filePath The file path to the grp image file
+     * \param[in] frameNumbers The frame header numbers to load, in GetFrame order
+     * \throws GRPImageInvalidFrameNumber
+     * \throws GRPImageInvalidHeader
+     * \throws GRPImageInvalidFrameData
+     * \throws std::ios_base::failure The file could not be opened
+     * \note NA*/
+    void LoadImageFrames(std::string filePath, const std::vector<int> &frameNumbers);
+    
+    //!Load the frames startingFrame to endingFrame - 1 from memory
+    /*! \param[in] inputImage The GRP data
+     * \param[in] startingFrame The first frame header number to load
+     * \param[in] endingFrame The frame header number to stop loading on
+     * \throws GRPImageInvalidFrameNumber
+     * \note Same range convention as SaveConvertedImage*/
+    void LoadImageFrames(std::vector<char> *inputImage, int startingFrame, int endingFrame);
+    
+    //!Load the frames startingFrame to endingFrame - 1 from a file (.grp)
+    /*! \param[in] filePath The file path to the grp image file
+     * \param[in] startingFrame The first frame header number to load
+     * \param[in] endingFrame The frame header number to stop loading on
+     * \throws GRPImageInvalidFrameNumber
+     * \note NA*/
+    void LoadImageFrames(std::string filePath, int startingFrame, int endingFrame);
+    
+    //!Load image data from a stream without seeking
+    /*! The stream is read front to back once, only the frame header table
+     *  and the data of one frame are buffered at a time. Works on pipes
+     *  and decompression streams.
+     * \param[in] inputStream The GRP data, read up to the end of the last frame
+     * \param[in] removeDuplicates Remove GRPFrames that are the same
+     * \param[in] frameDecoded Called for each frame as soon as it is decoded,
+     *      the frames are decoded in the order of their data (see GetFrameLayout)
+     * \throws GRPImageInvalidHeader The frame table is cut off or frame data
+     *      lies inside the header
+     * \throws GRPImageInvalidFrameData Rows use data outside of their frame
+     *      (only the loaders with the whole GRP in memory support that)
+     * \note The frame and pixel storage of the previous image is reused*/
+    void LoadImage(std::istream &inputStream, bool removeDuplicates = true, const grpFrameDecodedCallback &frameDecoded = grpFrameDecodedCallback());
+    
+    //!Load image data from a callback source without seeking
+    /*! Same as the std::istream LoadImage with the data coming from
+     *  streamSource.
+     * \param[in] streamSource Supplies the GRP data in order
+     * \param[in] removeDuplicates Remove GRPFrames that are the same
+     * \param[in] frameDecoded Called for each frame as soon as it is decoded
+     * \throws GRPImageInvalidHeader
+     * \throws GRPImageInvalidFrameData
+     * \note NA*/
+    void LoadImage(const grpStreamSource &streamSource, bool removeDuplicates = true, const grpFrameDecodedCallback &frameDecoded = grpFrameDecodedCallback());
+    
+    //!Choose how the frames of the following loads are kept
+    /*! With COMPRESSEDFRAMES the frames only keep their GRP row data
+     *  (a fraction of the decoded pixels) and the conversions decode
+     *  them as they go, trading some conversion time for memory.
+     * \post Frames loaded from now on use frameStorage, the frames
+     *       already loaded are unchanged
+     * \param[in] frameStorage EXPANDEDFRAMES (default) or COMPRESSEDFRAMES
+     * \note With COMPRESSEDFRAMES GRPFrame::frameData is left empty, use
+     *       GRPFrame::DecodeRectangle to get the pixels of a frame*/
+    void SetFrameStorage(GRPFrameStorage frameStorage);
+    
+    //!Get how the frames of the following loads are kept
+    GRPFrameStorage GetFrameStorage() const;
+    
+    //!Choose if the following loads build the frame span programs
+    /*! Span programs (see GRPFrame::BuildSpanProgram) are built once as
+     *  the frames are decoded. ConvertFrameToRGBA draws COMPRESSEDFRAMES
+     *  frames from them instead of decoding the packets every time.
+     * \param[in] buildSpanPrograms Build the span programs (default false)
+     * \note NA*/
+    void SetBuildSpanPrograms(bool buildSpanPrograms);
+    
+    //!Check if the following loads build the frame span programs
+    bool GetBuildSpanPrograms() const;
+    
+    //!Choose if the following loads build the frame collision masks
+    /*! Collision masks (see GRPFrame::BuildCollisionMask) are built once
+     *  as the frames are decoded, for GRPFrame::CollidesWith.
+     * \param[in] buildCollisionMasks Build the collision masks (default false)
+     * \note NA*/
+    void SetBuildCollisionMasks(bool buildCollisionMasks);
+    
+    //!Check if the following loads build the frame collision masks
+    bool GetBuildCollisionMasks() const;
+    
+    //!Give back the storage kept for reuse by the next LoadImage
+    /*! Frees the decoding buffers and the unused part of the image
+     *  storage. The loaded frames are moved into storage sized for
+     *  them, with no frames loaded everything is freed.
+     * \post MemoryUsage only counts what the loaded frames need
+     * \warning GRPFrame pointers from GetFrame are invalidated
+     * \note NA*/
+    void ShrinkToFit();
+    
     //!Return the number of frames in a GRPImage
     /*! Return the number of frames in a GRP image animation.
      * \pre GRP image data must be defined and loaded into
@@ -125,6 +384,28 @@ public:
      * \note NA*/
     uint16_t getMaxImageHeight() const;
     
+    //!Return a decoded GRP image Frame
+    /*! Gives access to a single decoded frame, for example to
+     *  apply one of the ColorPalette color tables to it.
+     * \pre GRPImage must be defined and have imageData loaded
+     * \returns The GRPFrame at frameNumber, still owned by the GRPImage
+     * \param[in] frameNumber The index of the frame (0 to getNumberOfFrames() - 1)
+     * \throws GRPImageInvalidFrameNumber
+     * \note NA*/
+    GRPFrame *GetFrame(int frameNumber);
+    
+    //!Get the tight bounds of the opaque pixels of every frame
+    /*! The union of the frames' GRPFrame::GetOpaqueBounds, gathered when
+     *  they were decoded, so no pixels are read here.
+     * \pre GRPImage must be defined and have imageData loaded
+     * \returns The bounds inside the (getMaxImageWidth x getMaxImageHeight)
+     *      image box, empty when every frame is transparent
+     * \note NA*/
+    grpOpaqueBounds GetOpaqueBounds() const;
+    
+    //!Get the number of opaque pixels in all of the frames
+    uint64_t GetOpaquePixelCount() const;
+    
     //!Set the desired colorPalette to use
     /*!Sets the colorPalette that will be used as reference for image
      *conversion.
@@ -136,6 +417,26 @@ public:
      * \note NA*/
     void SetColorPalette(ColorPalette *selectedColorPalette);
     
+    //!Re-palettize every frame with a remap table
+    /*!Replaces every pixel's palette index with remapTable[index], one table
+     * pass over all of the frames.
+     * \pre GRPImage is loaded.
+     * \post The frames reference the colors of the remap destination palette.
+     * \param[in] remapTable A 256 byte table, normally from ColorPalette::GenerateRemapTable
+     * \throws GRPImageInvalidRemapTable
+     * \note NA*/
+    void RemapColors(const std::vector<uint8_t> &remapTable);
+    
+    //!Move every frame over to another palette
+    /*!Builds the remap table from the current palette to destinationPalette,
+     * remaps all the frames and sets destinationPalette as the current palette.
+     * \pre GRPImage is loaded and a loaded ColorPalette is set.
+     * \param[in] destinationPalette The loaded palette the image should use
+     * \throws GRPImageNoLoadedPaletteSet
+     * \throws NoPaletteLoadedException
+     * \note NA*/
+    void RemapColors(ColorPalette *destinationPalette);
+    
     //!Save the GRPImage frames to a file via ImageMaigck
     /*!Save the GRPImage frames into the file format of your choosing
      * \pre GRPImage is loaded.
@@ -148,50 +449,224 @@ public:
      * \note NA*/
     void SaveConvertedImage(std::string outFilePath, int startingFrame, int endingFrame, bool singleStitchedImage = true, int imagesPerRow = 10);
     
+    //!Convert a GRPImage frame to 32bit RGBA (or BGRA) pixels
+    /*!Writes the frame pixels into a caller owned 32bit buffer using the
+     * palette lookup tables. Transparent pixels are left untouched so the
+     * buffer should be cleared (or hold a background) beforehand.
+     * \pre GRPImage is loaded and a loaded ColorPalette is set.
+     * \post The frame is drawn at its x/y offset inside the buffer.
+     * \param[in] frameNumber The frame to convert.
+     * \param[out] destinationBuffer At least destinationPitch * getMaxImageHeight() pixels.
+     * \param[in] destinationPitch The number of pixels per buffer row (>= getMaxImageWidth()).
+     * \param[in] bgraOrder Write the bytes Blue, Green, Red, Alpha instead of Red, Green, Blue, Alpha.
+     * \throws GRPImageNoLoadedPaletteSet
+     * \throws GRPImageInvalidFrameNumber
+     * \note NA*/
+    void ConvertFrameToRGBA(int frameNumber, uint32_t *destinationBuffer, int destinationPitch, bool bgraOrder = false);
+    
+    //!Get the runtime counters of the image
+    /*!Counters accumulate over every load and conversion until
+     * ResetStatistics is called.
+     * \returns A copy of the current grpImageStatistics
+     * \note NA*/
+    grpImageStatistics GetStatistics() const;
+    
+    //!Set all the runtime counters back to zero
+    void ResetStatistics();
+    
+    //!Get the bytes held by the image broken down by use
+    /*!Counts the allocated frames and pixel storage, allocator overhead
+     * is not included.
+     * \returns The grpImageMemoryUsage of this image
+     * \note NA*/
+    grpImageMemoryUsage MemoryUsage() const;
+    
+    //!Get the summed MemoryUsage of every live GRPImage
+    /*! \returns The grpImageMemoryUsage of all GRPImages in the process
+     * \warning Only the list of live images is locked, each image is read
+     *      without a lock of its own. No other thread may be loading,
+     *      remapping or otherwise changing any GRPImage while this runs.
+     * \note NA*/
+    static grpImageMemoryUsage GetTotalMemoryUsage();
+    
+    //!Read the GRP header and frame table of a file without decoding it
+    /*!Only the 6 byte header and the 8 bytes per frame header are read
+     * (two reads), so the dimensions of many files can be listed quickly.
+     * \param[in] filePath The file path to the grp image file
+     * \returns The grpImageHeader with every frame header in file order
+     * \throws GRPImageInvalidHeader The file is shorter than its frame table
+     * \throws std::ios_base::failure The file could not be opened
+     * \note NA*/
+    static grpImageHeader ProbeImage(std::string filePath);
+    
+    //!Read the GRP header and frame table from memory without decoding
+    /*! \param[in] inputImage The GRP data
+     * \returns The grpImageHeader with every frame header in file order
+     * \throws GRPImageInvalidHeader The data is shorter than its frame table
+     * \note NA*/
+    static grpImageHeader ProbeImage(const std::vector<char> *inputImage);
+    
+    //!Order the frames of a GRP by where their data is stored
+    /*!One entry per frame header sorted by dataOffset, frames sharing data
+     * follow the first of them. Reading the entries with
+     * sharedWithFrame == frameNumber front to back reads every frame's
+     * data once without seeking backwards.
+     * \param[in] imageHeader The header from ProbeImage
+     * \param[in] dataSize The size of the whole GRP data, ends the last frame
+     * \param[out] frameLayout The computed layout, replaces the contents
+     * \note NA*/
+    static void ComputeFrameLayout(const grpImageHeader &imageHeader, size_t dataSize, std::vector<grpFrameLayout> *frameLayout);
+    
+    //!Get the layout of the loaded image
+    /*!LoadImage decodes the frames in this order, frameNumber is the frame
+     * header number which differs from the GetFrame number once duplicates
+     * are removed.
+     * \returns The ComputeFrameLayout result for the loaded GRP
+     * \note NA*/
+    const std::vector<grpFrameLayout> &GetFrameLayout() const;
+    
 protected:
     
     //!Deleted any GRPImage data for reuse
-    /*! Deallocated all data related to the GRP Image
+    /*! Destroys all the frames, the arena keeps its largest block
      * \pre NA
      * \post Data is deleted
      * \note NA*/
     void CleanGRPImage();
     
-    //!Decode the GRPFrameData
-    /*!Decode the GRP compression and save the unique pixels to the GRPFrame datastruct
-     * \pre GRPImage Loaded
-     * \post GRPImage Frame is decoded into the frame
-     * \param[in] inputFile a input file stream of the GRPImage file
-     * \param[in[ targetFrame The frame to store the resulting image data
+    //!Prepare the image storage for the next LoadImage
+    /*! Cleans the image and makes room for an image as large as the
+     *  previous one in a single arena block.
+     * \post imageArena exists and holds no frames
+     * \note NA*/
+    void ReuseImageBuffers();
+    
+    //!Leave an empty image behind after a load threw part way
+    /*! Frames are decoded after PrepareFrameSlots set up the image, a
+     *  frame that fails to decode must not leave the image reporting
+     *  frames it does not hold.
+     * \post The image has no frames, getNumberOfFrames() is 0
      * \note NA*/
-    void DecodeGRPFrameData(std::ifstream &inputFile, GRPFrame *targetFrame);
+    void AbandonImageLoad();
     
     //!Decode the GRPFrameData
     /*!Decode the GRP compression and save the unique pixels to the GRPFrame datastruct
      * \pre GRPImage Loaded
      * \post GRPImage Frame is decoded into the frame
-     * \param[in] inputData A vector of the GRPImage file data
+     * \param[in] frameData The frame data, starting with its row offsets
+     * \param[in] frameDataSize The bytes available from frameData on
      * \param[in] targetFrame The frame to store the resulting image data
+     * \throws GRPImageInvalidFrameData A row runs past frameDataSize or
+     *      has a packet that does not move the row on
+     * \note NA*/
+    void DecodeGRPFrameData(const char *frameData, size_t frameDataSize, GRPFrame *targetFrame);
+    
+    //!Check requested frame numbers against the GRP header
+    /*! \param[in] frameNumbers The frame header numbers requested
+     * \param[in] headerNumberOfFrames The frame count of the GRP header
+     * \param[in] dataSize The size of the GRP data
+     * \throws GRPImageInvalidFrameNumber
+     * \throws GRPImageInvalidHeader The frame table is cut off
+     * \note NA*/
+    void CheckFrameNumbers(const std::vector<int> &frameNumbers, uint16_t headerNumberOfFrames, uint64_t dataSize);
+    
+    //!Check the parsed frame headers before anything is loaded
+    /*! \param[in] firstDataOffset The lowest valid frame dataOffset
+     * \param[in] dataSize The size of the GRP data
+     * \throws GRPFrameInvalidFrameDemensions
+     * \throws GRPImageInvalidHeader
+     * \note NA*/
+    void CheckFrameHeaders(uint64_t firstDataOffset, uint64_t dataSize);
+    
+    //!Clean the image and lay out the parsed frame headers
+    /*! \post frameLayout, framePositions and the imageFrames slots are set
+     * \param[in] dataSize The size of the GRP data, see ComputeFrameLayout
+     * \param[in] removeDuplicates Give duplicate frames no slot
+     * \note NA*/
+    void PrepareFrameSlots(size_t dataSize, bool removeDuplicates);
+    
+    //!Decode one frame of the layout into its imageFrames slot
+    /*! \param[in] frameLayoutEntry The frame to decode
+     * \param[in] frameData The data at frameLayoutEntry.dataOffset
+     * \param[in] frameDataSize The bytes available from frameData on
+     * \returns The decoded frame, NULL for a removed duplicate
      * \note NA*/
-    void DecodeGRPFrameData(std::vector<char> *inputData, GRPFrame *targetFrame);
+    GRPFrame *DecodeLayoutFrame(const grpFrameLayout &frameLayoutEntry, const char *frameData, size_t frameDataSize);
+    
+    //!Update the frame count and statistics at the end of a load
+    void FinishImageLoad(bool removeDuplicates, std::chrono::steady_clock::time_point loadStart);
     
     //!Load file into a std::vector<char>
-    /*!Subroutine function to load a file into the internal imageData or
-     * or palette data (depending on the function call).
+    /*!Subroutine function to load a file into the internal fileBuffer
+     * with a single read.
      * \pre GRPImage must be defined and initialized, sourceFilePath must be a valid
-     *      file path. destinationVector must be defined and initialized (blank).
+     *      file path. destinationVector must be defined and initialized.
      * \post The destinationVector contains the data from the file at path sourceFilePath
+     * \throws std::ios_base::failure The file could not be read
+     * \note NA*/
+    void LoadFileToVector(std::string sourceFilePath, std::vector<char> *destinationVector);
+    
+    //!Place a copy of a parsed frame header in the image arena
+    /*! \param[in] frameHeader The frame header read from the GRP data
+     * \returns The new frame, destroyed by CleanGRPImage
+     * \note NA*/
+    GRPFrame *AllocateFrame(const GRPFrame &frameHeader);
+    
+    //!Get the pixels of a frame for a conversion
+    /*! Expanded frames give their frameData, compressed frames are decoded
+     *  into decodeScratch (valid until the next call).
+     * \param[in] currentFrame The frame to get the pixels of
+     * \param[out] firstPixel The first pixel of the frame
+     * \param[out] endPixel One past the last pixel of the frame
      * \note NA*/
-    void LoadFileToVector(std::string sourceFilePath, std::vector<unsigned char> *destinationVector);
+    void GetFramePixels(GRPFrame *currentFrame, const UniquePixel **firstPixel, const UniquePixel **endPixel);
     
 private:
-    //The decoded GRPFrames
+    //Frames are copied with Clone, an implicit copy would share the frames
+    GRPImage(const GRPImage &) = delete;
+    GRPImage &operator=(const GRPImage &) = delete;
+    
+    //Holds the GRPFrames and their pixel data, released all at once.
+    //The arena is held by pointer so the frame allocators stay valid
+    //when the image is moved.
+    std::unique_ptr<MemoryArena> imageArena;
+    
+    //The decoded GRPFrames (allocated in imageArena)
     std::vector<GRPFrame *> imageFrames;
     
+    //Frames are decoded here first so their frameData is allocated once
+    //at its final size.
+    std::vector<UniquePixel> decodeScratch;
+    
+    //The row offsets of the frame being decoded
+    std::vector<uint16_t> rowOffsetScratch;
+    
+    //The header and frame table of the GRP being loaded
+    grpImageHeader parsedHeader;
+    
+    //The imageFrames position of each frame header, -1 for a duplicate
+    std::vector<int> framePositions;
+    
+    //The order the frames were decoded in
+    std::vector<grpFrameLayout> frameLayout;
+    
+    //The contents of the last file given to LoadImage
+    std::vector<char> fileBuffer;
+    
+    //How the frames of the following loads are kept
+    GRPFrameStorage frameStorage;
+    
+    //Build the span programs of the frames of the following loads
+    bool buildSpanPrograms;
+    bool buildCollisionMasks;
+    
     //The palette that will be used during conversion
     ColorPalette *currentPalette;
     
     
+    //Runtime counters
+    grpImageStatistics imageStatistics;
+    
     //GRPimage Header
     uint16_t numberOfFrames;
     uint16_t maxImageWidth;
@@ -0,0 +1,505 @@
+#include "GRPRenderer.hpp"
+#include "../GRPTrace/GRPTrace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+//Seconds passed since startTime, used by the statistics timers
+static double GetElapsedSeconds(std::chrono::steady_clock::time_point startTime)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+//The color written for frameColor over targetColor
+static inline uint8_t BlendPixel(uint8_t frameColor, uint8_t targetColor, const uint8_t *remapTable, const uint8_t *blendTable)
+{
+    if(remapTable != NULL)
+    {
+        frameColor = remapTable[frameColor];
+    }
+    if(blendTable != NULL)
+    {
+        return blendTable[(targetColor * 256) + frameColor];
+    }
+    return frameColor;
+}
+
+//Two commands draw the same pixels when every field matches
+static bool SameDrawCommand(const grpQueuedDrawCommand &firstCommand, const grpQueuedDrawCommand &secondCommand)
+{
+    return firstCommand.drawFrame == secondCommand.drawFrame &&
+           firstCommand.drawCommand.sourceImage == secondCommand.drawCommand.sourceImage &&
+           firstCommand.drawCommand.frameNumber == secondCommand.drawCommand.frameNumber &&
+           firstCommand.drawCommand.xPosition == secondCommand.drawCommand.xPosition &&
+           firstCommand.drawCommand.yPosition == secondCommand.drawCommand.yPosition &&
+           firstCommand.drawCommand.flipHorizontal == secondCommand.drawCommand.flipHorizontal &&
+           firstCommand.drawCommand.remapTable == secondCommand.drawCommand.remapTable &&
+           firstCommand.drawCommand.blendTable == secondCommand.drawCommand.blendTable;
+}
+
+GRPRenderer::GRPRenderer(int numberOfThreads)
+{
+    tileWidth = DEFAULTRENDERTILESIZE;
+    tileHeight = DEFAULTRENDERTILESIZE;
+    tileColumns = 0;
+    tileRows = 0;
+    targetSurface = NULL;
+    targetWidth = 0;
+    targetHeight = 0;
+    targetPitch = 0;
+    backgroundSurface = NULL;
+    backgroundPitch = 0;
+    fullRedrawNeeded = true;
+    workGeneration = 0;
+    busyWorkers = 0;
+    stopWorkers = false;
+    nextActiveTile = 0;
+    ResetStatistics();
+    
+    if(numberOfThreads <= 0)
+    {
+        numberOfThreads = std::max(1, (int) std::thread::hardware_concurrency());
+    }
+    
+    //The thread calling Render draws tiles too
+    for(int currentThread = 1; currentThread < numberOfThreads; currentThread++)
+    {
+        workerThreads.push_back(std::thread(&GRPRenderer::WorkerThreadLoop, this));
+    }
+}
+
+GRPRenderer::~GRPRenderer()
+{
+    {
+        std::lock_guard<std::mutex> workLock(workMutex);
+        stopWorkers = true;
+    }
+    workReady.notify_all();
+    for(std::vector<std::thread>::iterator currentThread = workerThreads.begin(); currentThread != workerThreads.end(); currentThread++)
+    {
+        currentThread->join();
+    }
+}
+
+int GRPRenderer::GetNumberOfThreads() const
+{
+    return workerThreads.size() + 1;
+}
+
+void GRPRenderer::SetTileSize(int tileWidth, int tileHeight)
+{
+    if(tileWidth <= 0 || tileHeight <= 0)
+    {
+        GRPRendererInvalidTileSize invalidTileSize;
+        invalidTileSize.SetErrorMessage("Render tiles must be at least one pixel");
+        throw invalidTileSize;
+    }
+    this->tileWidth = tileWidth;
+    this->tileHeight = tileHeight;
+    fullRedrawNeeded = true;
+}
+
+void GRPRenderer::AddDrawCommand(const grpDrawCommand &drawCommand)
+{
+    if(drawCommand.sourceImage == NULL)
+    {
+        GRPRendererInvalidDrawCommand invalidCommand;
+        invalidCommand.SetErrorMessage("A draw command needs a GRPImage");
+        throw invalidCommand;
+    }
+    GRPFrame *drawFrame = drawCommand.sourceImage->GetFrame(drawCommand.frameNumber);
+    
+    //Built once here so the tile threads only read the frames
+    if(!drawFrame->HasSpanProgram())
+    {
+        drawFrame->BuildSpanProgram();
+    }
+    
+    grpQueuedDrawCommand queuedCommand;
+    queuedCommand.drawCommand = drawCommand;
+    queuedCommand.drawFrame = drawFrame;
+    if(drawCommand.flipHorizontal)
+    {
+        queuedCommand.frameLeft = drawCommand.xPosition + drawCommand.sourceImage->getMaxImageWidth() - drawFrame->GetXOffset() - drawFrame->GetImageWidth();
+    }
+    else
+    {
+        queuedCommand.frameLeft = drawCommand.xPosition + drawFrame->GetXOffset();
+    }
+    queuedCommand.frameTop = drawCommand.yPosition + drawFrame->GetYOffset();
+    queuedCommand.frameRight = queuedCommand.frameLeft + drawFrame->GetImageWidth();
+    queuedCommand.frameBottom = queuedCommand.frameTop + drawFrame->GetImageHeight();
+    drawCommands.push_back(queuedCommand);
+}
+
+void GRPRenderer::ClearDrawCommands()
+{
+    drawCommands.clear();
+}
+
+size_t GRPRenderer::GetNumberOfDrawCommands() const
+{
+    return drawCommands.size();
+}
+
+void GRPRenderer::Render(uint8_t *targetSurface, int targetWidth, int targetHeight, int targetPitch)
+{
+    GRPTRACESCOPE("GRPRenderer::Render");
+    if(targetSurface == NULL || targetWidth <= 0 || targetHeight <= 0 || targetPitch < targetWidth)
+    {
+        GRPRendererInvalidTarget invalidTarget;
+        invalidTarget.SetErrorMessage("Invalid render target surface");
+        throw invalidTarget;
+    }
+    std::chrono::steady_clock::time_point renderStart = std::chrono::steady_clock::now();
+    this->targetSurface = targetSurface;
+    this->targetWidth = targetWidth;
+    this->targetHeight = targetHeight;
+    this->targetPitch = targetPitch;
+    backgroundSurface = NULL;
+    
+    //The surface no longer matches what RenderChanges last drew
+    fullRedrawNeeded = true;
+    
+    BinDrawCommands();
+    rendererStatistics.binningSeconds += GetElapsedSeconds(renderStart);
+    
+    DrawTilesInParallel();
+    
+    rendererStatistics.framesRendered++;
+    rendererStatistics.tilesDrawn += activeTiles.size();
+    rendererStatistics.renderSeconds += GetElapsedSeconds(renderStart);
+}
+
+void GRPRenderer::RenderChanges(uint8_t *targetSurface, int targetWidth, int targetHeight, int targetPitch, const uint8_t *backgroundSurface, int backgroundPitch)
+{
+    GRPTRACESCOPE("GRPRenderer::RenderChanges");
+    if(targetSurface == NULL || targetWidth <= 0 || targetHeight <= 0 || targetPitch < targetWidth || backgroundSurface == NULL || backgroundPitch < targetWidth)
+    {
+        GRPRendererInvalidTarget invalidTarget;
+        invalidTarget.SetErrorMessage("Invalid render target or background surface");
+        throw invalidTarget;
+    }
+    std::chrono::steady_clock::time_point renderStart = std::chrono::steady_clock::now();
+    if(targetSurface != this->targetSurface || targetWidth != this->targetWidth || targetHeight != this->targetHeight ||
+       targetPitch != this->targetPitch || backgroundSurface != this->backgroundSurface || backgroundPitch != this->backgroundPitch)
+    {
+        fullRedrawNeeded = true;
+    }
+    this->targetSurface = targetSurface;
+    this->targetWidth = targetWidth;
+    this->targetHeight = targetHeight;
+    this->targetPitch = targetPitch;
+    this->backgroundSurface = backgroundSurface;
+    this->backgroundPitch = backgroundPitch;
+    
+    BinDrawCommands();
+    
+    //Commands are matched up by position in the list, a command that
+    //changed dirties its old and its new area
+    dirtyTiles.assign(tileCommands.size(), fullRedrawNeeded ? 1 : 0);
+    if(!fullRedrawNeeded)
+    {
+        size_t commonCommands = std::min(drawCommands.size(), previousDrawCommands.size());
+        for(size_t currentCommand = 0; currentCommand < commonCommands; currentCommand++)
+        {
+            if(!SameDrawCommand(drawCommands[currentCommand], previousDrawCommands[currentCommand]))
+            {
+                MarkDirtyTiles(previousDrawCommands[currentCommand]);
+                MarkDirtyTiles(drawCommands[currentCommand]);
+            }
+        }
+        for(size_t currentCommand = commonCommands; currentCommand < previousDrawCommands.size(); currentCommand++)
+        {
+            MarkDirtyTiles(previousDrawCommands[currentCommand]);
+        }
+        for(size_t currentCommand = commonCommands; currentCommand < drawCommands.size(); currentCommand++)
+        {
+            MarkDirtyTiles(drawCommands[currentCommand]);
+        }
+    }
+    
+    //Only the dirty tiles are drawn, empty ones still get their background
+    activeTiles.clear();
+    dirtyRectangles.clear();
+    for(int currentTileRow = 0; currentTileRow < tileRows; currentTileRow++)
+    {
+        for(int currentTileColumn = 0; currentTileColumn < tileColumns; currentTileColumn++)
+        {
+            int currentTile = (currentTileRow * tileColumns) + currentTileColumn;
+            if(!dirtyTiles[currentTile])
+            {
+                continue;
+            }
+            activeTiles.push_back(currentTile);
+            
+            //Extend the rectangle of the tile to the left when it touches it
+            int tileLeft = currentTileColumn * tileWidth;
+            int tileTop = currentTileRow * tileHeight;
+            int tileRight = std::min(tileLeft + tileWidth, targetWidth);
+            if(currentTileColumn > 0 && dirtyTiles[currentTile - 1])
+            {
+                dirtyRectangles.back().width = tileRight - dirtyRectangles.back().xPosition;
+                continue;
+            }
+            grpDirtyRectangle dirtyRectangle = {tileLeft, tileTop, tileRight - tileLeft, std::min(tileHeight, targetHeight - tileTop)};
+            dirtyRectangles.push_back(dirtyRectangle);
+        }
+    }
+    rendererStatistics.binningSeconds += GetElapsedSeconds(renderStart);
+    
+    DrawTilesInParallel();
+    
+    previousDrawCommands.assign(drawCommands.begin(), drawCommands.end());
+    fullRedrawNeeded = false;
+    rendererStatistics.framesRendered++;
+    rendererStatistics.tilesDrawn += activeTiles.size();
+    rendererStatistics.tilesSkipped += tileCommands.size() - activeTiles.size();
+    rendererStatistics.renderSeconds += GetElapsedSeconds(renderStart);
+}
+
+void GRPRenderer::InvalidateAll()
+{
+    fullRedrawNeeded = true;
+}
+
+const std::vector<grpDirtyRectangle> &GRPRenderer::GetDirtyRectangles() const
+{
+    return dirtyRectangles;
+}
+
+void GRPRenderer::MarkDirtyTiles(const grpQueuedDrawCommand &queuedCommand)
+{
+    int drawLeft = std::max(queuedCommand.frameLeft, 0);
+    int drawTop = std::max(queuedCommand.frameTop, 0);
+    int drawRight = std::min(queuedCommand.frameRight, targetWidth);
+    int drawBottom = std::min(queuedCommand.frameBottom, targetHeight);
+    if(drawLeft >= drawRight || drawTop >= drawBottom)
+    {
+        return;
+    }
+    for(int currentTileRow = drawTop / tileHeight; currentTileRow <= (drawBottom - 1) / tileHeight; currentTileRow++)
+    {
+        for(int currentTileColumn = drawLeft / tileWidth; currentTileColumn <= (drawRight - 1) / tileWidth; currentTileColumn++)
+        {
+            dirtyTiles[(currentTileRow * tileColumns) + currentTileColumn] = 1;
+        }
+    }
+}
+
+void GRPRenderer::DrawTilesInParallel()
+{
+    if(activeTiles.empty())
+    {
+        return;
+    }
+    for(std::vector<uint32_t>::iterator currentTile = activeTiles.begin(); currentTile != activeTiles.end(); currentTile++)
+    {
+        rendererStatistics.tileCommandsDrawn += tileCommands[*currentTile].size();
+    }
+    nextActiveTile = 0;
+    if(!workerThreads.empty())
+    {
+        {
+            std::lock_guard<std::mutex> workLock(workMutex);
+            workGeneration++;
+            busyWorkers = workerThreads.size();
+        }
+        workReady.notify_all();
+    }
+    DrawActiveTiles();
+    if(!workerThreads.empty())
+    {
+        std::unique_lock<std::mutex> workLock(workMutex);
+        workFinished.wait(workLock, [this](){ return busyWorkers == 0; });
+    }
+}
+
+void GRPRenderer::BinDrawCommands()
+{
+    GRPTRACESCOPE("GRPRenderer::BinDrawCommands");
+    tileColumns = (targetWidth + tileWidth - 1) / tileWidth;
+    tileRows = (targetHeight + tileHeight - 1) / tileHeight;
+    tileCommands.resize(tileColumns * tileRows);
+    for(std::vector<std::vector<uint32_t> >::iterator currentTile = tileCommands.begin(); currentTile != tileCommands.end(); currentTile++)
+    {
+        currentTile->clear();
+    }
+    
+    //Commands are appended in order so every tile keeps painter's order
+    for(size_t currentCommand = 0; currentCommand < drawCommands.size(); currentCommand++)
+    {
+        const grpQueuedDrawCommand &queuedCommand = drawCommands[currentCommand];
+        int drawLeft = std::max(queuedCommand.frameLeft, 0);
+        int drawTop = std::max(queuedCommand.frameTop, 0);
+        int drawRight = std::min(queuedCommand.frameRight, targetWidth);
+        int drawBottom = std::min(queuedCommand.frameBottom, targetHeight);
+        if(drawLeft >= drawRight || drawTop >= drawBottom)
+        {
+            continue;
+        }
+        for(int currentTileRow = drawTop / tileHeight; currentTileRow <= (drawBottom - 1) / tileHeight; currentTileRow++)
+        {
+            for(int currentTileColumn = drawLeft / tileWidth; currentTileColumn <= (drawRight - 1) / tileWidth; currentTileColumn++)
+            {
+                tileCommands[(currentTileRow * tileColumns) + currentTileColumn].push_back(currentCommand);
+            }
+        }
+    }
+    
+    activeTiles.clear();
+    for(size_t currentTile = 0; currentTile < tileCommands.size(); currentTile++)
+    {
+        if(!tileCommands[currentTile].empty())
+        {
+            activeTiles.push_back(currentTile);
+        }
+    }
+}
+
+void GRPRenderer::DrawActiveTiles()
+{
+    //Tiles never overlap, so the threads never write the same pixels
+    for(size_t currentActiveTile = nextActiveTile++; currentActiveTile < activeTiles.size(); currentActiveTile = nextActiveTile++)
+    {
+        int currentTile = activeTiles[currentActiveTile];
+        int clipLeft = (currentTile % tileColumns) * tileWidth;
+        int clipTop = (currentTile / tileColumns) * tileHeight;
+        int clipRight = std::min(clipLeft + tileWidth, targetWidth);
+        int clipBottom = std::min(clipTop + tileHeight, targetHeight);
+        if(backgroundSurface != NULL)
+        {
+            for(int currentRow = clipTop; currentRow < clipBottom; currentRow++)
+            {
+                memcpy(targetSurface + ((size_t) currentRow * targetPitch) + clipLeft, backgroundSurface + ((size_t) currentRow * backgroundPitch) + clipLeft, clipRight - clipLeft);
+            }
+        }
+        
+        const std::vector<uint32_t> &currentTileCommands = tileCommands[currentTile];
+        for(std::vector<uint32_t>::const_iterator currentCommand = currentTileCommands.begin(); currentCommand != currentTileCommands.end(); currentCommand++)
+        {
+            DrawCommandRows(drawCommands[*currentCommand], clipLeft, clipTop, clipRight, clipBottom);
+        }
+    }
+}
+
+void GRPRenderer::DrawCommandRows(const grpQueuedDrawCommand &queuedCommand, int clipLeft, int clipTop, int clipRight, int clipBottom)
+{
+    GRPFrame *drawFrame = queuedCommand.drawFrame;
+    const grpSpanRow *spanRows = drawFrame->GetSpanRows().data();
+    const grpCopySpan *copySpans = drawFrame->GetCopySpans().data();
+    const grpFillSpan *fillSpans = drawFrame->GetFillSpans().data();
+    const uint8_t *spanPixels = drawFrame->GetSpanPixels().data();
+    
+    bool flipHorizontal = queuedCommand.drawCommand.flipHorizontal;
+    const uint8_t *remapTable = queuedCommand.drawCommand.remapTable;
+    const uint8_t *blendTable = queuedCommand.drawCommand.blendTable;
+    
+    //Without a flip or tables the spans are plain memcpy/memset
+    bool plainCopy = !flipHorizontal && remapTable == NULL && blendTable == NULL;
+    int frameWidth = queuedCommand.frameRight - queuedCommand.frameLeft;
+    
+    int firstRow = std::max(clipTop, queuedCommand.frameTop);
+    int lastRow = std::min(clipBottom, queuedCommand.frameBottom);
+    for(int currentRow = firstRow; currentRow < lastRow; currentRow++)
+    {
+        int frameRow = currentRow - queuedCommand.frameTop;
+        uint8_t *targetRow = targetSurface + ((size_t) currentRow * targetPitch);
+        
+        const uint8_t *rowPixels = spanPixels + spanRows[frameRow].firstPixel;
+        for(uint32_t currentSpan = spanRows[frameRow].firstCopySpan; currentSpan < spanRows[frameRow + 1].firstCopySpan; currentSpan++)
+        {
+            int spanLength = copySpans[currentSpan].spanLength;
+            const uint8_t *sourcePixels = rowPixels;
+            rowPixels += spanLength;
+            
+            //The target column of the leftmost pixel the span covers
+            int spanLeft = queuedCommand.frameLeft + (flipHorizontal ? (frameWidth - copySpans[currentSpan].xPosition - spanLength) : copySpans[currentSpan].xPosition);
+            int drawLeft = std::max(spanLeft, clipLeft);
+            int drawRight = std::min(spanLeft + spanLength, clipRight);
+            if(drawLeft >= drawRight)
+            {
+                continue;
+            }
+            if(plainCopy)
+            {
+                memcpy(targetRow + drawLeft, sourcePixels + (drawLeft - spanLeft), drawRight - drawLeft);
+                continue;
+            }
+            for(int currentColumn = drawLeft; currentColumn < drawRight; currentColumn++)
+            {
+                int sourceIndex = flipHorizontal ? (spanLeft + spanLength - 1 - currentColumn) : (currentColumn - spanLeft);
+                targetRow[currentColumn] = BlendPixel(sourcePixels[sourceIndex], targetRow[currentColumn], remapTable, blendTable);
+            }
+        }
+        
+        for(uint32_t currentSpan = spanRows[frameRow].firstFillSpan; currentSpan < spanRows[frameRow + 1].firstFillSpan; currentSpan++)
+        {
+            int spanLength = fillSpans[currentSpan].spanLength;
+            int spanLeft = queuedCommand.frameLeft + (flipHorizontal ? (frameWidth - fillSpans[currentSpan].xPosition - spanLength) : fillSpans[currentSpan].xPosition);
+            int drawLeft = std::max(spanLeft, clipLeft);
+            int drawRight = std::min(spanLeft + spanLength, clipRight);
+            if(drawLeft >= drawRight)
+            {
+                continue;
+            }
+            uint8_t fillColor = fillSpans[currentSpan].fillColor;
+            if(remapTable != NULL)
+            {
+                fillColor = remapTable[fillColor];
+            }
+            if(blendTable == NULL)
+            {
+                memset(targetRow + drawLeft, fillColor, drawRight - drawLeft);
+                continue;
+            }
+            for(int currentColumn = drawLeft; currentColumn < drawRight; currentColumn++)
+            {
+                targetRow[currentColumn] = BlendPixel(fillColor, targetRow[currentColumn], NULL, blendTable);
+            }
+        }
+    }
+}
+
+void GRPRenderer::WorkerThreadLoop()
+{
+    uint64_t finishedGeneration = 0;
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> workLock(workMutex);
+            workReady.wait(workLock, [&](){ return stopWorkers || workGeneration != finishedGeneration; });
+            if(stopWorkers)
+            {
+                return;
+            }
+            finishedGeneration = workGeneration;
+        }
+        
+        DrawActiveTiles();
+        
+        {
+            std::lock_guard<std::mutex> workLock(workMutex);
+            busyWorkers--;
+            if(busyWorkers == 0)
+            {
+                workFinished.notify_one();
+            }
+        }
+    }
+}
+
+grpRendererStatistics GRPRenderer::GetStatistics() const
+{
+    return rendererStatistics;
+}
+
+void GRPRenderer::ResetStatistics()
+{
+    rendererStatistics.framesRendered = 0;
+    rendererStatistics.tilesDrawn = 0;
+    rendererStatistics.tileCommandsDrawn = 0;
+    rendererStatistics.tilesSkipped = 0;
+    rendererStatistics.renderSeconds = 0;
+    rendererStatistics.binningSeconds = 0;
+}
@@ -0,0 +1,265 @@
+#ifndef GRPRenderer_Header
+#define GRPRenderer_Header
+
+/*!GRPRenderer Sprite batch renderer
+ *  \brief     Draws batches of GRP frames onto an 8bpp surface
+ *  \details   Draw commands are queued in painter's order, binned into
+ *              screen tiles and the tiles are drawn in parallel by a pool
+ *              of worker threads. Every tile draws its commands in the
+ *              order they were added, so overlapping sprites come out the
+ *              same as drawing the commands one after the other. Frames
+ *              are drawn from their span programs (see
+ *              GRPFrame::BuildSpanProgram).
+ *  \author    libgrp Authors
+ *  \version   1.0.0
+ *  \date      2013 - Present
+ *  \copyright LGPLv2
+ */
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "../GRPImage/GRPImage.hpp"
+#include "../Exceptions/GRPRenderer/GRPRendererException.hpp"
+
+//The default width and height of a render tile in pixels
+#define DEFAULTRENDERTILESIZE 64
+
+//One frame to draw, see GRPRenderer::AddDrawCommand
+struct grpDrawCommand
+{
+    //The image and frame to draw
+    GRPImage *sourceImage;
+    int frameNumber;
+    
+    //The top left corner of the image's (getMaxImageWidth x getMaxImageHeight)
+    //box on the target, the frame is drawn at its x/y offset inside it
+    //(the same placement as GRPImage::ConvertFrameToRGBA)
+    int xPosition;
+    int yPosition;
+    
+    //Mirror the image box left to right
+    bool flipHorizontal;
+    
+    //Optional 256 entry table applied to the frame colors first (for
+    //example the player colors), NULL to draw the colors as they are
+    const uint8_t *remapTable;
+    
+    //Optional 256*256 table indexed [targetColor * 256 + frameColor] giving
+    //the color to write (for example ColorPalette::GetTransparentColorsTable),
+    //NULL to overwrite the target
+    const uint8_t *blendTable;
+};
+
+//A queued draw command with its frame and target rectangle
+struct grpQueuedDrawCommand
+{
+    grpDrawCommand drawCommand;
+    GRPFrame *drawFrame;
+    
+    //Where the frame lands on the target, [frameLeft, frameRight) by
+    //[frameTop, frameBottom), not clipped to the target
+    int frameLeft;
+    int frameTop;
+    int frameRight;
+    int frameBottom;
+};
+
+//A target area redrawn by GRPRenderer::RenderChanges
+struct grpDirtyRectangle
+{
+    int xPosition;
+    int yPosition;
+    int width;
+    int height;
+};
+
+//Runtime counters of a GRPRenderer, see GRPRenderer::GetStatistics
+struct grpRendererStatistics
+{
+    //Render calls, the tiles drawn and the draw commands drawn into them
+    //(a command drawn into two tiles counts twice)
+    uint64_t framesRendered;
+    uint64_t tilesDrawn;
+    uint64_t tileCommandsDrawn;
+    
+    //Tiles RenderChanges left alone as nothing in them changed
+    uint64_t tilesSkipped;
+    
+    //Whole Render calls and the binning part of them
+    double renderSeconds;
+    double binningSeconds;
+};
+
+class GRPRenderer
+{
+public:
+    //!Create a renderer and start its worker threads
+    /*! \param[in] numberOfThreads The threads drawing tiles, the calling
+     *      thread included (0 uses one per hardware thread)
+     * \note NA*/
+    GRPRenderer(int numberOfThreads = 0);
+    
+    //!Stop the worker threads
+    ~GRPRenderer();
+    
+    //!Get the number of threads drawing tiles, the calling thread included
+    int GetNumberOfThreads() const;
+    
+    //!Set the size of the screen tiles
+    /*! Smaller tiles split the work more evenly between the threads,
+     *  larger tiles bin faster.
+     * \param[in] tileWidth The tile width in pixels
+     * \param[in] tileHeight The tile height in pixels
+     * \throws GRPRendererInvalidTileSize
+     * \note NA*/
+    void SetTileSize(int tileWidth, int tileHeight);
+    
+    //!Queue a frame to be drawn by the next Render
+    /*! Commands are drawn in the order they are added. A frame without a
+     *  span program gets one built here.
+     * \pre The image stays loaded and unchanged until the commands are cleared
+     * \param[in] drawCommand The frame to draw
+     * \throws GRPRendererInvalidDrawCommand
+     * \throws GRPImageInvalidFrameNumber
+     * \throws GRPFrameNoCompressedData
+     * \note NA*/
+    void AddDrawCommand(const grpDrawCommand &drawCommand);
+    
+    //!Remove every queued draw command
+    void ClearDrawCommands();
+    
+    //!Get the number of queued draw commands
+    size_t GetNumberOfDrawCommands() const;
+    
+    //!Draw the queued commands onto an 8bpp surface
+    /*! Only the queued frames are drawn, the rest of the surface is left as
+     *  it is (draw the background first). The commands stay queued.
+     * \param[in,out] targetSurface At least targetPitch * targetHeight palette indices
+     * \param[in] targetWidth The surface width in pixels
+     * \param[in] targetHeight The surface height in pixels
+     * \param[in] targetPitch The bytes per surface row (>= targetWidth)
+     * \throws GRPRendererInvalidTarget
+     * \note NA*/
+    void Render(uint8_t *targetSurface, int targetWidth, int targetHeight, int targetPitch);
+    
+    //!Redraw only the parts of the surface that changed since the last call
+    /*! Compares the queued commands with the ones of the previous
+     *  RenderChanges (command by command, in order). The tiles touched by a
+     *  command that was added, removed, moved or changed in any field, at
+     *  its old and its new place, are refilled from backgroundSurface and
+     *  every command touching them is drawn again. The first call, or a
+     *  call after Render, SetTileSize, InvalidateAll or with another
+     *  surface or size, redraws everything.
+     * \pre targetSurface holds what the previous RenderChanges drew
+     * \post GetDirtyRectangles lists the redrawn areas
+     * \param[in,out] targetSurface At least targetPitch * targetHeight palette indices
+     * \param[in] targetWidth The surface width in pixels
+     * \param[in] targetHeight The surface height in pixels
+     * \param[in] targetPitch The bytes per surface row (>= targetWidth)
+     * \param[in] backgroundSurface The surface without any sprites (the terrain), same size as the target
+     * \param[in] backgroundPitch The bytes per background row (>= targetWidth)
+     * \throws GRPRendererInvalidTarget
+     * \note Changes inside a frame or table (a reload or remap) are not
+     *       seen, call InvalidateAll after them*/
+    void RenderChanges(uint8_t *targetSurface, int targetWidth, int targetHeight, int targetPitch, const uint8_t *backgroundSurface, int backgroundPitch);
+    
+    //!Make the next RenderChanges redraw the whole surface
+    void InvalidateAll();
+    
+    //!Get the areas redrawn by the last RenderChanges
+    /*! Dirty tiles next to each other in a tile row are merged, the
+     *  rectangles do not overlap and are clipped to the target.
+     * \returns The redrawn rectangles, valid until the next RenderChanges
+     * \note NA*/
+    const std::vector<grpDirtyRectangle> &GetDirtyRectangles() const;
+    
+    //!Get the runtime counters of the renderer
+    grpRendererStatistics GetStatistics() const;
+    
+    //!Set all the runtime counters back to zero
+    void ResetStatistics();
+
+protected:
+    //!Sort the queued commands into the tiles they touch
+    /*! \post tileCommands lists each tile's commands in painter's order,
+     *       activeTiles the tiles with at least one command
+     * \note NA*/
+    void BinDrawCommands();
+    
+    //!Draw the tiles in activeTiles with every thread
+    void DrawTilesInParallel();
+    
+    //!Draw tiles from activeTiles until none are left, run by every thread
+    /*! Tiles are refilled from backgroundSurface first when it is set.
+     * \note NA*/
+    void DrawActiveTiles();
+    
+    //!Mark the tiles a queued command touches in dirtyTiles
+    void MarkDirtyTiles(const grpQueuedDrawCommand &queuedCommand);
+    
+    //!Draw the part of a queued command inside a clip rectangle
+    /*! \param[in] queuedCommand The command to draw
+     * \param[in] clipLeft The first target column to draw
+     * \param[in] clipTop The first target row to draw
+     * \param[in] clipRight One past the last target column to draw
+     * \param[in] clipBottom One past the last target row to draw
+     * \note NA*/
+    void DrawCommandRows(const grpQueuedDrawCommand &queuedCommand, int clipLeft, int clipTop, int clipRight, int clipBottom);
+    
+    //!Wait for Render to hand out tiles and draw them, until stopped
+    void WorkerThreadLoop();
+
+private:
+    //The worker threads are owned by the renderer
+    GRPRenderer(const GRPRenderer &) = delete;
+    GRPRenderer &operator=(const GRPRenderer &) = delete;
+    
+    //The queued commands in painter's order
+    std::vector<grpQueuedDrawCommand> drawCommands;
+    
+    //The commands touching each tile (row major) and the tiles with any,
+    //kept between renders so binning reuses their storage
+    std::vector<std::vector<uint32_t> > tileCommands;
+    std::vector<uint32_t> activeTiles;
+    int tileWidth;
+    int tileHeight;
+    int tileColumns;
+    int tileRows;
+    
+    //The surface of the running Render
+    uint8_t *targetSurface;
+    int targetWidth;
+    int targetHeight;
+    int targetPitch;
+    
+    //The background tiles are refilled from, NULL for Render
+    const uint8_t *backgroundSurface;
+    int backgroundPitch;
+    
+    //The commands drawn by the previous RenderChanges and the tiles and
+    //areas the last one redrew. fullRedrawNeeded is set when the target
+    //may no longer hold what previousDrawCommands drew.
+    std::vector<grpQueuedDrawCommand> previousDrawCommands;
+    std::vector<uint8_t> dirtyTiles;
+    std::vector<grpDirtyRectangle> dirtyRectangles;
+    bool fullRedrawNeeded;
+    
+    //The worker threads wait for workGeneration to change, then draw
+    //tiles from nextActiveTile on
+    std::vector<std::thread> workerThreads;
+    std::mutex workMutex;
+    std::condition_variable workReady;
+    std::condition_variable workFinished;
+    uint64_t workGeneration;
+    int busyWorkers;
+    bool stopWorkers;
+    std::atomic<size_t> nextActiveTile;
+    
+    //Runtime counters
+    grpRendererStatistics rendererStatistics;
+};
+
+#endif
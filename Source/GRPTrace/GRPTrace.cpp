@@ -0,0 +1,115 @@
+#include "GRPTrace.hpp"
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+
+//The spans of one thread, only the owning thread writes to it
+struct traceThreadBuffer
+{
+    int threadNumber;
+    uint64_t eventsRecorded;
+    std::vector<traceEvent> traceEvents;
+};
+
+//Every thread buffer ever created, a buffer outlives its thread so the
+//spans of finished worker threads can still be written out.
+static std::mutex traceBufferRegistryMutex;
+static std::vector<std::shared_ptr<traceThreadBuffer> > traceBufferRegistry;
+
+//All span times are relative to the library being loaded
+static const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+
+//Chrome trace times are microseconds, keep the nanosecond digits
+static void WriteMicroseconds(std::ostream &outputStream, uint64_t nanoseconds)
+{
+    outputStream << (nanoseconds / 1000) << '.' << std::setw(3) << std::setfill('0') << (nanoseconds % 1000) << std::setfill(' ');
+}
+
+static traceThreadBuffer *GetThreadBuffer()
+{
+    thread_local std::shared_ptr<traceThreadBuffer> threadBuffer;
+    if(!threadBuffer)
+    {
+        threadBuffer = std::make_shared<traceThreadBuffer>();
+        threadBuffer->eventsRecorded = 0;
+        threadBuffer->traceEvents.resize(TRACEEVENTSPERTHREAD);
+        
+        std::lock_guard<std::mutex> registryLock(traceBufferRegistryMutex);
+        threadBuffer->threadNumber = traceBufferRegistry.size() + 1;
+        traceBufferRegistry.push_back(threadBuffer);
+    }
+    return threadBuffer.get();
+}
+
+void GRPTrace::RecordSpan(const char *eventName, std::chrono::steady_clock::time_point startTime, std::chrono::steady_clock::time_point endTime)
+{
+    traceThreadBuffer *threadBuffer = GetThreadBuffer();
+    
+    traceEvent &currentEvent = threadBuffer->traceEvents[threadBuffer->eventsRecorded % TRACEEVENTSPERTHREAD];
+    currentEvent.eventName = eventName;
+    currentEvent.startNanoseconds = (startTime > traceEpoch) ? std::chrono::duration_cast<std::chrono::nanoseconds>(startTime - traceEpoch).count() : 0;
+    currentEvent.durationNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+    threadBuffer->eventsRecorded++;
+}
+
+void GRPTrace::WriteChromeTrace(std::ostream &outputStream)
+{
+    std::lock_guard<std::mutex> registryLock(traceBufferRegistryMutex);
+    bool firstEvent = true;
+    
+    outputStream << "{\"traceEvents\":[";
+    for(std::vector<std::shared_ptr<traceThreadBuffer> >::iterator currentBuffer = traceBufferRegistry.begin(); currentBuffer != traceBufferRegistry.end(); currentBuffer++)
+    {
+        //Once the ring wrapped only the newest TRACEEVENTSPERTHREAD spans are left
+        uint64_t firstEventNumber = 0;
+        if((*currentBuffer)->eventsRecorded > TRACEEVENTSPERTHREAD)
+        {
+            firstEventNumber = (*currentBuffer)->eventsRecorded - TRACEEVENTSPERTHREAD;
+        }
+        for(uint64_t currentEventNumber = firstEventNumber; currentEventNumber < (*currentBuffer)->eventsRecorded; currentEventNumber++)
+        {
+            const traceEvent &currentEvent = (*currentBuffer)->traceEvents[currentEventNumber % TRACEEVENTSPERTHREAD];
+            if(!firstEvent)
+            {
+                outputStream << ',';
+            }
+            firstEvent = false;
+            
+            //Complete ("X") events, times in microseconds
+            outputStream << "\n{\"name\":\"" << currentEvent.eventName << "\",\"cat\":\"libgrp\",\"ph\":\"X\",\"ts\":";
+            WriteMicroseconds(outputStream, currentEvent.startNanoseconds);
+            outputStream << ",\"dur\":";
+            WriteMicroseconds(outputStream, currentEvent.durationNanoseconds);
+            outputStream << ",\"pid\":1,\"tid\":" << (*currentBuffer)->threadNumber << '}';
+        }
+    }
+    outputStream << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+void GRPTrace::WriteChromeTrace(std::string outFilePath)
+{
+    std::ofstream outputFile(outFilePath.c_str());
+    outputFile.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+    WriteChromeTrace(outputFile);
+}
+
+void GRPTrace::ClearTrace()
+{
+    std::lock_guard<std::mutex> registryLock(traceBufferRegistryMutex);
+    for(std::vector<std::shared_ptr<traceThreadBuffer> >::iterator currentBuffer = traceBufferRegistry.begin(); currentBuffer != traceBufferRegistry.end(); currentBuffer++)
+    {
+        (*currentBuffer)->eventsRecorded = 0;
+    }
+}
+
+GRPTraceSpan::GRPTraceSpan(const char *spanName)
+{
+    eventName = spanName;
+    startTime = std::chrono::steady_clock::now();
+}
+
+GRPTraceSpan::~GRPTraceSpan()
+{
+    GRPTrace::RecordSpan(eventName, startTime, std::chrono::steady_clock::now());
+}
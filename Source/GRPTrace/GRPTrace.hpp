@@ -0,0 +1,91 @@
+#ifndef GRPTrace_Header
+#define GRPTrace_Header
+
+/*!GRPTrace Timeline tracing
+ *  \brief     Scoped trace spans exported in the Chrome trace event format
+ *  \details   Spans are recorded into a fixed size ring buffer owned by the
+ *              recording thread, so tracing never takes a lock or prints in
+ *              the middle of the decode loops. The spans are only compiled
+ *              into the library when the TRACING CMake option is on
+ *              (LIBGRP_TRACING=1), otherwise GRPTRACESCOPE expands to nothing.
+ *              The result can be opened with chrome://tracing or Perfetto.
+ *  \author    libgrp Authors
+ *  \version   1.0.0
+ *  \date      2013 - Present
+ *  \copyright LGPLv2
+ */
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <chrono>
+#include <inttypes.h>
+
+#ifndef LIBGRP_TRACING
+#define LIBGRP_TRACING 0
+#endif
+
+//The number of spans kept per thread, the oldest spans are overwritten
+#define TRACEEVENTSPERTHREAD 65536
+
+//Record a span from here to the end of the enclosing scope, spanName
+//must be a string literal (only the pointer is kept).
+#if LIBGRP_TRACING
+#define GRPTRACESCOPE(spanName) GRPTraceSpan currentTraceSpan(spanName)
+#else
+#define GRPTRACESCOPE(spanName)
+#endif
+
+//One finished span, times are nanoseconds since the trace epoch
+struct traceEvent
+{
+    const char *eventName;
+    uint64_t startNanoseconds;
+    uint64_t durationNanoseconds;
+};
+
+class GRPTrace
+{
+public:
+    //!Record a finished span for the calling thread
+    /*! \pre eventName must stay valid for the life of the program (a literal)
+     * \param[in] eventName The span name
+     * \param[in] startTime When the span began
+     * \param[in] endTime When the span ended
+     * \note Normally called by GRPTraceSpan*/
+    static void RecordSpan(const char *eventName, std::chrono::steady_clock::time_point startTime, std::chrono::steady_clock::time_point endTime);
+    
+    //!Write every recorded span as Chrome trace event JSON
+    /*! \pre The traced work should be idle, the thread buffers are read without locking
+     * \param[out] outputStream The stream to write the JSON to
+     * \note NA*/
+    static void WriteChromeTrace(std::ostream &outputStream);
+    
+    //!Write every recorded span to a Chrome trace event JSON file
+    /*! \param[in] outFilePath The output file path
+     * \throws std::ios_base::failure
+     * \note NA*/
+    static void WriteChromeTrace(std::string outFilePath);
+    
+    //!Forget every recorded span
+    /*! \pre The traced work should be idle
+     * \note NA*/
+    static void ClearTrace();
+};
+
+//Records the time between its construction and destruction
+class GRPTraceSpan
+{
+public:
+    GRPTraceSpan(const char *spanName);
+    ~GRPTraceSpan();
+    
+private:
+    GRPTraceSpan(const GRPTraceSpan &);
+    GRPTraceSpan &operator=(const GRPTraceSpan &);
+    
+    const char *eventName;
+    std::chrono::steady_clock::time_point startTime;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "MemoryArena.hpp"
+
+MemoryArena::MemoryArena(size_t minimumBlockSize)
+{
+    this->minimumBlockSize = minimumBlockSize;
+    blockPosition = 0;
+    bytesAllocated = 0;
+    bytesReserved = 0;
+}
+
+MemoryArena::~MemoryArena()
+{
+    Release();
+}
+
+void *MemoryArena::Allocate(size_t allocationSize, size_t allocationAlignment)
+{
+    if(!arenaBlocks.empty())
+    {
+        arenaBlock &currentBlock = arenaBlocks.back();
+        size_t alignedPosition = AlignedBlockPosition(currentBlock, blockPosition, allocationAlignment);
+        if(alignedPosition + allocationSize <= currentBlock.blockSize)
+        {
+            blockPosition = alignedPosition + allocationSize;
+            bytesAllocated += allocationSize;
+            return currentBlock.blockData + alignedPosition;
+        }
+    }
+    
+    //Start a new block, ::operator new memory is aligned for any type so
+    //only larger alignments need room to move the allocation up
+    size_t alignmentPadding = (allocationAlignment > alignof(std::max_align_t)) ? allocationAlignment - 1 : 0;
+    arenaBlock newBlock;
+    newBlock.blockSize = (allocationSize + alignmentPadding > minimumBlockSize) ? allocationSize + alignmentPadding : minimumBlockSize;
+    newBlock.blockData = static_cast<char *>(::operator new(newBlock.blockSize));
+    arenaBlocks.push_back(newBlock);
+    bytesReserved += newBlock.blockSize;
+    
+    size_t alignedPosition = AlignedBlockPosition(newBlock, 0, allocationAlignment);
+    blockPosition = alignedPosition + allocationSize;
+    bytesAllocated += allocationSize;
+    return newBlock.blockData + alignedPosition;
+}
+
+size_t MemoryArena::AlignedBlockPosition(const arenaBlock &targetBlock, size_t startPosition, size_t allocationAlignment)
+{
+    //The address is aligned, not the position, blocks are only aligned
+    //for std::max_align_t
+    uintptr_t startAddress = reinterpret_cast<uintptr_t>(targetBlock.blockData) + startPosition;
+    uintptr_t alignedAddress = (startAddress + allocationAlignment - 1) & ~(uintptr_t) (allocationAlignment - 1);
+    return startPosition + (alignedAddress - startAddress);
+}
+
+void MemoryArena::Reset()
+{
+    if(arenaBlocks.empty())
+    {
+        return;
+    }
+    
+    //Keep the largest block, the next load of a similar image fits in it
+    std::vector<arenaBlock>::iterator largestBlock = arenaBlocks.begin();
+    for(std::vector<arenaBlock>::iterator currentBlock = arenaBlocks.begin(); currentBlock != arenaBlocks.end(); currentBlock++)
+    {
+        if(currentBlock->blockSize > largestBlock->blockSize)
+        {
+            largestBlock = currentBlock;
+        }
+    }
+    arenaBlock keptBlock = *largestBlock;
+    for(std::vector<arenaBlock>::iterator currentBlock = arenaBlocks.begin(); currentBlock != arenaBlocks.end(); currentBlock++)
+    {
+        if(currentBlock->blockData != keptBlock.blockData)
+        {
+            ::operator delete(currentBlock->blockData);
+        }
+    }
+    arenaBlocks.clear();
+    arenaBlocks.push_back(keptBlock);
+    
+    blockPosition = 0;
+    bytesAllocated = 0;
+    bytesReserved = keptBlock.blockSize;
+}
+
+void MemoryArena::Reserve(size_t reservedSize)
+{
+    if(reservedSize == 0 || (!arenaBlocks.empty() && (arenaBlocks.back().blockSize - blockPosition) >= reservedSize))
+    {
+        return;
+    }
+    
+    //Nothing was handed out from the last block, replace it
+    if(!arenaBlocks.empty() && blockPosition == 0)
+    {
+        ::operator delete(arenaBlocks.back().blockData);
+        bytesReserved -= arenaBlocks.back().blockSize;
+        arenaBlocks.pop_back();
+    }
+    
+    arenaBlock newBlock;
+    newBlock.blockSize = (reservedSize > minimumBlockSize) ? reservedSize : minimumBlockSize;
+    newBlock.blockData = static_cast<char *>(::operator new(newBlock.blockSize));
+    arenaBlocks.push_back(newBlock);
+    bytesReserved += newBlock.blockSize;
+    blockPosition = 0;
+}
+
+void MemoryArena::Release()
+{
+    for(std::vector<arenaBlock>::iterator currentBlock = arenaBlocks.begin(); currentBlock != arenaBlocks.end(); currentBlock++)
+    {
+        ::operator delete(currentBlock->blockData);
+    }
+    arenaBlocks.clear();
+    blockPosition = 0;
+    bytesAllocated = 0;
+    bytesReserved = 0;
+}
+
+size_t MemoryArena::GetBytesAllocated() const
+{
+    return bytesAllocated;
+}
+
+size_t MemoryArena::GetBytesReserved() const
+{
+    return bytesReserved;
+}
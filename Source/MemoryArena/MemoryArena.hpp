@@ -0,0 +1,156 @@
+#ifndef MemoryArena_Header
+#define MemoryArena_Header
+
+/*!MemoryArena Region allocator
+ *  \brief     Hands out memory from a few large blocks
+ *  \details   Allocation is a pointer bump inside the current block, single
+ *              allocations are never freed; everything is released together
+ *              when the arena is reset or destroyed. A GRPImage keeps its
+ *              frames and pixel data in one, so loading an image is a few
+ *              large allocations and unloading it one release.
+ *              (std::pmr is C++17, libgrp builds as C++11, so ArenaAllocator
+ *              plays the part of a polymorphic_allocator.)
+ *  \author    libgrp Authors
+ *  \version   1.0.0
+ *  \date      2013 - Present
+ *  \copyright LGPLv2
+ */
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+//The size of a new arena block when the request is smaller
+#define DEFAULTARENABLOCKSIZE (64 * 1024)
+
+class MemoryArena
+{
+public:
+    //!Create an empty arena
+    /*! \param[in] minimumBlockSize The smallest block requested from the heap
+     * \note No memory is reserved until the first Allocate*/
+    MemoryArena(size_t minimumBlockSize = DEFAULTARENABLOCKSIZE);
+    
+    //!Releases every block
+    ~MemoryArena();
+    
+    //!Get memory from the arena
+    /*! \param[in] allocationSize The number of bytes needed
+     * \param[in] allocationAlignment The alignment needed (a power of 2)
+     * \returns Memory that stays valid until Reset or Release
+     * \throws std::bad_alloc
+     * \note NA*/
+    void *Allocate(size_t allocationSize, size_t allocationAlignment = alignof(std::max_align_t));
+    
+    //!Make all the memory available again
+    /*! Keeps the largest block for reuse and releases the rest.
+     * \pre No object allocated from the arena may still be used
+     * \note NA*/
+    void Reset();
+    
+    //!Make sure the next allocations can be served from one block
+    /*! Requests a block of at least reservedSize bytes unless the current
+     *  block already has that much left. An unused last block (after
+     *  Reset) is replaced rather than kept.
+     * \param[in] reservedSize The number of bytes that should fit
+     * \throws std::bad_alloc
+     * \note NA*/
+    void Reserve(size_t reservedSize);
+    
+    //!Give every block back to the heap
+    /*! \pre No object allocated from the arena may still be used
+     * \note NA*/
+    void Release();
+    
+    //!The bytes handed out since the last Reset/Release
+    size_t GetBytesAllocated() const;
+    
+    //!The bytes held from the heap
+    size_t GetBytesReserved() const;
+    
+private:
+    MemoryArena(const MemoryArena &);
+    MemoryArena &operator=(const MemoryArena &);
+    
+    struct arenaBlock
+    {
+        char *blockData;
+        size_t blockSize;
+    };
+    
+    //The first position at or after startPosition in targetBlock whose
+    //address has the alignment
+    static size_t AlignedBlockPosition(const arenaBlock &targetBlock, size_t startPosition, size_t allocationAlignment);
+    
+    //Every block held, the last one is being allocated from
+    std::vector<arenaBlock> arenaBlocks;
+    
+    //The next free byte of the last block
+    size_t blockPosition;
+    
+    size_t minimumBlockSize;
+    size_t bytesAllocated;
+    size_t bytesReserved;
+};
+
+//!A standard library allocator using a MemoryArena
+/*! Lets containers keep their storage in an arena, deallocation does
+ *  nothing as the arena frees everything at once. With no arena the
+ *  heap is used like std::allocator.*/
+template <typename T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+    
+    ArenaAllocator(MemoryArena *sourceArena = NULL) noexcept
+    {
+        allocationArena = sourceArena;
+    }
+    
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &otherAllocator) noexcept
+    {
+        allocationArena = otherAllocator.GetArena();
+    }
+    
+    T *allocate(size_t numberOfElements)
+    {
+        if(allocationArena == NULL)
+        {
+            return static_cast<T *>(::operator new(numberOfElements * sizeof(T)));
+        }
+        return static_cast<T *>(allocationArena->Allocate(numberOfElements * sizeof(T), alignof(T)));
+    }
+    
+    void deallocate(T *targetElements, size_t) noexcept
+    {
+        if(allocationArena == NULL)
+        {
+            ::operator delete(targetElements);
+        }
+    }
+    
+    MemoryArena *GetArena() const noexcept
+    {
+        return allocationArena;
+    }
+    
+private:
+    MemoryArena *allocationArena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &firstAllocator, const ArenaAllocator<U> &secondAllocator) noexcept
+{
+    return firstAllocator.GetArena() == secondAllocator.GetArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &firstAllocator, const ArenaAllocator<U> &secondAllocator) noexcept
+{
+    return firstAllocator.GetArena() != secondAllocator.GetArena();
+}
+
+#endif
@@ -20,7 +20,7 @@
  *  
  *  CMake Build Options
  *  ===================
- *  There are three parameters that can be modified.\n
+ *  There are six parameters that can be modified.\n
  *  1. VERBOSE - The amount of information outputted to the console
  *      while processing GRP files and ColorPalettes.\n
  *      DEFAULT = 0 Range = [1 - 5]\n
@@ -30,7 +30,16 @@
  *      be compiled and installed.\n To enable unit tests
  *      Add the cmake flag "-DUNITTESTS=on"\n\n
  *  3. SAMPLECODE - To compile the sample code.\n
- *      Add the cmake flag "-DSAMPLECODE=on"\n
+ *      Add the cmake flag "-DSAMPLECODE=on"\n\n
+ *  4. BENCHMARKS - Compile libgrpBenchmarks to time image loading, conversion
+ *      and ColorPalette table generation.\n
+ *      Add the cmake flag "-DBENCHMARKS=on"\n\n
+ *  5. TOOLS - Compile the GenerateGRP tool that writes seeded synthetic
+ *      GRP images for scale and stress testing.\n
+ *      Add the cmake flag "-DTOOLS=on"\n\n
+ *  6. TRACING - Record scoped trace spans (see GRPTrace) around loading,
+ *      decoding, table generation and export.\n
+ *      Add the cmake flag "-DTRACING=on"\n
  *      
  *  Sample Code
  *  ===========
@@ -57,6 +66,11 @@
 #include "GRPFrame/GRPFrame.hpp"
 #include "Exceptions/GRPException.hpp"
 
+#include "GRPRenderer/GRPRenderer.hpp"
+#include "Exceptions/GRPRenderer/GRPRendererException.hpp"
+
+#include "GRPTrace/GRPTrace.hpp"
+
 #include "ColorPalette/ColorPalette.hpp"
 #include "Exceptions/ColorPalette/ColorPaletteException.hpp"
 
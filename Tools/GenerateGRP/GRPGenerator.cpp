@@ -0,0 +1,203 @@
+#include "GRPGenerator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    //Small linear congruential generator, std::rand is not stable
+    //across platforms.
+    uint32_t NextRandom(uint32_t &randomState)
+    {
+        randomState = (randomState * 1664525u) + 1013904223u;
+        return randomState >> 8;
+    }
+    
+    //A value in [0.0, 1.0)
+    float NextRandomFraction(uint32_t &randomState)
+    {
+        return (NextRandom(randomState) & 0xFFFF) / 65536.0f;
+    }
+    
+    int NextRandomRange(uint32_t &randomState, int minimumValue, int maximumValue)
+    {
+        return minimumValue + (NextRandom(randomState) % (maximumValue - minimumValue + 1));
+    }
+    
+    //A geometrically distributed run length (at least 1)
+    int NextRunLength(uint32_t &randomState, float averageRunLength)
+    {
+        if(averageRunLength <= 1.0f)
+        {
+            return 1;
+        }
+        float continueChance = 1.0f - (1.0f / averageRunLength);
+        return 1 + (int) (log(1.0f - NextRandomFraction(randomState)) / log(continueChance));
+    }
+    
+    void AppendValue(std::vector<char> *outputImage, uint32_t value, int numberOfBytes)
+    {
+        for(int currentByte = 0; currentByte < numberOfBytes; currentByte++)
+        {
+            outputImage->push_back((char) ((value >> (8 * currentByte)) & 0xFF));
+        }
+    }
+    
+    void WriteValue(std::vector<char> *outputImage, size_t position, uint32_t value, int numberOfBytes)
+    {
+        for(int currentByte = 0; currentByte < numberOfBytes; currentByte++)
+        {
+            outputImage->at(position + currentByte) = (char) ((value >> (8 * currentByte)) & 0xFF);
+        }
+    }
+    
+    //Append one row of RLE packets
+    void GenerateRow(std::vector<char> *outputImage, uint32_t &randomState, const grpGeneratorSettings &generatorSettings, int frameWidth, bool compactRow)
+    {
+        int currentColumn = 0;
+        
+        //Fill the row with the longest repeat packets possible
+        if(compactRow)
+        {
+            while(currentColumn < frameWidth)
+            {
+                int packetLength = (frameWidth - currentColumn) < 0x3F ? (frameWidth - currentColumn) : 0x3F;
+                AppendValue(outputImage, 0x40 | packetLength, 1);
+                AppendValue(outputImage, NextRandom(randomState) & 0xFF, 1);
+                currentColumn += packetLength;
+            }
+            return;
+        }
+        
+        while(currentColumn < frameWidth)
+        {
+            int remainingPixels = frameWidth - currentColumn;
+            int runLength = NextRunLength(randomState, generatorSettings.averageRunLength);
+            if(runLength > remainingPixels)
+            {
+                runLength = remainingPixels;
+            }
+            
+            if(NextRandomFraction(randomState) >= generatorSettings.opacity)
+            {
+                //Skip packets
+                while(runLength > 0)
+                {
+                    int packetLength = runLength < 0x7F ? runLength : 0x7F;
+                    AppendValue(outputImage, 0x80 | packetLength, 1);
+                    runLength -= packetLength;
+                    currentColumn += packetLength;
+                }
+            }
+            else if(NextRandomFraction(randomState) < generatorSettings.repeatRatio)
+            {
+                //Repeat packets
+                uint8_t runColor = NextRandom(randomState) & 0xFF;
+                while(runLength > 0)
+                {
+                    int packetLength = runLength < 0x3F ? runLength : 0x3F;
+                    AppendValue(outputImage, 0x40 | packetLength, 1);
+                    AppendValue(outputImage, runColor, 1);
+                    runLength -= packetLength;
+                    currentColumn += packetLength;
+                }
+            }
+            else
+            {
+                //Copy packets
+                while(runLength > 0)
+                {
+                    int packetLength = runLength < 0x3F ? runLength : 0x3F;
+                    AppendValue(outputImage, packetLength, 1);
+                    for(int currentPixel = 0; currentPixel < packetLength; currentPixel++)
+                    {
+                        AppendValue(outputImage, NextRandom(randomState) & 0xFF, 1);
+                    }
+                    runLength -= packetLength;
+                    currentColumn += packetLength;
+                }
+            }
+        }
+    }
+}
+
+grpGeneratorSettings GetDefaultGeneratorSettings()
+{
+    grpGeneratorSettings defaultSettings;
+    defaultSettings.seed = 1;
+    defaultSettings.numberOfFrames = 64;
+    defaultSettings.minimumFrameWidth = 128;
+    defaultSettings.maximumFrameWidth = 128;
+    defaultSettings.minimumFrameHeight = 128;
+    defaultSettings.maximumFrameHeight = 128;
+    defaultSettings.averageRunLength = 8.0f;
+    defaultSettings.repeatRatio = 0.5f;
+    defaultSettings.duplicateRatio = 0.0f;
+    defaultSettings.opacity = 0.5f;
+    return defaultSettings;
+}
+
+void GenerateGRP(std::vector<char> *outputImage, const grpGeneratorSettings &generatorSettings)
+{
+    if(generatorSettings.numberOfFrames < 1 || generatorSettings.numberOfFrames > 0xFFFF ||
+       generatorSettings.minimumFrameWidth < 1 || generatorSettings.maximumFrameWidth > 255 ||
+       generatorSettings.minimumFrameWidth > generatorSettings.maximumFrameWidth ||
+       generatorSettings.minimumFrameHeight < 1 || generatorSettings.maximumFrameHeight > 255 ||
+       generatorSettings.minimumFrameHeight > generatorSettings.maximumFrameHeight)
+    {
+        throw std::invalid_argument("Frame counts must be 1-65535 and frame sizes 1-255");
+    }
+    
+    uint32_t randomState = generatorSettings.seed;
+    outputImage->clear();
+    
+    //GRP header, the frames never get bigger then the maximum sizes
+    AppendValue(outputImage, generatorSettings.numberOfFrames, 2);
+    AppendValue(outputImage, generatorSettings.maximumFrameWidth, 2);
+    AppendValue(outputImage, generatorSettings.maximumFrameHeight, 2);
+    
+    //Frame headers, the data offsets are filled in as the frames are written
+    size_t frameHeaderStart = outputImage->size();
+    outputImage->resize(frameHeaderStart + (8 * generatorSettings.numberOfFrames), 0);
+    
+    for(int currentFrame = 0; currentFrame < generatorSettings.numberOfFrames; currentFrame++)
+    {
+        size_t frameHeaderPosition = frameHeaderStart + (8 * currentFrame);
+        
+        //Reuse an earlier frame's header, the duplicate shares its data
+        if(currentFrame > 0 && NextRandomFraction(randomState) < generatorSettings.duplicateRatio)
+        {
+            size_t sourceHeaderPosition = frameHeaderStart + (8 * (NextRandom(randomState) % currentFrame));
+            std::copy(outputImage->begin() + sourceHeaderPosition, outputImage->begin() + sourceHeaderPosition + 8, outputImage->begin() + frameHeaderPosition);
+            continue;
+        }
+        
+        int frameWidth = NextRandomRange(randomState, generatorSettings.minimumFrameWidth, generatorSettings.maximumFrameWidth);
+        int frameHeight = NextRandomRange(randomState, generatorSettings.minimumFrameHeight, generatorSettings.maximumFrameHeight);
+        size_t frameDataOffset = outputImage->size();
+        
+        WriteValue(outputImage, frameHeaderPosition, NextRandomRange(randomState, 0, generatorSettings.maximumFrameWidth - frameWidth), 1);
+        WriteValue(outputImage, frameHeaderPosition + 1, NextRandomRange(randomState, 0, generatorSettings.maximumFrameHeight - frameHeight), 1);
+        WriteValue(outputImage, frameHeaderPosition + 2, frameWidth, 1);
+        WriteValue(outputImage, frameHeaderPosition + 3, frameHeight, 1);
+        WriteValue(outputImage, frameHeaderPosition + 4, frameDataOffset, 4);
+        
+        //Row offset table
+        outputImage->resize(outputImage->size() + (2 * frameHeight), 0);
+        
+        //A row never takes more then 2 bytes a pixel, a compact row (repeat
+        //packets only) 2 bytes per 63 pixels.
+        size_t largestRowSize = 2 * frameWidth;
+        size_t compactRowSize = 2 * ((frameWidth + 0x3E) / 0x3F);
+        for(int currentRow = 0; currentRow < frameHeight; currentRow++)
+        {
+            size_t rowOffset = outputImage->size() - frameDataOffset;
+            WriteValue(outputImage, frameDataOffset + (2 * currentRow), rowOffset, 2);
+            
+            //Keep every following row start inside the 16bit row offsets
+            size_t remainingRows = frameHeight - currentRow - 1;
+            bool compactRow = (rowOffset + largestRowSize + (remainingRows * compactRowSize)) > 0xFFFF;
+            GenerateRow(outputImage, randomState, generatorSettings, frameWidth, compactRow);
+        }
+    }
+}
@@ -0,0 +1,66 @@
+/*!
+ *  \brief     Synthetic GRP image generator
+ *  \details   Builds valid GRP image data in memory, used by the GenerateGRP
+ *              tool and the benchmarks to produce corpora larger than the
+ *              shipped sample content. The output only depends on the
+ *              settings (including the seed), so a corpus can be rebuilt
+ *              anywhere without game assets.
+ *  \author    libgrp Authors
+ *  \version   0.0.1
+ *  \date      2013 - Present
+ */
+#ifndef GRPGenerator_H
+#define GRPGenerator_H
+
+#include <vector>
+#include <cstddef>
+#include <inttypes.h>
+
+//The settings of a generated GRP image
+struct grpGeneratorSettings
+{
+    //Random seed, the same settings always give the same image
+    uint32_t seed;
+    
+    int numberOfFrames;
+    
+    //Each frame size is picked between the minimum and maximum (1 - 255)
+    int minimumFrameWidth;
+    int maximumFrameWidth;
+    int minimumFrameHeight;
+    int maximumFrameHeight;
+    
+    //The mean length of a run of opaque or transparent pixels, the
+    //lengths are geometrically distributed around it
+    float averageRunLength;
+    
+    //The share of opaque runs stored as repeat packets (0.0 - 1.0),
+    //the rest are stored as copy packets
+    float repeatRatio;
+    
+    //The share of frames that reuse the data of an earlier frame (0.0 - 1.0)
+    float duplicateRatio;
+    
+    //The share of runs that are opaque (0.0 - 1.0)
+    float opacity;
+};
+
+//!Get the default generator settings
+/*!128x128 frames, 64 frames, mixed packets, no duplicates.
+ * \returns The default grpGeneratorSettings
+ * \note NA*/
+grpGeneratorSettings GetDefaultGeneratorSettings();
+
+//!Build a GRP image in memory
+/*!Generates every unique frame as a seeded mix of skip, repeat and copy
+ * packets following the settings.
+ * \pre The frame sizes must be between 1 and 255 and the ratios between 0.0 and 1.0
+ * \post outputImage holds a complete GRP file
+ * \param[out] outputImage The vector to fill (it is cleared first)
+ * \param[in] generatorSettings The shape of the generated image
+ * \throws std::invalid_argument
+ * \note Rows are stored with cheaper packets when a large frame
+ *      would overflow the 16bit row offsets.*/
+void GenerateGRP(std::vector<char> *outputImage, const grpGeneratorSettings &generatorSettings);
+
+#endif
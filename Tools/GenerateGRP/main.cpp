@@ -0,0 +1,98 @@
+#include "main.hpp"
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2)
+    {
+        PrintUsage();
+        return -1;
+    }
+    
+    grpGeneratorSettings generatorSettings = GetDefaultGeneratorSettings();
+    std::string outputFilePath;
+    
+    for(int currentArgument = 1; currentArgument < argc; currentArgument++)
+    {
+        //Every option takes one value
+        if(argv[currentArgument][0] == '-' && (currentArgument + 1) < argc)
+        {
+            const char *optionName = argv[currentArgument];
+            const char *optionValue = argv[++currentArgument];
+            if(strcmp(optionName, "--seed") == 0)
+                generatorSettings.seed = strtoul(optionValue, NULL, 10);
+            else if(strcmp(optionName, "--frames") == 0)
+                generatorSettings.numberOfFrames = atoi(optionValue);
+            else if(strcmp(optionName, "--width") == 0)
+            {
+                generatorSettings.minimumFrameWidth = generatorSettings.maximumFrameWidth = atoi(optionValue);
+                if(strchr(optionValue, '-'))
+                    generatorSettings.maximumFrameWidth = atoi(strchr(optionValue, '-') + 1);
+            }
+            else if(strcmp(optionName, "--height") == 0)
+            {
+                generatorSettings.minimumFrameHeight = generatorSettings.maximumFrameHeight = atoi(optionValue);
+                if(strchr(optionValue, '-'))
+                    generatorSettings.maximumFrameHeight = atoi(strchr(optionValue, '-') + 1);
+            }
+            else if(strcmp(optionName, "--run-length") == 0)
+                generatorSettings.averageRunLength = atof(optionValue);
+            else if(strcmp(optionName, "--repeat-ratio") == 0)
+                generatorSettings.repeatRatio = atof(optionValue);
+            else if(strcmp(optionName, "--duplicates") == 0)
+                generatorSettings.duplicateRatio = atof(optionValue);
+            else if(strcmp(optionName, "--opacity") == 0)
+                generatorSettings.opacity = atof(optionValue);
+            else
+            {
+                std::cout << "Unknown option " << optionName << '\n';
+                PrintUsage();
+                return -1;
+            }
+        }
+        else
+        {
+            outputFilePath = argv[currentArgument];
+        }
+    }
+    
+    if(outputFilePath.empty())
+    {
+        PrintUsage();
+        return -1;
+    }
+    
+    std::vector<char> generatedImage;
+    try
+    {
+        GenerateGRP(&generatedImage, generatorSettings);
+    }
+    catch(std::exception &generatorError)
+    {
+        std::cout << generatorError.what() << '\n';
+        return -1;
+    }
+    
+    std::ofstream outputFile(outputFilePath.c_str(), std::ios::binary);
+    if(!outputFile.is_open())
+    {
+        std::cout << "Unable to open " << outputFilePath << '\n';
+        return -1;
+    }
+    outputFile.write(&generatedImage.front(), generatedImage.size());
+    
+    std::cout << "Wrote " << generatedImage.size() << " bytes, " << generatorSettings.numberOfFrames << " frames to " << outputFilePath << '\n';
+    return 0;
+}
+
+void PrintUsage()
+{
+    std::cout << "Usage: GenerateGRP [options] output.grp\n"
+              << "  --seed N            Random seed (1)\n"
+              << "  --frames N          Number of frames (64)\n"
+              << "  --width N[-M]       Frame width or width range, 1-255 (128)\n"
+              << "  --height N[-M]      Frame height or height range, 1-255 (128)\n"
+              << "  --run-length F      Average pixel run length (8.0)\n"
+              << "  --repeat-ratio F    Share of opaque runs stored as repeat packets (0.5)\n"
+              << "  --duplicates F      Share of frames reusing earlier frame data (0.0)\n"
+              << "  --opacity F         Share of opaque runs (0.5)\n";
+}
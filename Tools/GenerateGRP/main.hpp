@@ -0,0 +1,14 @@
+#ifndef GenerateGRP_H
+#define GenerateGRP_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include "GRPGenerator.hpp"
+
+//!Print the command line options
+void PrintUsage();
+
+#endif
@@ -461,6 +461,313 @@ BOOST_AUTO_TEST_CASE(OutofBoundsApplyBlueHigh)
     BOOST_REQUIRE_THROW(goodData.ApplyBlueValue(myColor, (goodData.GetNumberOfColors() * 1000)), OutofBoundsColorException);
 }
 
+//On a palette of greys (color n is n,n,n) the table rows have known
+//results, a shadow row n maps a grey to the grey n / 32 of the way
+//to black (ties go to the lower index)
+BOOST_AUTO_TEST_CASE(ApplyShadowTableBuffer)
+{
+    std::vector<char> greyPaletteData;
+    for(int currentColor = 0; currentColor < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentColor++)
+    {
+        greyPaletteData.insert(greyPaletteData.end(), 3, (char) currentColor);
+    }
+    ColorPalette greyPalette(&greyPaletteData);
+    
+    std::vector<uint8_t> allColors(MAXIMUMNUMBEROFCOLORSPERPALETTE);
+    for(int currentColor = 0; currentColor < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentColor++)
+    {
+        allColors.at(currentColor) = currentColor;
+    }
+    std::vector<uint8_t> pixelBuffer = allColors;
+    greyPalette.ApplyShadowTable(&pixelBuffer.front(), pixelBuffer.size(), 0);
+    BOOST_REQUIRE(pixelBuffer == allColors);
+    
+    pixelBuffer = allColors;
+    greyPalette.ApplyShadowTable(&pixelBuffer.front(), pixelBuffer.size(), 8);
+    BOOST_REQUIRE_EQUAL(pixelBuffer.at(0), 0);
+    BOOST_REQUIRE_EQUAL(pixelBuffer.at(1), 1);
+    BOOST_REQUIRE_EQUAL(pixelBuffer.at(2), 1);
+    BOOST_REQUIRE_EQUAL(pixelBuffer.at(4), 3);
+    BOOST_REQUIRE_EQUAL(pixelBuffer.at(100), 75);
+    BOOST_REQUIRE_EQUAL(pixelBuffer.at(200), 150);
+    BOOST_REQUIRE_EQUAL(pixelBuffer.at(255), 191);
+    
+    pixelBuffer = allColors;
+    greyPalette.ApplyShadowTable(&pixelBuffer.front(), pixelBuffer.size(), 31);
+    BOOST_REQUIRE_EQUAL(pixelBuffer.at(16), 0);
+    BOOST_REQUIRE_EQUAL(pixelBuffer.at(128), 4);
+    BOOST_REQUIRE_EQUAL(pixelBuffer.at(255), 8);
+    
+    //The greyscale target weighs the colors 30/59/11 without scaling
+    //down, a grey n is matched to the grey closest to about 16 * n
+    pixelBuffer = allColors;
+    greyPalette.ApplyGreyscaleTable(&pixelBuffer.front(), pixelBuffer.size());
+    BOOST_REQUIRE_EQUAL(pixelBuffer.at(0), 0);
+    BOOST_REQUIRE_EQUAL(pixelBuffer.at(1), 16);
+    BOOST_REQUIRE_EQUAL(pixelBuffer.at(3), 48);
+    BOOST_REQUIRE_EQUAL(pixelBuffer.at(10), 161);
+    BOOST_REQUIRE_EQUAL(pixelBuffer.at(16), 255);
+}
+
+BOOST_AUTO_TEST_CASE(NoPaletteDataApplyTableBuffer)
+{
+    ColorPalette noData;
+    uint8_t pixelBuffer[4] = {0, 1, 2, 3};
+    
+    BOOST_REQUIRE_THROW(noData.ApplyLightTable(pixelBuffer, 4, 0), NoPaletteLoadedException);
+    BOOST_REQUIRE_THROW(noData.ApplyGreyscaleTable(pixelBuffer, 4), NoPaletteLoadedException);
+}
+
+BOOST_AUTO_TEST_CASE(OutofBoundsApplyTableBuffer)
+{
+    ColorPalette goodData;
+    goodData.LoadPalette(PALLETTEFILEPATH);
+    uint8_t pixelBuffer[4] = {0, 1, 2, 3};
+    
+    BOOST_REQUIRE_THROW(goodData.ApplyRedTable(pixelBuffer, 4, -1), OutofBoundsColorException);
+    //The default gradation generates 32 rows
+    BOOST_REQUIRE_THROW(goodData.ApplyRedTable(pixelBuffer, 4, 32), OutofBoundsColorException);
+}
+
+//The packed lookup tables must agree with the colorValues API
+BOOST_AUTO_TEST_CASE(RGBALookupTableMatchesPalette)
+{
+    ColorPalette samplePalette;
+    samplePalette.LoadPalette(PALLETTEFILEPATH);
+    
+    const uint8_t *rgbaTable = (const uint8_t *) samplePalette.GetRGBALookupTable();
+    const uint8_t *bgraTable = (const uint8_t *) samplePalette.GetBGRALookupTable();
+    for(int currentColor = 0; currentColor < samplePalette.GetNumberOfColors(); currentColor++)
+    {
+        colorValues paletteColor = samplePalette.GetColorFromPalette(currentColor);
+        BOOST_REQUIRE_EQUAL(rgbaTable[(4 * currentColor)], paletteColor.RedElement);
+        BOOST_REQUIRE_EQUAL(rgbaTable[(4 * currentColor) + 1], paletteColor.GreenElement);
+        BOOST_REQUIRE_EQUAL(rgbaTable[(4 * currentColor) + 2], paletteColor.BlueElement);
+        BOOST_REQUIRE_EQUAL(rgbaTable[(4 * currentColor) + 3], 0xFF);
+        BOOST_REQUIRE_EQUAL(bgraTable[(4 * currentColor)], paletteColor.BlueElement);
+        BOOST_REQUIRE_EQUAL(bgraTable[(4 * currentColor) + 2], paletteColor.RedElement);
+    }
+}
+
+//A 1024 byte palette carries a padding byte per color
+BOOST_AUTO_TEST_CASE(LoadPaddedPaletteVector)
+{
+    std::vector<char> paletteData;
+    LoadFileToVector(PALLETTEFILEPATH, &paletteData);
+    std::vector<char> paddedPaletteData;
+    for(int currentColor = 0; currentColor < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentColor++)
+    {
+        paddedPaletteData.insert(paddedPaletteData.end(), paletteData.begin() + (3 * currentColor), paletteData.begin() + (3 * currentColor) + 3);
+        paddedPaletteData.push_back(0);
+    }
+    
+    ColorPalette samplePalette(&paletteData), paddedPalette(&paddedPaletteData);
+    BOOST_REQUIRE_EQUAL(paddedPalette.GetNumberOfColors(), MAXIMUMNUMBEROFCOLORSPERPALETTE);
+    BOOST_REQUIRE(std::equal(samplePalette.GetRGBALookupTable(), samplePalette.GetRGBALookupTable() + MAXIMUMNUMBEROFCOLORSPERPALETTE, paddedPalette.GetRGBALookupTable()));
+}
+
+BOOST_AUTO_TEST_CASE(OutofBoundsGetColor)
+{
+    ColorPalette samplePalette;
+    samplePalette.LoadPalette(PALLETTEFILEPATH);
+    BOOST_REQUIRE_THROW(samplePalette.GetColorFromPalette(samplePalette.GetNumberOfColors()), OutofBoundsColorException);
+}
+
+//Updating the tables after a palette edit must give the same
+//tables as loading the edited palette from scratch
+BOOST_AUTO_TEST_CASE(SetColorsMatchesReload)
+{
+    ColorPalette editedPalette;
+    editedPalette.LoadPalette(PALLETTEFILEPATH);
+    editedPalette.GenerateColorTables();
+    
+    std::vector<colorValues> newColors(3);
+    newColors.at(0).RedElement = 200; newColors.at(0).GreenElement = 10; newColors.at(0).BlueElement = 10;
+    newColors.at(1) = editedPalette.GetColorFromPalette(0);
+    newColors.at(2).RedElement = 16; newColors.at(2).GreenElement = 16; newColors.at(2).BlueElement = 16;
+    editedPalette.SetColors(100, newColors);
+    
+    std::vector<char> editedPaletteData;
+    for(int currentColor = 0; currentColor < editedPalette.GetNumberOfColors(); currentColor++)
+    {
+        colorValues paletteColor = editedPalette.GetColorFromPalette(currentColor);
+        editedPaletteData.push_back((char) paletteColor.RedElement);
+        editedPaletteData.push_back((char) paletteColor.GreenElement);
+        editedPaletteData.push_back((char) paletteColor.BlueElement);
+    }
+    ColorPalette reloadedPalette(&editedPaletteData);
+    reloadedPalette.GenerateColorTables();
+    
+    std::vector<uint8_t> allColors(MAXIMUMNUMBEROFCOLORSPERPALETTE);
+    for(int currentColor = 0; currentColor < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentColor++)
+    {
+        allColors.at(currentColor) = currentColor;
+    }
+    std::vector<uint8_t> editedBuffer = allColors, reloadedBuffer = allColors;
+    editedPalette.ApplyGreyscaleTable(&editedBuffer.front(), editedBuffer.size());
+    reloadedPalette.ApplyGreyscaleTable(&reloadedBuffer.front(), reloadedBuffer.size());
+    BOOST_REQUIRE(editedBuffer == reloadedBuffer);
+    
+    for(int currentRow = 0; currentRow < 32; currentRow++)
+    {
+        editedBuffer = allColors;
+        reloadedBuffer = allColors;
+        editedPalette.ApplyRedTable(&editedBuffer.front(), editedBuffer.size(), currentRow);
+        reloadedPalette.ApplyRedTable(&reloadedBuffer.front(), reloadedBuffer.size(), currentRow);
+        BOOST_REQUIRE(editedBuffer == reloadedBuffer);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(OutofBoundsSetColor)
+{
+    ColorPalette noData;
+    colorValues myColor;
+    myColor.RedElement = 10;
+    myColor.GreenElement = 20;
+    myColor.BlueElement = 30;
+    BOOST_REQUIRE_THROW(noData.SetColor(0, myColor), NoPaletteLoadedException);
+    
+    ColorPalette goodData;
+    goodData.LoadPalette(PALLETTEFILEPATH);
+    BOOST_REQUIRE_THROW(goodData.SetColor(-1, myColor), OutofBoundsColorException);
+    BOOST_REQUIRE_THROW(goodData.SetColors(255, std::vector<colorValues>(2, myColor)), OutofBoundsColorException);
+}
+
+//Repeated requests for the same colorized table share one table
+BOOST_AUTO_TEST_CASE(ColorizedTableCache)
+{
+    ColorPalette samplePalette;
+    samplePalette.LoadPalette(PALLETTEFILEPATH);
+    
+    colorValues startingGlowColor;
+    startingGlowColor.RedElement = 120;
+    startingGlowColor.GreenElement = 0;
+    startingGlowColor.BlueElement = 0;
+    colorValues endingGlowColor = startingGlowColor;
+    endingGlowColor.GreenElement = 200;
+    
+    sharedColorTable firstTable = samplePalette.GetColorizedTable(16, startingGlowColor, endingGlowColor);
+    sharedColorTable secondTable = samplePalette.GetColorizedTable(16, startingGlowColor, endingGlowColor);
+    BOOST_REQUIRE(firstTable == secondTable);
+    BOOST_REQUIRE(firstTable != samplePalette.GetColorizedTable(17, startingGlowColor, endingGlowColor));
+    
+    std::vector<uint8_t> *copiedTable = samplePalette.GenerateColorizedTable(16, startingGlowColor, endingGlowColor);
+    BOOST_REQUIRE(*copiedTable == *firstTable);
+    delete copiedTable;
+    
+    //Edits replace the cached table, the handed out one stays unchanged
+    std::vector<uint8_t> originalContents = *firstTable;
+    samplePalette.SetColor(firstTable->at(0), endingGlowColor);
+    BOOST_REQUIRE(samplePalette.GetColorizedTable(16, startingGlowColor, endingGlowColor) != firstTable);
+    BOOST_REQUIRE(*firstTable == originalContents);
+    
+    //A rejected gradation keeps the generated table and its cache entry
+    samplePalette.GenerateShadowtable(16);
+    BOOST_REQUIRE_THROW(samplePalette.GenerateShadowtable(0), InvalidGradationValueException);
+    samplePalette.SetColors(5, std::vector<colorValues>(1, startingGlowColor));
+    samplePalette.SetColors(5, std::vector<colorValues>(1, endingGlowColor));
+    std::vector<uint8_t> shadedPixels(8, 5);
+    samplePalette.ApplyShadowTable(&shadedPixels.front(), shadedPixels.size(), 15);
+}
+
+//Remapping to the same palette must keep every color
+BOOST_AUTO_TEST_CASE(GenerateRemapTable)
+{
+    ColorPalette sourcePalette, destinationPalette, noData;
+    sourcePalette.LoadPalette(PALLETTEFILEPATH);
+    destinationPalette.LoadPalette(PALLETTEFILEPATH);
+    BOOST_REQUIRE_THROW(sourcePalette.GenerateRemapTable(noData), NoPaletteLoadedException);
+    
+    std::vector<uint8_t> remapTable = sourcePalette.GenerateRemapTable(destinationPalette);
+    BOOST_REQUIRE_EQUAL(remapTable.size(), MAXIMUMNUMBEROFCOLORSPERPALETTE);
+    for(int currentColor = 0; currentColor < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentColor++)
+    {
+        BOOST_REQUIRE_EQUAL(sourcePalette.GetRGBALookupTable()[currentColor], destinationPalette.GetRGBALookupTable()[remapTable.at(currentColor)]);
+    }
+}
+
+//Cached and incremental table work is counted separately
+BOOST_AUTO_TEST_CASE(PaletteStatistics)
+{
+    ColorPalette samplePalette;
+    samplePalette.LoadPalette(PALLETTEFILEPATH);
+    samplePalette.GenerateShadowtable();
+    samplePalette.GenerateShadowtable();
+    
+    colorPaletteStatistics paletteStatistics = samplePalette.GetStatistics();
+    BOOST_REQUIRE_EQUAL(paletteStatistics.palettesLoaded, 1);
+    BOOST_REQUIRE_EQUAL(paletteStatistics.bytesRead, 768);
+    BOOST_REQUIRE_EQUAL(paletteStatistics.tablesGenerated, 1);
+    BOOST_REQUIRE_EQUAL(paletteStatistics.colorizedCacheHits, 1);
+    BOOST_REQUIRE_EQUAL(paletteStatistics.tableUpdates, 0);
+    
+    colorValues newColor = {1, 2, 3};
+    samplePalette.SetColor(7, newColor);
+    BOOST_REQUIRE_EQUAL(samplePalette.GetStatistics().tableUpdates, 1);
+    
+    samplePalette.ResetStatistics();
+    BOOST_REQUIRE_EQUAL(samplePalette.GetStatistics().tablesGenerated, 0);
+    BOOST_REQUIRE_EQUAL(samplePalette.GetStatistics().bytesRead, 0);
+}
+
+//Tables are reported by kind and summed over all live palettes
+BOOST_AUTO_TEST_CASE(PaletteMemoryUsage)
+{
+    colorPaletteMemoryUsage startingTotal = ColorPalette::GetTotalMemoryUsage();
+    {
+        ColorPalette samplePalette;
+        samplePalette.LoadPalette(PALLETTEFILEPATH);
+        BOOST_REQUIRE_EQUAL(samplePalette.MemoryUsage().transparentTableBytes, 0);
+        
+        samplePalette.GenerateColorTables(32);
+        colorValues glowColor = {10, 20, 30};
+        samplePalette.GetColorizedTable(16, glowColor, glowColor);
+        colorPaletteMemoryUsage paletteUsage = samplePalette.MemoryUsage();
+        BOOST_REQUIRE(paletteUsage.transparentTableBytes >= MAXIMUMNUMBEROFCOLORSPERPALETTE * MAXIMUMNUMBEROFCOLORSPERPALETTE);
+        BOOST_REQUIRE(paletteUsage.greyscaleTableBytes >= MAXIMUMNUMBEROFCOLORSPERPALETTE);
+        BOOST_REQUIRE(paletteUsage.shadowTableBytes >= MAXIMUMNUMBEROFCOLORSPERPALETTE * 32);
+        BOOST_REQUIRE(paletteUsage.blueTableBytes >= MAXIMUMNUMBEROFCOLORSPERPALETTE * 32);
+        BOOST_REQUIRE(paletteUsage.otherColorizedTableBytes >= MAXIMUMNUMBEROFCOLORSPERPALETTE * 16);
+        BOOST_REQUIRE_EQUAL(ColorPalette::GetTotalMemoryUsage().totalBytes, startingTotal.totalBytes + paletteUsage.totalBytes);
+    }
+    BOOST_REQUIRE_EQUAL(ColorPalette::GetTotalMemoryUsage().totalBytes, startingTotal.totalBytes);
+    
+    //A palette that failed to load in its constructor is not counted
+    std::vector<char> junkData(3, 0);
+    BOOST_REQUIRE_THROW(ColorPalette junkPalette(&junkData), CurruptColorPaletteException);
+    BOOST_REQUIRE_EQUAL(ColorPalette::GetTotalMemoryUsage().totalBytes, startingTotal.totalBytes);
+}
+
+//Moving takes the tables along, a clone can be edited on its own
+BOOST_AUTO_TEST_CASE(MoveAndClonePalette)
+{
+    ColorPalette samplePalette;
+    samplePalette.LoadPalette(PALLETTEFILEPATH);
+    samplePalette.GenerateColorTables();
+    colorPaletteMemoryUsage loadedUsage = samplePalette.MemoryUsage();
+    
+    ColorPalette movedPalette(std::move(samplePalette));
+    BOOST_REQUIRE_EQUAL(samplePalette.GetNumberOfColors(), 0);
+    BOOST_REQUIRE_EQUAL(samplePalette.MemoryUsage().transparentTableBytes, 0);
+    BOOST_REQUIRE_EQUAL(movedPalette.MemoryUsage().totalBytes, loadedUsage.totalBytes);
+    
+    ColorPalette clonedPalette = movedPalette.Clone();
+    BOOST_REQUIRE_EQUAL(clonedPalette.GetNumberOfColors(), movedPalette.GetNumberOfColors());
+    BOOST_REQUIRE(std::equal(movedPalette.GetRGBALookupTable(), movedPalette.GetRGBALookupTable() + MAXIMUMNUMBEROFCOLORSPERPALETTE,
+                             clonedPalette.GetRGBALookupTable()));
+    BOOST_REQUIRE_EQUAL(clonedPalette.MemoryUsage().transparentTableBytes, loadedUsage.transparentTableBytes);
+    
+    uint32_t originalColor = movedPalette.GetRGBALookupTable()[7];
+    colorValues newColor = {1, 2, 3};
+    clonedPalette.SetColor(7, newColor);
+    BOOST_REQUIRE_EQUAL(movedPalette.GetRGBALookupTable()[7], originalColor);
+    BOOST_REQUIRE(clonedPalette.GetRGBALookupTable()[7] != originalColor);
+    
+    samplePalette = std::move(clonedPalette);
+    BOOST_REQUIRE_EQUAL(clonedPalette.GetNumberOfColors(), 0);
+    BOOST_REQUIRE(samplePalette.GetRGBALookupTable()[7] != originalColor);
+}
+
 //Ensure that things are deleted properly
 BOOST_AUTO_TEST_CASE(LoadOverPalette)
 {
@@ -12,7 +12,7 @@
 #else
 
 #define PALLETTEFILEPATH "../Documentation/SampleContent/SamplePalette.pal"
-#define CURRUPTPALLETTEFILEPATH "../Documentation/SampleContent/CurruptsamplePalette.pal"
+#define CURRUPTPALLETTEFILEPATH "../Documentation/SampleContent/CurruptSamplePalette.pal"
 #define BADPALLETTEFILEPATH "/lksmdalksmdlkamsda.pal"
 #endif
 
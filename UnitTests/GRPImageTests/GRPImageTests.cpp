@@ -30,6 +30,754 @@ BOOST_AUTO_TEST_CASE(LoadGRPMEM)
     
 }
 
+//Applying a table to a frame must match applying it
+//to the same pixels in a plain buffer
+//On a palette of greys (color n is n,n,n) shadow row 8 of 32 maps
+//every grey n to the grey closest to 3/4 n
+BOOST_AUTO_TEST_CASE(ApplyShadowTableFrame)
+{
+    std::vector<char> greyPaletteData;
+    for(int currentColor = 0; currentColor < MAXIMUMNUMBEROFCOLORSPERPALETTE; currentColor++)
+    {
+        greyPaletteData.insert(greyPaletteData.end(), 3, (char) currentColor);
+    }
+    ColorPalette greyPalette(&greyPaletteData);
+    
+    GRPImage sampleImage(GRPIMAGEFILEPATH);
+    sampleImage.SetColorPalette(&greyPalette);
+    GRPFrame *sampleFrame = sampleImage.GetFrame(0);
+    framePixelVector originalPixels = sampleFrame->frameData;
+    BOOST_REQUIRE(originalPixels.size() > 0);
+    
+    greyPalette.ApplyShadowTable(sampleFrame, 8);
+    int changedPixels = 0;
+    for(size_t currentPixel = 0; currentPixel < originalPixels.size(); currentPixel++)
+    {
+        float shadedGrey = originalPixels.at(currentPixel).colorPaletteReference * 0.75f;
+        uint8_t shadedColor = sampleFrame->frameData.at(currentPixel).colorPaletteReference;
+        BOOST_REQUIRE(std::abs(shadedColor - shadedGrey) <= 0.5f);
+        if(shadedColor != originalPixels.at(currentPixel).colorPaletteReference)
+        {
+            changedPixels++;
+        }
+    }
+    BOOST_REQUIRE(changedPixels > 0);
+}
+
+BOOST_AUTO_TEST_CASE(ConvertFrameToRGBA)
+{
+    ColorPalette samplePalette;
+    samplePalette.LoadPalette(PALETTEFILEPATH);
+    
+    GRPImage sampleImage(GRPIMAGEFILEPATH);
+    BOOST_REQUIRE_THROW(sampleImage.ConvertFrameToRGBA(0, NULL, 0), GRPImageNoLoadedPaletteSet);
+    sampleImage.SetColorPalette(&samplePalette);
+    
+    std::vector<uint32_t> rgbaBuffer(sampleImage.getMaxImageWidth() * sampleImage.getMaxImageHeight(), 0);
+    sampleImage.ConvertFrameToRGBA(0, &rgbaBuffer.front(), sampleImage.getMaxImageWidth());
+    
+    GRPFrame *sampleFrame = sampleImage.GetFrame(0);
+    for(framePixelVector::iterator currentPixel = sampleFrame->frameData.begin(); currentPixel != sampleFrame->frameData.end(); currentPixel++)
+    {
+        int bufferPosition = ((sampleFrame->GetYOffset() + currentPixel->yPosition) * sampleImage.getMaxImageWidth()) + sampleFrame->GetXOffset() + currentPixel->xPosition;
+        BOOST_REQUIRE_EQUAL(rgbaBuffer.at(bufferPosition), samplePalette.GetRGBALookupTable()[currentPixel->colorPaletteReference]);
+    }
+    
+    //A 2x1 frame whose only packet copies 63 pixels, only the 2 pixels
+    //inside the frame may be drawn in any storage mode
+    std::vector<char> longRowData = {1, 0, 2, 0, 1, 0,
+                                     0, 0, 2, 1, 14, 0, 0, 0,
+                                     2, 0, 63};
+    longRowData.resize(longRowData.size() + 63, 7);
+    const uint32_t guardValue = 0xDEADBEEF;
+    for(int currentStorage = 0; currentStorage < 3; currentStorage++)
+    {
+        GRPImage longRowImage;
+        longRowImage.SetFrameStorage((currentStorage == 0) ? EXPANDEDFRAMES : COMPRESSEDFRAMES);
+        longRowImage.SetBuildSpanPrograms(currentStorage == 2);
+        longRowImage.LoadImage(&longRowData, false);
+        longRowImage.SetColorPalette(&samplePalette);
+        BOOST_REQUIRE(longRowImage.GetFrame(0)->frameData.size() <= 2);
+        
+        std::vector<uint32_t> longRowBuffer(2 + 64, guardValue);
+        longRowImage.ConvertFrameToRGBA(0, &longRowBuffer.front(), 2);
+        BOOST_REQUIRE_EQUAL(longRowBuffer.at(0), samplePalette.GetRGBALookupTable()[7]);
+        BOOST_REQUIRE_EQUAL(longRowBuffer.at(1), samplePalette.GetRGBALookupTable()[7]);
+        BOOST_REQUIRE(std::count(longRowBuffer.begin() + 2, longRowBuffer.end(), guardValue) == 64);
+    }
+}
+
+//Frames moved to a reversed palette must still show the same colors
+BOOST_AUTO_TEST_CASE(RemapColorsToPalette)
+{
+    std::vector<char> paletteData;
+    LoadFileToVectorImageGRP(PALETTEFILEPATH, &paletteData);
+    std::vector<char> reversedPaletteData;
+    for(int currentColor = MAXIMUMNUMBEROFCOLORSPERPALETTE - 1; currentColor >= 0; currentColor--)
+    {
+        reversedPaletteData.insert(reversedPaletteData.end(), paletteData.begin() + (3 * currentColor), paletteData.begin() + (3 * currentColor) + 3);
+    }
+    ColorPalette samplePalette(&paletteData), reversedPalette(&reversedPaletteData);
+    
+    GRPImage sampleImage(GRPIMAGEFILEPATH);
+    sampleImage.SetColorPalette(&samplePalette);
+    std::vector<uint32_t> originalBuffer(sampleImage.getMaxImageWidth() * sampleImage.getMaxImageHeight(), 0);
+    sampleImage.ConvertFrameToRGBA(0, &originalBuffer.front(), sampleImage.getMaxImageWidth());
+    
+    sampleImage.RemapColors(&reversedPalette);
+    std::vector<uint32_t> remappedBuffer(originalBuffer.size(), 0);
+    sampleImage.ConvertFrameToRGBA(0, &remappedBuffer.front(), sampleImage.getMaxImageWidth());
+    BOOST_REQUIRE(originalBuffer == remappedBuffer);
+    
+    BOOST_REQUIRE_THROW(sampleImage.RemapColors(std::vector<uint8_t>(10)), GRPImageInvalidRemapTable);
+}
+
+//The memory and file loaders must count the same work
+BOOST_AUTO_TEST_CASE(LoadStatistics)
+{
+    std::vector<char> imageData;
+    LoadFileToVectorImageGRP(GRPIMAGEFILEPATH, &imageData);
+    GRPImage memoryImage(&imageData);
+    GRPImage fileImage(GRPIMAGEFILEPATH);
+    
+    grpImageStatistics memoryStatistics = memoryImage.GetStatistics();
+    grpImageStatistics fileStatistics = fileImage.GetStatistics();
+    BOOST_REQUIRE_EQUAL(memoryStatistics.imagesLoaded, 1);
+    BOOST_REQUIRE_EQUAL(memoryStatistics.framesDecoded, memoryImage.getNumberOfFrames());
+    BOOST_REQUIRE_EQUAL(memoryStatistics.framesDecoded + memoryStatistics.duplicateFrames, *(uint16_t *) &imageData.front());
+    BOOST_REQUIRE_EQUAL(memoryStatistics.framesDecoded, fileStatistics.framesDecoded);
+    BOOST_REQUIRE_EQUAL(memoryStatistics.pixelsEmitted, fileStatistics.pixelsEmitted);
+    BOOST_REQUIRE_EQUAL(memoryStatistics.bytesRead, fileStatistics.bytesRead);
+    BOOST_REQUIRE(memoryStatistics.bytesRead <= imageData.size());
+    
+    uint64_t decodedPixels = 0;
+    for(int currentFrame = 0; currentFrame < memoryImage.getNumberOfFrames(); currentFrame++)
+    {
+        decodedPixels += memoryImage.GetFrame(currentFrame)->frameData.size();
+    }
+    BOOST_REQUIRE_EQUAL(memoryStatistics.pixelsEmitted, decodedPixels);
+    
+    memoryImage.ResetStatistics();
+    BOOST_REQUIRE_EQUAL(memoryImage.GetStatistics().framesDecoded, 0);
+    BOOST_REQUIRE_EQUAL(memoryImage.GetStatistics().bytesRead, 0);
+}
+
+//Each live image adds its own usage to the process total
+BOOST_AUTO_TEST_CASE(ImageMemoryUsage)
+{
+    grpImageMemoryUsage startingTotal = GRPImage::GetTotalMemoryUsage();
+    grpImageMemoryUsage imageUsage;
+    {
+        GRPImage sampleImage(GRPIMAGEFILEPATH);
+        imageUsage = sampleImage.MemoryUsage();
+        BOOST_REQUIRE(imageUsage.pixelBytes >= sampleImage.GetStatistics().pixelsEmitted);
+        BOOST_REQUIRE_EQUAL(imageUsage.totalBytes, imageUsage.headerBytes + imageUsage.pixelBytes + imageUsage.compressedBytes + imageUsage.spanBytes + imageUsage.collisionMaskBytes + imageUsage.rowOffsetBytes +
+                            imageUsage.decodeScratchBytes + imageUsage.fileBufferBytes + imageUsage.unusedArenaBytes);
+        BOOST_REQUIRE_EQUAL(GRPImage::GetTotalMemoryUsage().totalBytes, startingTotal.totalBytes + imageUsage.totalBytes);
+    }
+    BOOST_REQUIRE_EQUAL(GRPImage::GetTotalMemoryUsage().totalBytes, startingTotal.totalBytes);
+    
+    //An image that failed to load in its constructor is not counted
+    std::vector<char> junkData(3, 0);
+    BOOST_REQUIRE_THROW(GRPImage junkImage(&junkData, false), GRPException);
+    BOOST_REQUIRE_EQUAL(GRPImage::GetTotalMemoryUsage().totalBytes, startingTotal.totalBytes);
+}
+
+//Moving an image hands over its frames, a clone gets its own copy
+BOOST_AUTO_TEST_CASE(MoveAndCloneImage)
+{
+    std::vector<GRPImage> loadedImages;
+    loadedImages.push_back(GRPImage(GRPIMAGEFILEPATH));
+    GRPFrame *firstFrame = loadedImages.at(0).GetFrame(0);
+    int numberOfFrames = loadedImages.at(0).getNumberOfFrames();
+    loadedImages.push_back(GRPImage());
+    BOOST_REQUIRE_EQUAL(loadedImages.at(0).GetFrame(0), firstFrame);
+    BOOST_REQUIRE_EQUAL(loadedImages.at(1).getNumberOfFrames(), 0);
+    
+    GRPImage movedImage(std::move(loadedImages.at(0)));
+    BOOST_REQUIRE_EQUAL(movedImage.GetFrame(0), firstFrame);
+    BOOST_REQUIRE_EQUAL(movedImage.getNumberOfFrames(), numberOfFrames);
+    BOOST_REQUIRE_EQUAL(loadedImages.at(0).getNumberOfFrames(), 0);
+    
+    GRPImage clonedImage = movedImage.Clone();
+    BOOST_REQUIRE_EQUAL(clonedImage.getNumberOfFrames(), numberOfFrames);
+    BOOST_REQUIRE_EQUAL(clonedImage.getMaxImageWidth(), movedImage.getMaxImageWidth());
+    for(int currentFrame = 0; currentFrame < numberOfFrames; currentFrame++)
+    {
+        GRPFrame *sourceFrame = movedImage.GetFrame(currentFrame);
+        GRPFrame *copiedFrame = clonedImage.GetFrame(currentFrame);
+        BOOST_REQUIRE(sourceFrame != copiedFrame);
+        BOOST_REQUIRE_EQUAL(sourceFrame->frameData.size(), copiedFrame->frameData.size());
+        BOOST_REQUIRE(std::equal(sourceFrame->frameData.begin(), sourceFrame->frameData.end(), copiedFrame->frameData.begin(),
+                                 [](const UniquePixel &sourcePixel, const UniquePixel &copiedPixel)
+                                 {
+                                     return sourcePixel.xPosition == copiedPixel.xPosition && sourcePixel.yPosition == copiedPixel.yPosition &&
+                                            sourcePixel.colorPaletteReference == copiedPixel.colorPaletteReference;
+                                 }));
+    }
+    
+    movedImage = GRPImage();
+    BOOST_REQUIRE_EQUAL(clonedImage.getNumberOfFrames(), numberOfFrames);
+    BOOST_REQUIRE(clonedImage.GetFrame(0)->frameData.size() > 0);
+}
+
+//Loading the same image again reuses the storage of the previous load
+BOOST_AUTO_TEST_CASE(ReloadReusesStorage)
+{
+    std::vector<char> imageData;
+    LoadFileToVectorImageGRP(GRPIMAGEFILEPATH, &imageData);
+    GRPImage sampleImage(&imageData);
+    sampleImage.LoadImage(&imageData);
+    grpImageMemoryUsage reloadedUsage = sampleImage.MemoryUsage();
+    GRPFrame *firstFrame = sampleImage.GetFrame(0);
+    
+    sampleImage.LoadImage(&imageData);
+    BOOST_REQUIRE_EQUAL(sampleImage.GetFrame(0), firstFrame);
+    BOOST_REQUIRE_EQUAL(sampleImage.MemoryUsage().totalBytes, reloadedUsage.totalBytes);
+    
+    sampleImage.ShrinkToFit();
+    grpImageMemoryUsage shrunkUsage = sampleImage.MemoryUsage();
+    BOOST_REQUIRE_EQUAL(shrunkUsage.decodeScratchBytes, 0);
+    BOOST_REQUIRE_EQUAL(shrunkUsage.pixelBytes, reloadedUsage.pixelBytes);
+    BOOST_REQUIRE(shrunkUsage.totalBytes < reloadedUsage.totalBytes);
+    GRPImage freshImage(&imageData);
+    BOOST_REQUIRE_EQUAL(sampleImage.GetFrame(0)->frameData.size(), freshImage.GetFrame(0)->frameData.size());
+}
+
+//The probe must report the same frames LoadImage decodes
+BOOST_AUTO_TEST_CASE(ProbeImageHeader)
+{
+    std::vector<char> imageData;
+    LoadFileToVectorImageGRP(GRPIMAGEFILEPATH, &imageData);
+    grpImageHeader fileHeader = GRPImage::ProbeImage(GRPIMAGEFILEPATH);
+    grpImageHeader memoryHeader = GRPImage::ProbeImage(&imageData);
+    
+    GRPImage sampleImage(&imageData, false);
+    BOOST_REQUIRE_EQUAL(fileHeader.numberOfFrames, sampleImage.getNumberOfFrames());
+    BOOST_REQUIRE_EQUAL(fileHeader.maxImageWidth, sampleImage.getMaxImageWidth());
+    BOOST_REQUIRE_EQUAL(fileHeader.maxImageHeight, sampleImage.getMaxImageHeight());
+    BOOST_REQUIRE_EQUAL(fileHeader.frameHeaders.size(), memoryHeader.frameHeaders.size());
+    for(int currentFrame = 0; currentFrame < sampleImage.getNumberOfFrames(); currentFrame++)
+    {
+        GRPFrame *loadedFrame = sampleImage.GetFrame(currentFrame);
+        const grpFrameHeader &probedFrame = fileHeader.frameHeaders.at(currentFrame);
+        BOOST_REQUIRE_EQUAL(probedFrame.xOffset, loadedFrame->GetXOffset());
+        BOOST_REQUIRE_EQUAL(probedFrame.yOffset, loadedFrame->GetYOffset());
+        BOOST_REQUIRE_EQUAL(probedFrame.width, loadedFrame->GetImageWidth());
+        BOOST_REQUIRE_EQUAL(probedFrame.height, loadedFrame->GetImageHeight());
+        BOOST_REQUIRE_EQUAL(probedFrame.dataOffset, loadedFrame->GetDataOffset());
+        BOOST_REQUIRE_EQUAL(probedFrame.dataOffset, memoryHeader.frameHeaders.at(currentFrame).dataOffset);
+    }
+    
+    imageData.resize(6 + 8);
+    BOOST_REQUIRE_THROW(GRPImage::ProbeImage(&imageData), GRPImageInvalidHeader);
+    BOOST_REQUIRE_THROW(GRPImage::ProbeImage("libgrpMissingTest.grp"), std::ios_base::failure);
+}
+
+//The layout reads every byte of frame data once, front to back
+BOOST_AUTO_TEST_CASE(FrameLayoutOrder)
+{
+    std::vector<char> imageData;
+    LoadFileToVectorImageGRP(GRPIMAGEFILEPATH, &imageData);
+    grpImageHeader imageHeader = GRPImage::ProbeImage(&imageData);
+    std::vector<grpFrameLayout> frameLayout;
+    GRPImage::ComputeFrameLayout(imageHeader, imageData.size(), &frameLayout);
+    BOOST_REQUIRE_EQUAL(frameLayout.size(), imageHeader.numberOfFrames);
+    
+    uint32_t previousDataEnd = 0;
+    int uniqueFrames = 0;
+    for(std::vector<grpFrameLayout>::iterator currentLayout = frameLayout.begin(); currentLayout != frameLayout.end(); currentLayout++)
+    {
+        BOOST_REQUIRE_EQUAL(currentLayout->dataOffset, imageHeader.frameHeaders.at(currentLayout->frameNumber).dataOffset);
+        if(currentLayout->sharedWithFrame == currentLayout->frameNumber)
+        {
+            BOOST_REQUIRE(currentLayout->dataOffset >= previousDataEnd);
+            BOOST_REQUIRE(currentLayout->dataEnd > currentLayout->dataOffset);
+            previousDataEnd = currentLayout->dataEnd;
+            uniqueFrames++;
+        }
+        else
+        {
+            BOOST_REQUIRE(currentLayout->sharedWithFrame < currentLayout->frameNumber);
+            BOOST_REQUIRE_EQUAL(imageHeader.frameHeaders.at(currentLayout->sharedWithFrame).dataOffset, currentLayout->dataOffset);
+        }
+    }
+    BOOST_REQUIRE_EQUAL(previousDataEnd, imageData.size());
+    
+    //Frames still come out in header order
+    GRPImage sampleImage(&imageData);
+    BOOST_REQUIRE_EQUAL(sampleImage.getNumberOfFrames(), uniqueFrames);
+    BOOST_REQUIRE(sampleImage.GetFrameLayout().size() == frameLayout.size());
+    BOOST_REQUIRE_EQUAL(sampleImage.GetFrame(0)->GetDataOffset(), imageHeader.frameHeaders.at(0).dataOffset);
+    for(int currentFrame = 1; currentFrame < sampleImage.getNumberOfFrames(); currentFrame++)
+    {
+        BOOST_REQUIRE(sampleImage.GetFrame(currentFrame)->GetDataOffset() != sampleImage.GetFrame(currentFrame - 1)->GetDataOffset());
+    }
+}
+
+//A forward only stream must decode the same frames as memory
+BOOST_AUTO_TEST_CASE(LoadGRPStream)
+{
+    std::vector<char> imageData;
+    LoadFileToVectorImageGRP(GRPIMAGEFILEPATH, &imageData);
+    GRPImage memoryImage(&imageData);
+    
+    std::istringstream imageStream(std::string(imageData.begin(), imageData.end()));
+    GRPImage streamImage;
+    //Every GetFrame number is handed out exactly once, with its frame
+    std::vector<int> timesEmitted(memoryImage.getNumberOfFrames(), 0);
+    std::vector<GRPFrame *> emittedFrames(memoryImage.getNumberOfFrames(), NULL);
+    streamImage.LoadImage(imageStream, true, [&timesEmitted, &emittedFrames](int frameNumber, GRPFrame *decodedFrame)
+    {
+        BOOST_REQUIRE(decodedFrame != NULL);
+        BOOST_REQUIRE(frameNumber >= 0 && frameNumber < (int) timesEmitted.size());
+        timesEmitted.at(frameNumber)++;
+        emittedFrames.at(frameNumber) = decodedFrame;
+    });
+    BOOST_REQUIRE(std::count(timesEmitted.begin(), timesEmitted.end(), 1) == memoryImage.getNumberOfFrames());
+    BOOST_REQUIRE_EQUAL(streamImage.getNumberOfFrames(), memoryImage.getNumberOfFrames());
+    BOOST_REQUIRE_EQUAL(streamImage.GetStatistics().pixelsEmitted, memoryImage.GetStatistics().pixelsEmitted);
+    for(int currentFrame = 0; currentFrame < memoryImage.getNumberOfFrames(); currentFrame++)
+    {
+        BOOST_REQUIRE(streamImage.GetFrame(currentFrame) == emittedFrames.at(currentFrame));
+        BOOST_REQUIRE_EQUAL(streamImage.GetFrame(currentFrame)->GetDataOffset(), memoryImage.GetFrame(currentFrame)->GetDataOffset());
+        BOOST_REQUIRE_EQUAL(streamImage.GetFrame(currentFrame)->frameData.size(), memoryImage.GetFrame(currentFrame)->frameData.size());
+    }
+    
+    //Cut off part way through the frame data
+    std::istringstream truncatedStream(std::string(imageData.begin(), imageData.begin() + (imageData.size() / 2)));
+    BOOST_REQUIRE_THROW(streamImage.LoadImage(truncatedStream), GRPImageInvalidFrameData);
+    BOOST_REQUIRE_EQUAL(streamImage.getNumberOfFrames(), 0);
+}
+
+//A frame failing to decode part way through a load must leave an empty
+//image, not one counting frames it does not hold
+BOOST_AUTO_TEST_CASE(LoadCorruptFrameData)
+{
+    //Two 2x1 frames, the first one's row starts with a zero length packet
+    const char corruptData[] = {2, 0, 2, 0, 1, 0,
+                                0, 0, 2, 1, 22, 0, 0, 0,
+                                0, 0, 2, 1, 25, 0, 0, 0,
+                                2, 0, 0,
+                                2, 0, 2, 5, 6};
+    std::vector<char> corruptImage(corruptData, corruptData + sizeof(corruptData));
+    std::ofstream corruptFile("libgrpCorruptTest.grp", std::ios::binary);
+    corruptFile.write(corruptData, sizeof(corruptData));
+    corruptFile.close();
+    std::vector<char> sampleData;
+    LoadFileToVectorImageGRP(GRPIMAGEFILEPATH, &sampleData);
+    
+    GRPImage reusedImage;
+    for(int currentLoader = 0; currentLoader < 4; currentLoader++)
+    {
+        reusedImage.LoadImage(&sampleData);
+        BOOST_REQUIRE(reusedImage.getNumberOfFrames() > 0);
+        std::istringstream corruptStream(std::string(corruptImage.begin(), corruptImage.end()));
+        switch(currentLoader)
+        {
+            case 0:
+                BOOST_REQUIRE_THROW(reusedImage.LoadImage(&corruptImage), GRPImageInvalidFrameData);
+                break;
+            case 1:
+                BOOST_REQUIRE_THROW(reusedImage.LoadImage(corruptStream), GRPImageInvalidFrameData);
+                break;
+            case 2:
+                BOOST_REQUIRE_THROW(reusedImage.LoadImageFrames(&corruptImage, 0, 2), GRPImageInvalidFrameData);
+                break;
+            default:
+                BOOST_REQUIRE_THROW(reusedImage.LoadImageFrames("libgrpCorruptTest.grp", 0, 2), GRPImageInvalidFrameData);
+                break;
+        }
+        BOOST_REQUIRE_EQUAL(reusedImage.getNumberOfFrames(), 0);
+        BOOST_REQUIRE_EQUAL(reusedImage.getMaxImageWidth(), 0);
+        BOOST_REQUIRE_EQUAL(reusedImage.GetOpaquePixelCount(), 0);
+        BOOST_REQUIRE_EQUAL(reusedImage.MemoryUsage().pixelBytes, 0);
+        BOOST_REQUIRE_THROW(reusedImage.GetFrame(0), GRPImageInvalidFrameNumber);
+    }
+    
+    std::remove("libgrpCorruptTest.grp");
+    
+    //The second frame alone is fine
+    reusedImage.LoadImageFrames(&corruptImage, 1, 2);
+    BOOST_REQUIRE_EQUAL(reusedImage.getNumberOfFrames(), 1);
+    BOOST_REQUIRE_EQUAL(reusedImage.GetOpaquePixelCount(), 2);
+}
+
+//Loading a few frames must give the same frames as a full load
+BOOST_AUTO_TEST_CASE(LoadFrameSubset)
+{
+    std::vector<char> imageData;
+    LoadFileToVectorImageGRP(GRPIMAGEFILEPATH, &imageData);
+    GRPImage fullImage(&imageData, false);
+    
+    std::vector<int> frameNumbers;
+    frameNumbers.push_back(fullImage.getNumberOfFrames() - 1);
+    frameNumbers.push_back(3);
+    frameNumbers.push_back(17);
+    GRPImage memorySubset, fileSubset, rangeSubset;
+    memorySubset.LoadImageFrames(&imageData, frameNumbers);
+    fileSubset.LoadImageFrames(GRPIMAGEFILEPATH, frameNumbers);
+    rangeSubset.LoadImageFrames(GRPIMAGEFILEPATH, 10, 20);
+    BOOST_REQUIRE_EQUAL(memorySubset.getNumberOfFrames(), frameNumbers.size());
+    BOOST_REQUIRE_EQUAL(rangeSubset.getNumberOfFrames(), 10);
+    BOOST_REQUIRE_EQUAL(fileSubset.GetStatistics().framesDecoded, frameNumbers.size());
+    
+    for(size_t currentFrame = 0; currentFrame < frameNumbers.size(); currentFrame++)
+    {
+        GRPFrame *expectedFrame = fullImage.GetFrame(frameNumbers.at(currentFrame));
+        BOOST_REQUIRE_EQUAL(memorySubset.GetFrame(currentFrame)->GetDataOffset(), expectedFrame->GetDataOffset());
+        BOOST_REQUIRE_EQUAL(memorySubset.GetFrame(currentFrame)->frameData.size(), expectedFrame->frameData.size());
+        BOOST_REQUIRE_EQUAL(fileSubset.GetFrame(currentFrame)->frameData.size(), expectedFrame->frameData.size());
+    }
+    for(int currentFrame = 0; currentFrame < 10; currentFrame++)
+    {
+        BOOST_REQUIRE_EQUAL(rangeSubset.GetFrame(currentFrame)->frameData.size(), fullImage.GetFrame(10 + currentFrame)->frameData.size());
+    }
+    
+    //A single frame only reads the headers and the data up to the next
+    //frame data in the file
+    GRPImage previewImage;
+    previewImage.LoadImageFrames(GRPIMAGEFILEPATH, std::vector<int>(1, 0));
+    const grpFrameLayout &previewLayout = previewImage.GetFrameLayout().at(0);
+    for(std::vector<grpFrameLayout>::const_iterator currentLayout = fullImage.GetFrameLayout().begin(); currentLayout != fullImage.GetFrameLayout().end(); currentLayout++)
+    {
+        if(currentLayout->frameNumber == 0)
+        {
+            BOOST_REQUIRE_EQUAL(previewLayout.dataEnd, currentLayout->dataEnd);
+        }
+    }
+    uint64_t previewDataBytes = previewLayout.dataEnd - previewLayout.dataOffset;
+    BOOST_REQUIRE_EQUAL(previewImage.GetStatistics().fileBytesRead, 6 + (8 * fullImage.getNumberOfFrames()) + previewDataBytes);
+    BOOST_REQUIRE_EQUAL(previewImage.MemoryUsage().fileBufferBytes, previewDataBytes);
+    BOOST_REQUIRE(previewImage.GetStatistics().fileBytesRead < imageData.size() / 4);
+    
+    frameNumbers.push_back(fullImage.getNumberOfFrames());
+    BOOST_REQUIRE_THROW(memorySubset.LoadImageFrames(&imageData, frameNumbers), GRPImageInvalidFrameNumber);
+    BOOST_REQUIRE_EQUAL(memorySubset.getNumberOfFrames(), 3);
+    
+    //A 2x1 frame whose only packet copies 63 pixels, the row runs past the
+    //frame and is more than two bytes per pixel long
+    std::vector<char> longRowData = {1, 0, 2, 0, 1, 0,
+                                     0, 0, 2, 1, 14, 0, 0, 0,
+                                     2, 0, 63};
+    longRowData.resize(longRowData.size() + 63, 7);
+    std::ofstream longRowFile("libgrpLongRowTest.grp", std::ios::binary);
+    longRowFile.write(&longRowData.front(), longRowData.size());
+    longRowFile.close();
+    GRPImage longRowImage("libgrpLongRowTest.grp");
+    fileSubset.LoadImageFrames("libgrpLongRowTest.grp", 0, 1);
+    BOOST_REQUIRE_EQUAL(fileSubset.GetFrame(0)->GetOpaquePixelCount(), longRowImage.GetFrame(0)->GetOpaquePixelCount());
+    BOOST_REQUIRE_EQUAL(fileSubset.GetFrame(0)->GetOpaquePixelCount(), 2);
+    std::remove("libgrpLongRowTest.grp");
+    
+    frameNumbers.assign(1, 0);
+    BOOST_REQUIRE_THROW(fileSubset.LoadImageFrames("libgrpMissingTest.grp", frameNumbers), std::ios_base::failure);
+}
+
+//Rows and rectangles decoded from the kept RLE data must match
+//the same pixels of the fully decoded frame
+BOOST_AUTO_TEST_CASE(DecodeFrameRectangle)
+{
+    GRPImage sampleImage(GRPIMAGEFILEPATH);
+    std::vector<UniquePixel> decodedPixels;
+    for(int currentFrame = 0; currentFrame < sampleImage.getNumberOfFrames(); currentFrame++)
+    {
+        GRPFrame *sampleFrame = sampleImage.GetFrame(currentFrame);
+        BOOST_REQUIRE(sampleFrame->HasCompressedData());
+        BOOST_REQUIRE_EQUAL(sampleFrame->GetRowOffsets().size(), sampleFrame->GetImageHeight());
+        
+        //A rectangle hanging over the bottom right of the frame
+        int rectangleX = sampleFrame->GetImageWidth() / 3;
+        int rectangleY = sampleFrame->GetImageHeight() / 2;
+        decodedPixels.clear();
+        sampleFrame->DecodeRectangle(rectangleX, rectangleY, sampleFrame->GetImageWidth(), sampleFrame->GetImageHeight(), &decodedPixels);
+        
+        std::vector<UniquePixel>::iterator currentDecodedPixel = decodedPixels.begin();
+        for(framePixelVector::iterator currentPixel = sampleFrame->frameData.begin(); currentPixel != sampleFrame->frameData.end(); currentPixel++)
+        {
+            if(currentPixel->xPosition < rectangleX || currentPixel->xPosition >= sampleFrame->GetImageWidth() || currentPixel->yPosition < rectangleY)
+            {
+                continue;
+            }
+            BOOST_REQUIRE(currentDecodedPixel != decodedPixels.end());
+            BOOST_REQUIRE_EQUAL(currentDecodedPixel->xPosition, currentPixel->xPosition);
+            BOOST_REQUIRE_EQUAL(currentDecodedPixel->yPosition, currentPixel->yPosition);
+            BOOST_REQUIRE_EQUAL(currentDecodedPixel->colorPaletteReference, currentPixel->colorPaletteReference);
+            currentDecodedPixel++;
+        }
+        BOOST_REQUIRE(currentDecodedPixel == decodedPixels.end());
+    }
+    
+    //A single row follows a color table applied to the frame
+    GRPFrame *sampleFrame = sampleImage.GetFrame(0);
+    uint8_t invertTable[256];
+    for(int currentColor = 0; currentColor < 256; currentColor++)
+    {
+        invertTable[currentColor] = 255 - currentColor;
+    }
+    sampleFrame->ApplyColorTable(invertTable);
+    int middleRow = sampleFrame->GetImageHeight() / 2;
+    decodedPixels.clear();
+    sampleFrame->DecodeRow(middleRow, &decodedPixels);
+    std::vector<UniquePixel>::iterator currentDecodedPixel = decodedPixels.begin();
+    for(framePixelVector::iterator currentPixel = sampleFrame->frameData.begin(); currentPixel != sampleFrame->frameData.end(); currentPixel++)
+    {
+        if(currentPixel->yPosition == middleRow && currentPixel->xPosition < sampleFrame->GetImageWidth())
+        {
+            BOOST_REQUIRE(currentDecodedPixel != decodedPixels.end());
+            BOOST_REQUIRE_EQUAL(currentDecodedPixel->colorPaletteReference, currentPixel->colorPaletteReference);
+            currentDecodedPixel++;
+        }
+    }
+    BOOST_REQUIRE(currentDecodedPixel == decodedPixels.end());
+    BOOST_REQUIRE_THROW(sampleFrame->DecodeRow(sampleFrame->GetImageHeight(), &decodedPixels), GRPFrameInvalidRowNumber);
+    
+    GRPFrame emptyFrame;
+    emptyFrame.SetImageSize(4, 4);
+    BOOST_REQUIRE_THROW(emptyFrame.DecodeRow(0, &decodedPixels), GRPFrameNoCompressedData);
+}
+
+//Compressed frames keep no pixels but convert to the same RGBA output
+BOOST_AUTO_TEST_CASE(CompressedFrameStorage)
+{
+    ColorPalette samplePalette;
+    samplePalette.LoadPalette(PALETTEFILEPATH);
+    GRPImage expandedImage(GRPIMAGEFILEPATH);
+    GRPImage compressedImage;
+    compressedImage.SetFrameStorage(COMPRESSEDFRAMES);
+    compressedImage.LoadImage(GRPIMAGEFILEPATH);
+    expandedImage.SetColorPalette(&samplePalette);
+    compressedImage.SetColorPalette(&samplePalette);
+    
+    BOOST_REQUIRE_EQUAL(compressedImage.getNumberOfFrames(), expandedImage.getNumberOfFrames());
+    BOOST_REQUIRE_EQUAL(compressedImage.MemoryUsage().pixelBytes, 0);
+    BOOST_REQUIRE(compressedImage.MemoryUsage().compressedBytes < expandedImage.MemoryUsage().pixelBytes);
+    
+    size_t bufferSize = expandedImage.getMaxImageWidth() * expandedImage.getMaxImageHeight();
+    std::vector<uint32_t> expandedBuffer(bufferSize);
+    std::vector<uint32_t> compressedBuffer(bufferSize);
+    for(int currentFrame = 0; currentFrame < expandedImage.getNumberOfFrames(); currentFrame++)
+    {
+        BOOST_REQUIRE(compressedImage.GetFrame(currentFrame)->frameData.empty());
+        std::fill(expandedBuffer.begin(), expandedBuffer.end(), 0);
+        std::fill(compressedBuffer.begin(), compressedBuffer.end(), 0);
+        expandedImage.ConvertFrameToRGBA(currentFrame, &expandedBuffer.front(), expandedImage.getMaxImageWidth());
+        compressedImage.ConvertFrameToRGBA(currentFrame, &compressedBuffer.front(), compressedImage.getMaxImageWidth());
+        BOOST_REQUIRE(expandedBuffer == compressedBuffer);
+    }
+}
+
+//Drawing from the span programs must match drawing the decoded pixels,
+//also after the frames are remapped
+BOOST_AUTO_TEST_CASE(FrameSpanPrograms)
+{
+    ColorPalette samplePalette;
+    samplePalette.LoadPalette(PALETTEFILEPATH);
+    GRPImage pixelImage(GRPIMAGEFILEPATH);
+    GRPImage spanImage;
+    spanImage.SetBuildSpanPrograms(true);
+    spanImage.SetFrameStorage(COMPRESSEDFRAMES);
+    spanImage.LoadImage(GRPIMAGEFILEPATH);
+    pixelImage.SetColorPalette(&samplePalette);
+    spanImage.SetColorPalette(&samplePalette);
+    BOOST_REQUIRE(spanImage.MemoryUsage().spanBytes > 0);
+    BOOST_REQUIRE_EQUAL(pixelImage.MemoryUsage().spanBytes, 0);
+    
+    std::vector<uint8_t> remapTable(256);
+    for(int currentColor = 0; currentColor < 256; currentColor++)
+    {
+        remapTable[currentColor] = (currentColor * 7) % 256;
+    }
+    
+    size_t bufferSize = pixelImage.getMaxImageWidth() * pixelImage.getMaxImageHeight();
+    std::vector<uint32_t> pixelBuffer(bufferSize);
+    std::vector<uint32_t> spanBuffer(bufferSize);
+    for(int currentPass = 0; currentPass < 2; currentPass++)
+    {
+        for(int currentFrame = 0; currentFrame < pixelImage.getNumberOfFrames(); currentFrame++)
+        {
+            GRPFrame *spanFrame = spanImage.GetFrame(currentFrame);
+            BOOST_REQUIRE(spanFrame->HasSpanProgram());
+            BOOST_REQUIRE_EQUAL(spanFrame->GetSpanRows().size(), spanFrame->GetImageHeight() + 1);
+            BOOST_REQUIRE_EQUAL(spanFrame->GetFillSpans().size(), spanFrame->GetSpanRows().back().firstFillSpan);
+            
+            std::fill(pixelBuffer.begin(), pixelBuffer.end(), 0);
+            std::fill(spanBuffer.begin(), spanBuffer.end(), 0);
+            pixelImage.ConvertFrameToRGBA(currentFrame, &pixelBuffer.front(), pixelImage.getMaxImageWidth());
+            spanImage.ConvertFrameToRGBA(currentFrame, &spanBuffer.front(), spanImage.getMaxImageWidth());
+            BOOST_REQUIRE(pixelBuffer == spanBuffer);
+        }
+        pixelImage.RemapColors(remapTable);
+        spanImage.RemapColors(remapTable);
+    }
+    
+    //A 4x1 frame of two fills, remapped to one color a rebuilt span
+    //program has one span
+    std::vector<char> fillRowData = {1, 0, 4, 0, 1, 0,
+                                     0, 0, 4, 1, 14, 0, 0, 0,
+                                     2, 0, 0x42, 5, 0x42, 6};
+    GRPImage fillRowImage;
+    fillRowImage.SetBuildSpanPrograms(true);
+    fillRowImage.LoadImage(&fillRowData, false);
+    BOOST_REQUIRE_EQUAL(fillRowImage.GetFrame(0)->GetFillSpans().size(), 2);
+    for(int currentColor = 0; currentColor < 256; currentColor++)
+    {
+        remapTable[currentColor] = currentColor;
+    }
+    remapTable[6] = 5;
+    fillRowImage.RemapColors(remapTable);
+    GRPFrame *fillRowFrame = fillRowImage.GetFrame(0);
+    fillRowFrame->BuildSpanProgram();
+    BOOST_REQUIRE_EQUAL(fillRowFrame->GetSpanRows().back().firstFillSpan, 1);
+    BOOST_REQUIRE_EQUAL(fillRowFrame->GetFillSpans().size(), 1);
+    BOOST_REQUIRE_EQUAL(fillRowFrame->GetFillSpans().at(0).spanLength, 4);
+}
+
+//The opaque statistics gathered by the decoder must match a scan of the
+//decoded pixels, also for compressed frames
+BOOST_AUTO_TEST_CASE(FrameOpaqueStatistics)
+{
+    GRPImage expandedImage(GRPIMAGEFILEPATH);
+    GRPImage compressedImage;
+    compressedImage.SetFrameStorage(COMPRESSEDFRAMES);
+    compressedImage.LoadImage(GRPIMAGEFILEPATH);
+    
+    int imageLeft = expandedImage.getMaxImageWidth();
+    int imageTop = expandedImage.getMaxImageHeight();
+    int imageRight = 0;
+    int imageBottom = 0;
+    uint64_t imagePixels = 0;
+    for(int currentFrame = 0; currentFrame < expandedImage.getNumberOfFrames(); currentFrame++)
+    {
+        GRPFrame *expandedFrame = expandedImage.GetFrame(currentFrame);
+        int frameLeft = expandedFrame->GetImageWidth();
+        int frameTop = expandedFrame->GetImageHeight();
+        int frameRight = 0;
+        int frameBottom = 0;
+        for(framePixelVector::iterator currentPixel = expandedFrame->frameData.begin(); currentPixel != expandedFrame->frameData.end(); currentPixel++)
+        {
+            frameLeft = std::min(frameLeft, currentPixel->xPosition);
+            frameTop = std::min(frameTop, currentPixel->yPosition);
+            frameRight = std::max(frameRight, currentPixel->xPosition + 1);
+            frameBottom = std::max(frameBottom, currentPixel->yPosition + 1);
+        }
+        
+        grpOpaqueBounds frameBounds = expandedFrame->GetOpaqueBounds();
+        BOOST_REQUIRE_EQUAL(expandedFrame->GetOpaquePixelCount(), expandedFrame->frameData.size());
+        BOOST_REQUIRE_EQUAL(compressedImage.GetFrame(currentFrame)->GetOpaquePixelCount(), expandedFrame->frameData.size());
+        if(expandedFrame->frameData.empty())
+        {
+            BOOST_REQUIRE_EQUAL(frameBounds.width, 0);
+            BOOST_REQUIRE_EQUAL(frameBounds.height, 0);
+            continue;
+        }
+        BOOST_REQUIRE_EQUAL(frameBounds.xPosition, frameLeft);
+        BOOST_REQUIRE_EQUAL(frameBounds.yPosition, frameTop);
+        BOOST_REQUIRE_EQUAL(frameBounds.width, frameRight - frameLeft);
+        BOOST_REQUIRE_EQUAL(frameBounds.height, frameBottom - frameTop);
+        BOOST_REQUIRE_EQUAL(compressedImage.GetFrame(currentFrame)->GetOpaqueBounds().width, frameBounds.width);
+        BOOST_REQUIRE_EQUAL(compressedImage.GetFrame(currentFrame)->GetOpaqueBounds().yPosition, frameBounds.yPosition);
+        
+        imageLeft = std::min(imageLeft, frameLeft + expandedFrame->GetXOffset());
+        imageTop = std::min(imageTop, frameTop + expandedFrame->GetYOffset());
+        imageRight = std::max(imageRight, frameRight + expandedFrame->GetXOffset());
+        imageBottom = std::max(imageBottom, frameBottom + expandedFrame->GetYOffset());
+        imagePixels += expandedFrame->frameData.size();
+    }
+    
+    grpOpaqueBounds imageBounds = expandedImage.GetOpaqueBounds();
+    BOOST_REQUIRE_EQUAL(expandedImage.GetOpaquePixelCount(), imagePixels);
+    BOOST_REQUIRE_EQUAL(imageBounds.xPosition, imageLeft);
+    BOOST_REQUIRE_EQUAL(imageBounds.yPosition, imageTop);
+    BOOST_REQUIRE_EQUAL(imageBounds.width, imageRight - imageLeft);
+    BOOST_REQUIRE_EQUAL(imageBounds.height, imageBottom - imageTop);
+    
+    //A clone keeps the statistics of its frames
+    GRPImage clonedImage = expandedImage.Clone();
+    BOOST_REQUIRE_EQUAL(clonedImage.GetOpaquePixelCount(), imagePixels);
+}
+
+//The collision masks must hold the decoded pixels and the overlap test
+//must agree with checking every pixel pair
+BOOST_AUTO_TEST_CASE(FrameCollisionMasks)
+{
+    GRPImage maskImage;
+    maskImage.SetBuildCollisionMasks(true);
+    maskImage.LoadImage(GRPIMAGEFILEPATH);
+    BOOST_REQUIRE(maskImage.MemoryUsage().collisionMaskBytes > 0);
+    
+    //The opaque pixels of every frame as a width * height grid
+    std::vector<std::vector<bool> > opaqueGrids(maskImage.getNumberOfFrames());
+    for(int currentFrame = 0; currentFrame < maskImage.getNumberOfFrames(); currentFrame++)
+    {
+        GRPFrame *maskFrame = maskImage.GetFrame(currentFrame);
+        BOOST_REQUIRE(maskFrame->HasCollisionMask());
+        std::vector<bool> &opaqueGrid = opaqueGrids.at(currentFrame);
+        opaqueGrid.assign(maskFrame->GetImageWidth() * maskFrame->GetImageHeight(), false);
+        for(framePixelVector::iterator currentPixel = maskFrame->frameData.begin(); currentPixel != maskFrame->frameData.end(); currentPixel++)
+        {
+            if(currentPixel->xPosition < maskFrame->GetImageWidth())
+            {
+                opaqueGrid[(currentPixel->yPosition * maskFrame->GetImageWidth()) + currentPixel->xPosition] = true;
+            }
+        }
+        for(int currentRow = 0; currentRow < maskFrame->GetImageHeight(); currentRow++)
+        {
+            const uint64_t *maskRow = maskFrame->GetCollisionMaskRow(currentRow);
+            BOOST_REQUIRE_EQUAL(maskRow[-1], 0);
+            BOOST_REQUIRE_EQUAL(maskRow[maskFrame->GetCollisionMaskWords()], 0);
+            for(int currentColumn = 0; currentColumn < maskFrame->GetCollisionMaskWords() * 64; currentColumn++)
+            {
+                bool maskBit = (maskRow[currentColumn / 64] >> (currentColumn % 64)) & 1;
+                bool gridPixel = (currentColumn < maskFrame->GetImageWidth()) && opaqueGrid[(currentRow * maskFrame->GetImageWidth()) + currentColumn];
+                BOOST_REQUIRE_EQUAL(maskBit, gridPixel);
+            }
+        }
+    }
+    
+    int collisionsFound = 0;
+    for(int firstFrame = 0; firstFrame < maskImage.getNumberOfFrames(); firstFrame += 3)
+    {
+        for(int secondFrame = 1; secondFrame < maskImage.getNumberOfFrames(); secondFrame += 7)
+        {
+            GRPFrame *thisFrame = maskImage.GetFrame(firstFrame);
+            GRPFrame *otherFrame = maskImage.GetFrame(secondFrame);
+            for(int yDistance = -otherFrame->GetImageHeight(); yDistance <= thisFrame->GetImageHeight(); yDistance += 5)
+            {
+                for(int xDistance = -otherFrame->GetImageWidth(); xDistance <= thisFrame->GetImageWidth(); xDistance += 3)
+                {
+                    bool pixelsOverlap = false;
+                    for(int currentRow = 0; currentRow < otherFrame->GetImageHeight() && !pixelsOverlap; currentRow++)
+                    {
+                        for(int currentColumn = 0; currentColumn < otherFrame->GetImageWidth() && !pixelsOverlap; currentColumn++)
+                        {
+                            int thisColumn = currentColumn + xDistance;
+                            int thisRow = currentRow + yDistance;
+                            pixelsOverlap = opaqueGrids.at(secondFrame)[(currentRow * otherFrame->GetImageWidth()) + currentColumn] &&
+                                            thisColumn >= 0 && thisColumn < thisFrame->GetImageWidth() && thisRow >= 0 && thisRow < thisFrame->GetImageHeight() &&
+                                            opaqueGrids.at(firstFrame)[(thisRow * thisFrame->GetImageWidth()) + thisColumn];
+                        }
+                    }
+                    BOOST_REQUIRE_EQUAL(thisFrame->CollidesWith(*otherFrame, xDistance, yDistance), pixelsOverlap);
+                    collisionsFound += pixelsOverlap;
+                }
+            }
+        }
+    }
+    BOOST_REQUIRE(collisionsFound > 0);
+    
+    GRPImage plainImage(GRPIMAGEFILEPATH);
+    BOOST_REQUIRE(!plainImage.GetFrame(0)->HasCollisionMask());
+    BOOST_REQUIRE_THROW(plainImage.GetFrame(0)->CollidesWith(*maskImage.GetFrame(0), 0, 0), GRPFrameNoCollisionMask);
+}
+
+BOOST_AUTO_TEST_CASE(GetInvalidFrame)
+{
+    GRPImage sampleImage(GRPIMAGEFILEPATH);
+    BOOST_REQUIRE_THROW(sampleImage.GetFrame(sampleImage.getNumberOfFrames()), GRPImageInvalidFrameNumber);
+    BOOST_REQUIRE_THROW(sampleImage.GetFrame(-1), GRPImageInvalidFrameNumber);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 void LoadFileToVectorImageGRP(std::string filePath, std::vector<char> *destinationVector)
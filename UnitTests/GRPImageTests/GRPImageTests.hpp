@@ -4,6 +4,9 @@
 //Main boost include
 #include <boost/test/unit_test.hpp>
 #include "../../Source/GRPImage/GRPImage.hpp"
+#include <sstream>
+#include <fstream>
+#include <cstdio>
 
 #ifdef __APPLE__
 #define PALETTEFILEPATH "../../Documentation/SampleContent/SamplePalette.pal"
@@ -12,7 +15,7 @@
 #else
 
 #define PALETTEFILEPATH "../Documentation/SampleContent/SamplePalette.pal"
-#define GRPIMAGEFILEPATH "../../Documentation/SampleContent/SampleImage.grp"
+#define GRPIMAGEFILEPATH "../Documentation/SampleContent/SampleImage.grp"
 #endif
 
 void LoadFileToVectorImageGRP(std::string filePath, std::vector<char> *destinationVector);
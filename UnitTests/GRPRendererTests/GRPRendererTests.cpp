@@ -0,0 +1,186 @@
+#include "GRPRendererTests.hpp"
+
+BOOST_AUTO_TEST_SUITE(GRPRendererTests)
+
+//Overlapping, flipped, remapped, blended and partly off screen frames
+//drawn by several threads into small tiles must match drawing the
+//commands one after the other
+BOOST_AUTO_TEST_CASE(RenderMatchesReference)
+{
+    ColorPalette samplePalette;
+    samplePalette.LoadPalette(RENDERERPALETTEFILEPATH);
+    GRPImage sampleImage(RENDERERGRPIMAGEFILEPATH);
+    
+    std::vector<uint8_t> remapTable(256);
+    std::vector<uint8_t> blendTable(256 * 256);
+    for(int currentColor = 0; currentColor < 256; currentColor++)
+    {
+        remapTable[currentColor] = 255 - currentColor;
+    }
+    for(size_t currentEntry = 0; currentEntry < blendTable.size(); currentEntry++)
+    {
+        blendTable[currentEntry] = ((currentEntry >> 8) + (currentEntry & 0xff)) / 2;
+    }
+    
+    GRPRenderer tileRenderer(4);
+    tileRenderer.SetTileSize(16, 24);
+    BOOST_REQUIRE_EQUAL(tileRenderer.GetNumberOfThreads(), 4);
+    
+    const int targetWidth = 200;
+    const int targetHeight = 150;
+    std::vector<uint8_t> renderedSurface(targetWidth * targetHeight);
+    std::vector<uint8_t> referenceSurface(targetWidth * targetHeight);
+    for(size_t currentPixel = 0; currentPixel < renderedSurface.size(); currentPixel++)
+    {
+        renderedSurface[currentPixel] = referenceSurface[currentPixel] = currentPixel % 251;
+    }
+    
+    for(int currentCommand = 0; currentCommand < 120; currentCommand++)
+    {
+        grpDrawCommand drawCommand;
+        drawCommand.sourceImage = &sampleImage;
+        drawCommand.frameNumber = (currentCommand * 7) % sampleImage.getNumberOfFrames();
+        drawCommand.xPosition = ((currentCommand * 37) % (targetWidth + 80)) - 60;
+        drawCommand.yPosition = ((currentCommand * 53) % (targetHeight + 80)) - 60;
+        drawCommand.flipHorizontal = (currentCommand % 2) == 1;
+        drawCommand.remapTable = (currentCommand % 3) == 0 ? &remapTable.front() : NULL;
+        drawCommand.blendTable = (currentCommand % 5) == 0 ? &blendTable.front() : NULL;
+        tileRenderer.AddDrawCommand(drawCommand);
+        DrawCommandReference(drawCommand, &referenceSurface.front(), targetWidth, targetHeight);
+    }
+    BOOST_REQUIRE_EQUAL(tileRenderer.GetNumberOfDrawCommands(), 120);
+    
+    tileRenderer.Render(&renderedSurface.front(), targetWidth, targetHeight, targetWidth);
+    BOOST_REQUIRE(renderedSurface == referenceSurface);
+    BOOST_REQUIRE_EQUAL(tileRenderer.GetStatistics().framesRendered, 1);
+    BOOST_REQUIRE(tileRenderer.GetStatistics().tilesDrawn > 0);
+    
+    //Nothing queued leaves the surface alone
+    tileRenderer.ClearDrawCommands();
+    tileRenderer.Render(&renderedSurface.front(), targetWidth, targetHeight, targetWidth);
+    BOOST_REQUIRE(renderedSurface == referenceSurface);
+}
+
+//Redrawing only the changed tiles must give the same surface as drawing
+//everything over the background again
+BOOST_AUTO_TEST_CASE(RenderChangedTiles)
+{
+    GRPImage sampleImage(RENDERERGRPIMAGEFILEPATH);
+    const int targetWidth = 320;
+    const int targetHeight = 256;
+    std::vector<uint8_t> backgroundSurface(targetWidth * targetHeight);
+    for(size_t currentPixel = 0; currentPixel < backgroundSurface.size(); currentPixel++)
+    {
+        backgroundSurface[currentPixel] = (currentPixel / 3) % 253;
+    }
+    std::vector<uint8_t> renderedSurface(targetWidth * targetHeight);
+    GRPRenderer tileRenderer(3);
+    tileRenderer.SetTileSize(32, 32);
+    
+    std::vector<grpDrawCommand> drawCommands;
+    for(int currentCommand = 0; currentCommand < 12; currentCommand++)
+    {
+        grpDrawCommand drawCommand = {&sampleImage, currentCommand, (currentCommand % 4) * 70, (currentCommand / 4) * 70, false, NULL, NULL};
+        drawCommands.push_back(drawCommand);
+    }
+    
+    for(int currentTick = 0; currentTick < 4; currentTick++)
+    {
+        //One sprite walks, one animates and the last one disappears
+        if(currentTick > 0)
+        {
+            drawCommands.at(2).xPosition += 5;
+            drawCommands.at(5).frameNumber++;
+        }
+        if(currentTick == 3)
+        {
+            drawCommands.pop_back();
+        }
+        tileRenderer.ClearDrawCommands();
+        std::vector<uint8_t> referenceSurface(backgroundSurface);
+        for(std::vector<grpDrawCommand>::iterator currentCommand = drawCommands.begin(); currentCommand != drawCommands.end(); currentCommand++)
+        {
+            tileRenderer.AddDrawCommand(*currentCommand);
+            DrawCommandReference(*currentCommand, &referenceSurface.front(), targetWidth, targetHeight);
+        }
+        
+        grpRendererStatistics statisticsBefore = tileRenderer.GetStatistics();
+        tileRenderer.RenderChanges(&renderedSurface.front(), targetWidth, targetHeight, targetWidth, &backgroundSurface.front(), targetWidth);
+        BOOST_REQUIRE(renderedSurface == referenceSurface);
+        
+        size_t tilesDrawn = tileRenderer.GetStatistics().tilesDrawn - statisticsBefore.tilesDrawn;
+        if(currentTick == 0)
+        {
+            BOOST_REQUIRE_EQUAL(tilesDrawn, 10 * 8);
+        }
+        else
+        {
+            BOOST_REQUIRE(tilesDrawn > 0);
+            BOOST_REQUIRE(tilesDrawn < 10 * 8);
+        }
+        
+        //Every redrawn tile is covered by exactly one dirty rectangle
+        size_t dirtyArea = 0;
+        for(std::vector<grpDirtyRectangle>::const_iterator currentRectangle = tileRenderer.GetDirtyRectangles().begin(); currentRectangle != tileRenderer.GetDirtyRectangles().end(); currentRectangle++)
+        {
+            dirtyArea += currentRectangle->width * currentRectangle->height;
+        }
+        BOOST_REQUIRE_EQUAL(dirtyArea, tilesDrawn * 32 * 32);
+    }
+    
+    //Nothing changed, nothing drawn
+    grpRendererStatistics statisticsBefore = tileRenderer.GetStatistics();
+    tileRenderer.RenderChanges(&renderedSurface.front(), targetWidth, targetHeight, targetWidth, &backgroundSurface.front(), targetWidth);
+    BOOST_REQUIRE_EQUAL(tileRenderer.GetStatistics().tilesDrawn, statisticsBefore.tilesDrawn);
+    BOOST_REQUIRE(tileRenderer.GetDirtyRectangles().empty());
+    
+    tileRenderer.InvalidateAll();
+    tileRenderer.RenderChanges(&renderedSurface.front(), targetWidth, targetHeight, targetWidth, &backgroundSurface.front(), targetWidth);
+    BOOST_REQUIRE_EQUAL(tileRenderer.GetStatistics().tilesDrawn, statisticsBefore.tilesDrawn + (10 * 8));
+}
+
+BOOST_AUTO_TEST_CASE(RenderInvalidInput)
+{
+    GRPRenderer tileRenderer(1);
+    std::vector<uint8_t> targetSurface(64 * 64);
+    grpDrawCommand drawCommand = {};
+    BOOST_REQUIRE_THROW(tileRenderer.AddDrawCommand(drawCommand), GRPRendererInvalidDrawCommand);
+    BOOST_REQUIRE_THROW(tileRenderer.SetTileSize(0, 16), GRPRendererInvalidTileSize);
+    BOOST_REQUIRE_THROW(tileRenderer.Render(&targetSurface.front(), 64, 64, 32), GRPRendererInvalidTarget);
+    BOOST_REQUIRE_THROW(tileRenderer.Render(NULL, 64, 64, 64), GRPRendererInvalidTarget);
+    
+    GRPImage sampleImage(RENDERERGRPIMAGEFILEPATH);
+    drawCommand.sourceImage = &sampleImage;
+    drawCommand.frameNumber = sampleImage.getNumberOfFrames();
+    BOOST_REQUIRE_THROW(tileRenderer.AddDrawCommand(drawCommand), GRPImageInvalidFrameNumber);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+void DrawCommandReference(const grpDrawCommand &drawCommand, uint8_t *targetSurface, int targetWidth, int targetHeight)
+{
+    GRPFrame *drawFrame = drawCommand.sourceImage->GetFrame(drawCommand.frameNumber);
+    std::vector<UniquePixel> framePixels;
+    drawFrame->DecodeRectangle(0, 0, drawFrame->GetImageWidth(), drawFrame->GetImageHeight(), &framePixels);
+    
+    for(std::vector<UniquePixel>::iterator currentPixel = framePixels.begin(); currentPixel != framePixels.end(); currentPixel++)
+    {
+        int targetColumn = drawCommand.xPosition + drawFrame->GetXOffset() + currentPixel->xPosition;
+        if(drawCommand.flipHorizontal)
+        {
+            targetColumn = drawCommand.xPosition + drawCommand.sourceImage->getMaxImageWidth() - 1 - drawFrame->GetXOffset() - currentPixel->xPosition;
+        }
+        int targetRow = drawCommand.yPosition + drawFrame->GetYOffset() + currentPixel->yPosition;
+        if(targetColumn < 0 || targetColumn >= targetWidth || targetRow < 0 || targetRow >= targetHeight)
+        {
+            continue;
+        }
+        uint8_t frameColor = currentPixel->colorPaletteReference;
+        if(drawCommand.remapTable != NULL)
+        {
+            frameColor = drawCommand.remapTable[frameColor];
+        }
+        uint8_t &targetPixel = targetSurface[(targetRow * targetWidth) + targetColumn];
+        targetPixel = (drawCommand.blendTable != NULL) ? drawCommand.blendTable[(targetPixel * 256) + frameColor] : frameColor;
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef GRPRendererUnitTest_H
+#define GRPRendererUnitTest_H
+
+//Main boost include
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include "../../Source/GRPRenderer/GRPRenderer.hpp"
+
+#ifdef __APPLE__
+#define RENDERERPALETTEFILEPATH "../../Documentation/SampleContent/SamplePalette.pal"
+#define RENDERERGRPIMAGEFILEPATH "../../Documentation/SampleContent/SampleImage.grp"
+#else
+#define RENDERERPALETTEFILEPATH "../Documentation/SampleContent/SamplePalette.pal"
+#define RENDERERGRPIMAGEFILEPATH "../Documentation/SampleContent/SampleImage.grp"
+#endif
+
+//Draw a command one pixel at a time from the decoded frame, the result
+//the tiled renderer has to match
+void DrawCommandReference(const grpDrawCommand &drawCommand, uint8_t *targetSurface, int targetWidth, int targetHeight);
+
+#endif
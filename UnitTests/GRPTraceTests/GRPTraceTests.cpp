@@ -0,0 +1,46 @@
+#include "GRPTraceTests.hpp"
+
+BOOST_AUTO_TEST_SUITE(GRPTraceTests)
+
+//Spans from different threads end up on their own timeline rows
+BOOST_AUTO_TEST_CASE(WriteChromeTrace)
+{
+    GRPTrace::ClearTrace();
+    {
+        GRPTraceSpan mainThreadSpan("MainThreadSpan");
+    }
+    std::thread workerThread([](){ GRPTraceSpan workerSpan("WorkerThreadSpan"); });
+    workerThread.join();
+    
+    std::stringstream traceOutput;
+    GRPTrace::WriteChromeTrace(traceOutput);
+    std::string traceJSON = traceOutput.str();
+    BOOST_REQUIRE_EQUAL(traceJSON.find("{\"traceEvents\":["), 0);
+    BOOST_REQUIRE(traceJSON.find("\"name\":\"MainThreadSpan\"") != std::string::npos);
+    BOOST_REQUIRE(traceJSON.find("\"name\":\"WorkerThreadSpan\"") != std::string::npos);
+    BOOST_REQUIRE(traceJSON.find("\"ph\":\"X\"") != std::string::npos);
+    
+    GRPTrace::ClearTrace();
+    traceOutput.str(std::string());
+    GRPTrace::WriteChromeTrace(traceOutput);
+    BOOST_REQUIRE(traceOutput.str().find("MainThreadSpan") == std::string::npos);
+}
+
+//Only the newest spans are kept once a thread's ring buffer is full
+BOOST_AUTO_TEST_CASE(TraceRingBufferWraps)
+{
+    GRPTrace::ClearTrace();
+    std::chrono::steady_clock::time_point spanTime = std::chrono::steady_clock::now();
+    GRPTrace::RecordSpan("OldestSpan", spanTime, spanTime);
+    for(int currentSpan = 0; currentSpan < TRACEEVENTSPERTHREAD; currentSpan++)
+    {
+        GRPTrace::RecordSpan("NewerSpan", spanTime, spanTime);
+    }
+    
+    std::stringstream traceOutput;
+    GRPTrace::WriteChromeTrace(traceOutput);
+    BOOST_REQUIRE(traceOutput.str().find("OldestSpan") == std::string::npos);
+    GRPTrace::ClearTrace();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
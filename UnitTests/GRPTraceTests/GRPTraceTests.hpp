@@ -0,0 +1,10 @@
+#ifndef GRPTraceUnitTest_H
+#define GRPTraceUnitTest_H
+
+//Main boost include
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <thread>
+#include "../../Source/GRPTrace/GRPTrace.hpp"
+#endif
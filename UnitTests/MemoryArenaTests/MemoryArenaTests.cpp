@@ -0,0 +1,89 @@
+#include "MemoryArenaTests.hpp"
+
+BOOST_AUTO_TEST_SUITE(MemoryArenaTests)
+
+BOOST_AUTO_TEST_CASE(AlignedAllocations)
+{
+    MemoryArena testArena(256);
+    for(int currentAllocation = 0; currentAllocation < 100; currentAllocation++)
+    {
+        char *smallAllocation = static_cast<char *>(testArena.Allocate(3, 1));
+        BOOST_REQUIRE(smallAllocation != NULL);
+        uint64_t *alignedAllocation = static_cast<uint64_t *>(testArena.Allocate(sizeof(uint64_t), alignof(uint64_t)));
+        BOOST_REQUIRE_EQUAL(reinterpret_cast<uintptr_t>(alignedAllocation) % alignof(uint64_t), 0);
+        *alignedAllocation = currentAllocation;
+    }
+    BOOST_REQUIRE_EQUAL(testArena.GetBytesAllocated(), 100 * (3 + sizeof(uint64_t)));
+    
+    //Larger then a block gets a block of its own
+    testArena.Allocate(4096);
+    BOOST_REQUIRE(testArena.GetBytesReserved() >= testArena.GetBytesAllocated());
+    
+    //Alignments above std::max_align_t, in the current block and in new ones
+    for(int currentAllocation = 0; currentAllocation < 8; currentAllocation++)
+    {
+        void *pageAllocation = testArena.Allocate(100 + (currentAllocation * 1000), 4096);
+        BOOST_REQUIRE_EQUAL(reinterpret_cast<uintptr_t>(pageAllocation) % 4096, 0);
+        void *lineAllocation = testArena.Allocate(10, 64);
+        BOOST_REQUIRE_EQUAL(reinterpret_cast<uintptr_t>(lineAllocation) % 64, 0);
+    }
+    
+    testArena.Release();
+    BOOST_REQUIRE_EQUAL(testArena.GetBytesReserved(), 0);
+    BOOST_REQUIRE_EQUAL(testArena.GetBytesAllocated(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ResetKeepsLargestBlock)
+{
+    MemoryArena testArena(256);
+    testArena.Allocate(100);
+    testArena.Allocate(8192);
+    testArena.Reset();
+    BOOST_REQUIRE_EQUAL(testArena.GetBytesReserved(), 8192);
+    BOOST_REQUIRE_EQUAL(testArena.GetBytesAllocated(), 0);
+    
+    //Fits in the kept block
+    testArena.Allocate(4000);
+    BOOST_REQUIRE_EQUAL(testArena.GetBytesReserved(), 8192);
+}
+
+BOOST_AUTO_TEST_CASE(ReserveSingleBlock)
+{
+    MemoryArena testArena(256);
+    testArena.Allocate(200);
+    testArena.Allocate(200);
+    testArena.Allocate(200);
+    size_t usedBytes = testArena.GetBytesReserved();
+    testArena.Reset();
+    testArena.Reserve(usedBytes);
+    BOOST_REQUIRE_EQUAL(testArena.GetBytesReserved(), usedBytes);
+    
+    //The same allocations now fit in the one block
+    testArena.Allocate(200);
+    testArena.Allocate(200);
+    testArena.Allocate(200);
+    BOOST_REQUIRE_EQUAL(testArena.GetBytesReserved(), usedBytes);
+    
+    //Enough space is left, nothing changes
+    testArena.Reserve(16);
+    BOOST_REQUIRE_EQUAL(testArena.GetBytesReserved(), usedBytes);
+}
+
+BOOST_AUTO_TEST_CASE(ArenaAllocatorContainers)
+{
+    MemoryArena testArena;
+    std::vector<int, ArenaAllocator<int> > arenaVector((ArenaAllocator<int>(&testArena)));
+    for(int currentValue = 0; currentValue < 1000; currentValue++)
+    {
+        arenaVector.push_back(currentValue);
+    }
+    BOOST_REQUIRE_EQUAL(arenaVector.at(999), 999);
+    BOOST_REQUIRE(testArena.GetBytesAllocated() >= 1000 * sizeof(int));
+    
+    //Without an arena the heap is used
+    std::vector<int, ArenaAllocator<int> > heapVector(10, 5);
+    BOOST_REQUIRE(heapVector.get_allocator().GetArena() == NULL);
+    BOOST_REQUIRE_EQUAL(heapVector.at(9), 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
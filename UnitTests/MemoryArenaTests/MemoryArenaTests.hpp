@@ -0,0 +1,10 @@
+#ifndef MemoryArenaUnitTest_H
+#define MemoryArenaUnitTest_H
+
+//Main boost include
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <inttypes.h>
+#include "../../Source/MemoryArena/MemoryArena.hpp"
+#endif
@@ -19,5 +19,8 @@
 #include "ColorPaletteTests/ColorPaletteTests.hpp"
 #include "GRPFrameTests/GRPFrameTests.hpp"
 #include "GRPImageTests/GRPImageTests.hpp"
+#include "GRPRendererTests/GRPRendererTests.hpp"
+#include "GRPTraceTests/GRPTraceTests.hpp"
+#include "MemoryArenaTests/MemoryArenaTests.hpp"
 
 #endif
\ No newline at end of file